@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <switch.h>
+
+#include "capture.h"
+#include "helper.h"
+#include "tile_codec.h"
+
+// Writes reach the SD card or the network in large chunks
+#define STREAM_BUFFER_SIZE (256 * 1024)
+
+#define TCP_PREFIX "tcp://"
+
+static FILE* connect_tcp(char const* address, bool* uses_sockets)
+{
+    char host[64];
+    unsigned port;
+    if (2 != sscanf(address, "%63[^:]:%u", host, &port) || port > 0xffff)
+    {
+        printf("Expected tcp://<address>:<port>, got \"%s\"\n", address);
+        return NULL;
+    }
+
+    struct sockaddr_in socket_address = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+    };
+    if (1 != inet_pton(AF_INET, host, &socket_address.sin_addr))
+    {
+        printf("Invalid address \"%s\"\n", host);
+        return NULL;
+    }
+
+    Result const rc = socketInitializeDefault();
+    if (R_FAILED(rc))
+    {
+        printf("socketInitializeDefault: %08X\n", rc);
+        return NULL;
+    }
+    *uses_sockets = true;
+
+    int const fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return NULL;
+    if (connect(fd, (struct sockaddr const*)&socket_address,
+            sizeof(socket_address)) != 0)
+    {
+        printf("Failed to connect to %s\n", address);
+        close(fd);
+        return NULL;
+    }
+    FILE* const file = fdopen(fd, "wb");
+    if (!file)
+        close(fd);
+    return file;
+}
+
+bool capture_open(struct capture* capture, char const* path, uint64_t limit,
+    bool is_capturing_all)
+{
+    memset(capture, 0, sizeof(*capture));
+    capture->limit = limit;
+    capture->is_capturing_all = is_capturing_all;
+
+    if (0 == strncmp(path, TCP_PREFIX, strlen(TCP_PREFIX)))
+    {
+        capture->file =
+            connect_tcp(path + strlen(TCP_PREFIX), &capture->uses_sockets);
+    }
+    else
+        capture->file = fopen(path, "wb");
+    if (!capture->file)
+    {
+        capture_close(capture);
+        return false;
+    }
+    setvbuf(capture->file, NULL, _IOFBF, STREAM_BUFFER_SIZE);
+
+    struct capture_header const header = {
+        .magic = CAPTURE_MAGIC,
+        .version = CAPTURE_VERSION,
+    };
+    fwrite(&header, sizeof(header), 1, capture->file);
+    capture->written = sizeof(header);
+    return true;
+}
+
+void capture_close(struct capture* capture)
+{
+    if (capture->file)
+        fclose(capture->file);
+    if (capture->uses_sockets)
+        socketExit();
+    free(capture->payload);
+    memset(capture, 0, sizeof(*capture));
+}
+
+bool capture_wants(struct capture const* capture, bool passed)
+{
+    return capture && (!passed || capture->is_capturing_all);
+}
+
+bool capture_image(struct capture* capture, char const* name,
+    struct capture_record const* record, void const* data)
+{
+    size_t const num_tiles = tile_count(record->size);
+    size_t const capacity = num_tiles * TILE_CODEC_BOUND;
+    if (capacity > capture->payload_capacity)
+    {
+        free(capture->payload);
+        capture->payload = checked_malloc(capacity);
+        capture->payload_capacity = capacity;
+    }
+
+    uint8_t const* const bytes = data;
+    size_t payload_size = 0;
+    for (size_t offset = 0; offset < record->size; offset += TILE_BYTES)
+    {
+        size_t const size = record->size - offset < TILE_BYTES
+            ? record->size - offset : TILE_BYTES;
+        payload_size += tile_encode(
+            bytes + offset, size, capture->payload + payload_size);
+    }
+
+    struct capture_record header = *record;
+    header.name_size = strlen(name);
+    header.payload_size = payload_size;
+    uint64_t const total = sizeof(header) + header.name_size + payload_size;
+    if (capture->written + total > capture->limit)
+    {
+        ++capture->num_skipped;
+        return false;
+    }
+
+    fwrite(&header, sizeof(header), 1, capture->file);
+    fwrite(name, 1, header.name_size, capture->file);
+    fwrite(capture->payload, 1, payload_size, capture->file);
+    capture->written += total;
+    ++capture->num_captured;
+    return true;
+}
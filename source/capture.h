@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define CAPTURE_MAGIC 0x50434B44 // DKCP
+#define CAPTURE_VERSION 1
+
+#define CAPTURE_DEFAULT_LIMIT (64u << 20)
+
+// Render targets of graphics tests, as the GPU left them, for looking at on
+// a computer. A capture is a header followed by a record for each image:
+// the record, the test's name and the image's tiles, each compressed with
+// tile_encode. Records are written whole, so a capture cut short still reads
+// up to its last image.
+struct capture_header
+{
+    uint32_t magic;
+    uint32_t version;
+};
+
+#define CAPTURE_PASSED (1 << 0)
+
+struct capture_record
+{
+    uint32_t format; // DkImageFormat
+    uint32_t width;
+    uint32_t height;
+    uint32_t block_height; // in GOBs
+    uint32_t size; // of the image in its block linear layout
+    uint32_t flags;
+    uint32_t name_size;
+    uint32_t payload_size;
+    uint64_t hash;
+    uint64_t expected;
+};
+
+struct capture
+{
+    FILE* file;
+    bool uses_sockets;
+    // Passing tests are captured too, for a reference to compare with
+    bool is_capturing_all;
+    // Images that would take the capture past limit bytes are left out
+    uint64_t limit;
+    uint64_t written;
+    size_t num_captured;
+    size_t num_skipped;
+    uint8_t* payload;
+    size_t payload_capacity;
+};
+
+// path is a file, or tcp://<address>:<port> to stream to a computer, such
+// as one running `nc -l <port> > capture.dkcp`
+bool capture_open(struct capture* capture, char const* path, uint64_t limit,
+    bool is_capturing_all);
+void capture_close(struct capture* capture);
+
+bool capture_wants(struct capture const* capture, bool passed);
+
+// Compresses and writes an image, false when it is left out for the limit
+bool capture_image(struct capture* capture, char const* name,
+    struct capture_record const* record, void const* data);
@@ -0,0 +1,1220 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deko3d.h>
+
+#include "cmd_trace.h"
+#include "graphics_context.h"
+#include "hash.h"
+#include "helper.h"
+#include "test_filter.h"
+#include "test_log.h"
+#include "timing.h"
+
+#define TRACE_MAGIC 0x52544B44 // DKTR
+// Bump on any change to the records below, deko3d structs included, or to
+// hash_alloc
+#define TRACE_VERSION 1
+
+#define MAX_RENDER_TARGETS 9 // 8 color targets and depth
+#define MAX_VTX_BUFFERS 16
+
+// A trace is a file header followed by records, each a record header and its
+// payload. Payloads are a fixed part, some followed by an array or bytes.
+enum trace_op
+{
+    TRACE_OP_BEGIN_TEST,              // name
+    TRACE_OP_END_TEST,                // trace_end_test
+    TRACE_OP_MEMBLOCK,                // trace_memblock
+    TRACE_OP_CMDBUF,                  // nothing
+    TRACE_OP_IMAGE,                   // trace_image, its memory included
+    TRACE_OP_SHADER,                  // trace_shader, DKSH
+    TRACE_OP_TIC_POOL,                // trace_pool
+    TRACE_OP_TSC_POOL,                // trace_pool
+    TRACE_OP_FILL,                    // trace_fill
+    TRACE_OP_DATA,                    // trace_data, contents
+    TRACE_OP_TEXTURE,                 // trace_texture
+    TRACE_OP_BIND_RENDER_TARGETS,     // trace_render_targets, trace_view[]
+    TRACE_OP_SET_VIEWPORTS,           // trace_array, DkViewport[]
+    TRACE_OP_SET_SCISSORS,            // trace_array, DkScissor[]
+    TRACE_OP_CLEAR_COLOR,             // trace_clear_color
+    TRACE_OP_CLEAR_DEPTH_STENCIL,     // trace_clear_depth_stencil
+    TRACE_OP_BIND_SHADERS,            // trace_array, shader ids
+    TRACE_OP_BIND_DEPTH_STENCIL_STATE, // trace_depth_stencil_state
+    TRACE_OP_BIND_VTX_ATTRIB_STATE,   // trace_array, DkVtxAttribState[]
+    TRACE_OP_BIND_VTX_BUFFER_STATE,   // trace_array, DkVtxBufferState[]
+    TRACE_OP_BIND_VTX_BUFFERS,        // trace_array, trace_extent[]
+    TRACE_OP_DRAW,                    // trace_draw
+    TRACE_OP_SUBMIT,                  // trace_submit
+    NUM_TRACE_OPS,
+};
+
+// Sizes of the deko3d structs traced as they are, which differ between the
+// host mock's headers and the real ones
+struct trace_file_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t view_size;
+    uint32_t sampler_size;
+    uint32_t depth_stencil_size;
+};
+
+struct trace_record_header
+{
+    uint32_t op;
+    uint32_t size;
+};
+
+// A GPU address as an offset in one of the test's memory blocks
+struct trace_ref
+{
+    uint32_t block;
+    uint32_t offset;
+};
+
+// An image view, with pImage cleared
+struct trace_view
+{
+    uint32_t image;
+    uint32_t reserved;
+    DkImageView view;
+};
+
+struct trace_end_test
+{
+    uint64_t hash;
+    uint32_t result;
+    uint32_t reserved;
+};
+
+struct trace_memblock
+{
+    uint32_t size;
+    uint32_t type;
+};
+
+struct trace_image
+{
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t flags;
+};
+
+struct trace_shader
+{
+    char name[64];
+};
+
+struct trace_pool
+{
+    uint32_t cmdbuf;
+    uint32_t num;
+};
+
+struct trace_fill
+{
+    uint32_t block;
+    uint32_t value;
+};
+
+struct trace_data
+{
+    uint32_t block;
+};
+
+struct trace_texture
+{
+    uint32_t cmdbuf;
+    uint32_t stage;
+    uint32_t index;
+    uint32_t reserved;
+    struct trace_ref tic;
+    struct trace_ref tsc;
+    struct trace_view view;
+    DkSampler sampler;
+};
+
+struct trace_render_targets
+{
+    uint32_t cmdbuf;
+    uint32_t num_color_targets;
+    uint32_t has_depth_target;
+    uint32_t reserved;
+};
+
+// Commands taking an array, stage_mask for shaders and first id otherwise
+struct trace_array
+{
+    uint32_t cmdbuf;
+    uint32_t first;
+    uint32_t num;
+};
+
+struct trace_clear_color
+{
+    uint32_t cmdbuf;
+    uint32_t target;
+    uint32_t mask;
+    uint32_t data[4];
+};
+
+struct trace_clear_depth_stencil
+{
+    uint32_t cmdbuf;
+    uint32_t clear_depth;
+    float depth;
+    uint32_t stencil_mask;
+    uint32_t stencil_value;
+};
+
+struct trace_depth_stencil_state
+{
+    uint32_t cmdbuf;
+    DkDepthStencilState state;
+};
+
+struct trace_extent
+{
+    struct trace_ref addr;
+    uint32_t size;
+};
+
+struct trace_draw
+{
+    uint32_t cmdbuf;
+    uint32_t prim;
+    uint32_t vertex_count;
+    uint32_t instance_count;
+    uint32_t first_vertex;
+    uint32_t first_instance;
+};
+
+struct trace_submit
+{
+    uint32_t cmdbuf;
+};
+
+// Recording
+
+static void write_record(struct cmd_trace* trace, enum trace_op op,
+    void const* head, size_t head_size, void const* tail, size_t tail_size)
+{
+    struct trace_record_header const header = {
+        .op = op,
+        .size = head_size + tail_size,
+    };
+    fwrite(&header, sizeof(header), 1, trace->file);
+    if (head_size)
+        fwrite(head, head_size, 1, trace->file);
+    if (tail_size)
+        fwrite(tail, tail_size, 1, trace->file);
+}
+
+bool cmd_trace_open(struct cmd_trace* trace, char const* path)
+{
+    memset(trace, 0, sizeof(*trace));
+    trace->file = fopen(path, "wb");
+    if (!trace->file)
+        return false;
+
+    struct trace_file_header const header = {
+        .magic = TRACE_MAGIC,
+        .version = TRACE_VERSION,
+        .view_size = sizeof(DkImageView),
+        .sampler_size = sizeof(DkSampler),
+        .depth_stencil_size = sizeof(DkDepthStencilState),
+    };
+    fwrite(&header, sizeof(header), 1, trace->file);
+    return true;
+}
+
+void cmd_trace_close(struct cmd_trace* trace)
+{
+    if (ferror(trace->file))
+        printf("Failed to write the command trace\n");
+    fclose(trace->file);
+    trace->file = NULL;
+}
+
+static uint32_t cmdbuf_id(struct gfx_context const* ctx, DkCmdBuf cmdbuf)
+{
+    for (size_t i = 0; i < ctx->num_cmdbufs; ++i)
+    {
+        if (ctx->cmdbufs[i] == cmdbuf)
+            return i;
+    }
+    printf("Command buffer not made by the context! Aborting...\n");
+    exit(EXIT_FAILURE);
+}
+
+static uint32_t image_id(struct cmd_trace const* trace, DkImage const* image)
+{
+    for (size_t i = 0; i < trace->num_images; ++i)
+    {
+        if (trace->images[i] == image)
+            return i;
+    }
+    printf("Image not made by the context! Aborting...\n");
+    exit(EXIT_FAILURE);
+}
+
+// Shaders are referred to by the order the test made them in
+static uint32_t shader_id(struct gfx_context const* ctx, DkShader const* shader)
+{
+    for (size_t i = 0; i < ctx->num_shaders; ++i)
+    {
+        if (ctx->shaders[i] == shader)
+            return i;
+    }
+    printf("Shader not made by the context! Aborting...\n");
+    exit(EXIT_FAILURE);
+}
+
+static struct trace_ref make_ref(struct gfx_context const* ctx, DkGpuAddr addr)
+{
+    for (size_t i = 0; i < ctx->num_allocs; ++i)
+    {
+        DkGpuAddr const base = ctx->allocs[i].gpu_addr;
+        if (addr >= base && addr - base < ctx->allocs[i].size)
+            return (struct trace_ref){i, addr - base};
+    }
+    printf("Address 0x%" PRIx64 " outside of the context! Aborting...\n",
+        addr);
+    exit(EXIT_FAILURE);
+}
+
+static struct trace_view make_view(
+    struct cmd_trace const* trace, DkImageView const* view)
+{
+    struct trace_view traced;
+    memset(&traced, 0, sizeof(traced));
+    traced.image = image_id(trace, view->pImage);
+    traced.view = *view;
+    traced.view.pImage = NULL;
+    return traced;
+}
+
+void cmd_trace_begin_test(struct gfx_context* ctx, char const* name)
+{
+    struct cmd_trace* const trace = ctx->trace;
+    if (!trace)
+        return;
+    trace->num_images = 0;
+    write_record(trace, TRACE_OP_BEGIN_TEST, NULL, 0, name, strlen(name));
+}
+
+void cmd_trace_end_test(
+    struct gfx_context* ctx, struct gpu_alloc const* result, uint64_t hash)
+{
+    if (!ctx->trace)
+        return;
+    struct trace_end_test record = {
+        .hash = hash,
+        .result = make_ref(ctx, result->gpu_addr).block,
+    };
+    write_record(
+        ctx->trace, TRACE_OP_END_TEST, &record, sizeof(record), NULL, 0);
+}
+
+void cmd_trace_memblock(struct gfx_context* ctx, size_t size, int type)
+{
+    if (!ctx->trace)
+        return;
+    struct trace_memblock const record = {size, type};
+    write_record(
+        ctx->trace, TRACE_OP_MEMBLOCK, &record, sizeof(record), NULL, 0);
+}
+
+void cmd_trace_cmdbuf(struct gfx_context* ctx)
+{
+    if (!ctx->trace)
+        return;
+    write_record(ctx->trace, TRACE_OP_CMDBUF, NULL, 0, NULL, 0);
+}
+
+void cmd_trace_image(struct gfx_context* ctx, DkImage const* image,
+    DkImageFormat format, int width, int height, int flags)
+{
+    struct cmd_trace* const trace = ctx->trace;
+    if (!trace)
+        return;
+    if (trace->num_images == TRACE_MAX_IMAGES)
+    {
+        printf("Too many images to trace! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+    trace->images[trace->num_images++] = image;
+    struct trace_image const record = {format, width, height, flags};
+    write_record(trace, TRACE_OP_IMAGE, &record, sizeof(record), NULL, 0);
+}
+
+void cmd_trace_shader(struct gfx_context* ctx, char const* name,
+    void const* dksh, size_t dksh_size)
+{
+    if (!ctx->trace)
+        return;
+    struct trace_shader record;
+    memset(&record, 0, sizeof(record));
+    snprintf(record.name, sizeof(record.name), "%s", name);
+    write_record(ctx->trace, TRACE_OP_SHADER, &record, sizeof(record),
+        dksh, dksh_size);
+}
+
+static void trace_pool(struct gfx_context* ctx, enum trace_op op,
+    DkCmdBuf cmdbuf, uint32_t num)
+{
+    if (!ctx->trace)
+        return;
+    struct trace_pool const record = {cmdbuf_id(ctx, cmdbuf), num};
+    write_record(ctx->trace, op, &record, sizeof(record), NULL, 0);
+}
+
+void cmd_trace_tic_pool(struct gfx_context* ctx, DkCmdBuf cmdbuf, uint32_t num)
+{
+    trace_pool(ctx, TRACE_OP_TIC_POOL, cmdbuf, num);
+}
+
+void cmd_trace_tsc_pool(struct gfx_context* ctx, DkCmdBuf cmdbuf, uint32_t num)
+{
+    trace_pool(ctx, TRACE_OP_TSC_POOL, cmdbuf, num);
+}
+
+void cmd_trace_texture(
+    struct gfx_context* ctx, DkCmdBuf cmdbuf, DkGpuAddr tic_addr,
+    DkGpuAddr tsc_addr, DkImageView const* view, DkSampler const* sampler,
+    DkStage stage, uint32_t index)
+{
+    if (!ctx->trace)
+        return;
+    struct trace_texture record;
+    memset(&record, 0, sizeof(record));
+    record.cmdbuf = cmdbuf_id(ctx, cmdbuf);
+    record.stage = stage;
+    record.index = index;
+    record.tic = make_ref(ctx, tic_addr);
+    record.tsc = make_ref(ctx, tsc_addr);
+    record.view = make_view(ctx->trace, view);
+    record.sampler = *sampler;
+    write_record(
+        ctx->trace, TRACE_OP_TEXTURE, &record, sizeof(record), NULL, 0);
+}
+
+// Blocks holding a single repeated byte, like fresh ones, are only a fill
+static void write_contents(struct gfx_context const* ctx)
+{
+    for (size_t i = 0; i < ctx->num_allocs; ++i)
+    {
+        uint8_t const* const data = ctx->allocs[i].cpu_addr;
+        size_t const size = ctx->allocs[i].size;
+        if (0 == memcmp(data, data + 1, size - 1))
+        {
+            struct trace_fill const record = {i, data[0]};
+            write_record(
+                ctx->trace, TRACE_OP_FILL, &record, sizeof(record), NULL, 0);
+        }
+        else
+        {
+            struct trace_data const record = {i};
+            write_record(ctx->trace, TRACE_OP_DATA, &record, sizeof(record),
+                data, size);
+        }
+    }
+}
+
+void cmd_trace_submit(struct gfx_context* ctx, DkCmdBuf cmdbuf)
+{
+    if (!ctx->trace)
+        return;
+    write_contents(ctx);
+    struct trace_submit const record = {cmdbuf_id(ctx, cmdbuf)};
+    write_record(ctx->trace, TRACE_OP_SUBMIT, &record, sizeof(record), NULL, 0);
+}
+
+void rec_bind_render_targets(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    DkImageView const* const color_targets[], uint32_t num_color_targets,
+    DkImageView const* depth_target)
+{
+    dkCmdBufBindRenderTargets(
+        cmdbuf, color_targets, num_color_targets, depth_target);
+    if (!ctx->trace)
+        return;
+
+    struct trace_render_targets const record = {
+        .cmdbuf = cmdbuf_id(ctx, cmdbuf),
+        .num_color_targets = num_color_targets,
+        .has_depth_target = depth_target != NULL,
+    };
+    struct trace_view views[MAX_RENDER_TARGETS];
+    uint32_t num_views = 0;
+    for (; num_views < num_color_targets; ++num_views)
+        views[num_views] = make_view(ctx->trace, color_targets[num_views]);
+    if (depth_target)
+        views[num_views++] = make_view(ctx->trace, depth_target);
+    write_record(ctx->trace, TRACE_OP_BIND_RENDER_TARGETS, &record,
+        sizeof(record), views, num_views * sizeof(views[0]));
+}
+
+void rec_set_viewports(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t first, DkViewport const viewports[], uint32_t num)
+{
+    dkCmdBufSetViewports(cmdbuf, first, viewports, num);
+    if (!ctx->trace)
+        return;
+    struct trace_array const record = {cmdbuf_id(ctx, cmdbuf), first, num};
+    write_record(ctx->trace, TRACE_OP_SET_VIEWPORTS, &record, sizeof(record),
+        viewports, num * sizeof(viewports[0]));
+}
+
+void rec_set_scissors(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t first, DkScissor const scissors[], uint32_t num)
+{
+    dkCmdBufSetScissors(cmdbuf, first, scissors, num);
+    if (!ctx->trace)
+        return;
+    struct trace_array const record = {cmdbuf_id(ctx, cmdbuf), first, num};
+    write_record(ctx->trace, TRACE_OP_SET_SCISSORS, &record, sizeof(record),
+        scissors, num * sizeof(scissors[0]));
+}
+
+void rec_clear_color(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t target, uint32_t mask, void const* data)
+{
+    dkCmdBufClearColor(cmdbuf, target, mask, data);
+    if (!ctx->trace)
+        return;
+    struct trace_clear_color record = {
+        .cmdbuf = cmdbuf_id(ctx, cmdbuf),
+        .target = target,
+        .mask = mask,
+    };
+    memcpy(record.data, data, sizeof(record.data));
+    write_record(
+        ctx->trace, TRACE_OP_CLEAR_COLOR, &record, sizeof(record), NULL, 0);
+}
+
+void rec_clear_depth_stencil(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    bool clear_depth, float depth, uint8_t stencil_mask,
+    uint8_t stencil_value)
+{
+    dkCmdBufClearDepthStencil(
+        cmdbuf, clear_depth, depth, stencil_mask, stencil_value);
+    if (!ctx->trace)
+        return;
+    struct trace_clear_depth_stencil const record = {
+        cmdbuf_id(ctx, cmdbuf), clear_depth, depth, stencil_mask,
+        stencil_value,
+    };
+    write_record(ctx->trace, TRACE_OP_CLEAR_DEPTH_STENCIL, &record,
+        sizeof(record), NULL, 0);
+}
+
+void rec_bind_shaders(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t stage_mask, DkShader const* const shaders[], uint32_t num)
+{
+    dkCmdBufBindShaders(cmdbuf, stage_mask, shaders, num);
+    if (!ctx->trace)
+        return;
+
+    uint32_t ids[MAX_TEST_SHADERS];
+    if (num > MAX_TEST_SHADERS)
+    {
+        printf("Too many shaders to trace! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+    for (uint32_t i = 0; i < num; ++i)
+    {
+        ids[i] = shader_id(ctx, shaders[i]);
+    }
+    struct trace_array const record = {
+        cmdbuf_id(ctx, cmdbuf), stage_mask, num,
+    };
+    write_record(ctx->trace, TRACE_OP_BIND_SHADERS, &record, sizeof(record),
+        ids, num * sizeof(ids[0]));
+}
+
+void rec_bind_depth_stencil_state(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    DkDepthStencilState const* state)
+{
+    dkCmdBufBindDepthStencilState(cmdbuf, state);
+    if (!ctx->trace)
+        return;
+    struct trace_depth_stencil_state record;
+    memset(&record, 0, sizeof(record));
+    record.cmdbuf = cmdbuf_id(ctx, cmdbuf);
+    record.state = *state;
+    write_record(ctx->trace, TRACE_OP_BIND_DEPTH_STENCIL_STATE, &record,
+        sizeof(record), NULL, 0);
+}
+
+void rec_bind_vtx_attrib_state(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    DkVtxAttribState const attribs[], uint32_t num)
+{
+    dkCmdBufBindVtxAttribState(cmdbuf, attribs, num);
+    if (!ctx->trace)
+        return;
+    struct trace_array const record = {cmdbuf_id(ctx, cmdbuf), 0, num};
+    write_record(ctx->trace, TRACE_OP_BIND_VTX_ATTRIB_STATE, &record,
+        sizeof(record), attribs, num * sizeof(attribs[0]));
+}
+
+void rec_bind_vtx_buffer_state(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    DkVtxBufferState const buffers[], uint32_t num)
+{
+    dkCmdBufBindVtxBufferState(cmdbuf, buffers, num);
+    if (!ctx->trace)
+        return;
+    struct trace_array const record = {cmdbuf_id(ctx, cmdbuf), 0, num};
+    write_record(ctx->trace, TRACE_OP_BIND_VTX_BUFFER_STATE, &record,
+        sizeof(record), buffers, num * sizeof(buffers[0]));
+}
+
+void rec_bind_vtx_buffers(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t first, DkBufExtents const buffers[], uint32_t num)
+{
+    dkCmdBufBindVtxBuffers(cmdbuf, first, buffers, num);
+    if (!ctx->trace)
+        return;
+
+    struct trace_extent extents[MAX_VTX_BUFFERS];
+    for (uint32_t i = 0; i < num; ++i)
+    {
+        extents[i].addr = make_ref(ctx, buffers[i].addr);
+        extents[i].size = buffers[i].size;
+    }
+    struct trace_array const record = {cmdbuf_id(ctx, cmdbuf), first, num};
+    write_record(ctx->trace, TRACE_OP_BIND_VTX_BUFFERS, &record,
+        sizeof(record), extents, num * sizeof(extents[0]));
+}
+
+void rec_draw(struct gfx_context* ctx, DkCmdBuf cmdbuf, DkPrimitive prim,
+    uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex,
+    uint32_t first_instance)
+{
+    dkCmdBufDraw(cmdbuf, prim, vertex_count, instance_count, first_vertex,
+        first_instance);
+    if (!ctx->trace)
+        return;
+    struct trace_draw const record = {
+        cmdbuf_id(ctx, cmdbuf), prim, vertex_count, instance_count,
+        first_vertex, first_instance,
+    };
+    write_record(ctx->trace, TRACE_OP_DRAW, &record, sizeof(record), NULL, 0);
+}
+
+// Replaying
+
+// One test's records, each padded to 8 bytes so arrays in them are aligned
+struct trace_test
+{
+    char name[64];
+    uint8_t* records;
+    size_t size;
+    size_t capacity;
+};
+
+struct replay
+{
+    struct gfx_context* ctx;
+    DkImage images[TRACE_MAX_IMAGES];
+    size_t num_images;
+    struct gpu_alloc result;
+    bool has_result;
+    uint64_t expected_hash;
+};
+
+// A record being decoded, NULL fields once it turned out malformed
+struct record_reader
+{
+    uint8_t const* data;
+    size_t size;
+};
+
+static bool read_head(struct record_reader* reader, void* head, size_t size)
+{
+    if (!reader->data || reader->size < size)
+    {
+        reader->data = NULL;
+        return false;
+    }
+    memcpy(head, reader->data, size);
+    reader->data += size;
+    reader->size -= size;
+    return true;
+}
+
+// The rest of the record as an array of num elements
+static void const* read_tail(
+    struct record_reader* reader, size_t num, size_t element_size)
+{
+    if (!reader->data || reader->size != num * element_size)
+    {
+        reader->data = NULL;
+        return NULL;
+    }
+    return reader->data;
+}
+
+static bool valid_block(struct gfx_context const* ctx, uint32_t block)
+{
+    return block < ctx->num_allocs;
+}
+
+static bool valid_cmdbuf(struct gfx_context const* ctx, uint32_t cmdbuf)
+{
+    return cmdbuf < ctx->num_cmdbufs;
+}
+
+static bool resolve_ref(
+    struct gfx_context const* ctx, struct trace_ref ref, DkGpuAddr* addr)
+{
+    if (!valid_block(ctx, ref.block)
+        || ref.offset >= ctx->allocs[ref.block].size)
+        return false;
+    *addr = ctx->allocs[ref.block].gpu_addr + ref.offset;
+    return true;
+}
+
+static bool resolve_view(struct replay const* replay,
+    struct trace_view const* traced, DkImageView* view)
+{
+    if (traced->image >= replay->num_images)
+        return false;
+    *view = traced->view;
+    view->pImage = &replay->images[traced->image];
+    return true;
+}
+
+static bool replay_resource(
+    struct replay* replay, enum trace_op op, struct record_reader* reader)
+{
+    struct gfx_context* const ctx = replay->ctx;
+    switch (op)
+    {
+    case TRACE_OP_MEMBLOCK:
+    {
+        struct trace_memblock record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        if (record.type >= NUM_BLOCK_TYPES)
+            return false;
+        make_memory(ctx, record.size, record.type);
+        return true;
+    }
+    case TRACE_OP_CMDBUF:
+        if (ctx->num_cmdbufs == CMDBUF_RING_SIZE)
+            return false;
+        make_cmdbuf(ctx);
+        return true;
+    case TRACE_OP_IMAGE:
+    {
+        struct trace_image record;
+        if (!read_head(reader, &record, sizeof(record))
+            || replay->num_images == TRACE_MAX_IMAGES)
+            return false;
+        DkImage* const image = &replay->images[replay->num_images++];
+        struct gpu_alloc memory;
+        if (record.flags & DkImageFlags_UsageRender)
+        {
+            make_render_target(ctx, record.format, record.width,
+                record.height, image, &memory);
+        }
+        else
+        {
+            make_image2d(ctx, record.format, record.width, record.height,
+                image, &memory);
+        }
+        return true;
+    }
+    case TRACE_OP_SHADER:
+    {
+        struct trace_shader record;
+        if (!read_head(reader, &record, sizeof(record)) || reader->size == 0
+            || !memchr(record.name, '\0', sizeof(record.name)))
+            return false;
+        timing_lap(ctx->timing, PHASE_RECORD, &ctx->clock);
+        make_shader_from_dksh(ctx, record.name, reader->data, reader->size);
+        return true;
+    }
+    case TRACE_OP_TIC_POOL:
+    case TRACE_OP_TSC_POOL:
+    {
+        struct trace_pool record;
+        if (!read_head(reader, &record, sizeof(record))
+            || !valid_cmdbuf(ctx, record.cmdbuf))
+            return false;
+        DkCmdBuf const cmdbuf = ctx->cmdbufs[record.cmdbuf];
+        if (op == TRACE_OP_TIC_POOL)
+            bind_tic_pool(ctx, cmdbuf, record.num);
+        else
+            bind_tsc_pool(ctx, cmdbuf, record.num);
+        return true;
+    }
+    case TRACE_OP_FILL:
+    {
+        struct trace_fill record;
+        if (!read_head(reader, &record, sizeof(record))
+            || !valid_block(ctx, record.block))
+            return false;
+        struct gpu_alloc const* const memory = &ctx->allocs[record.block];
+        memset(memory->cpu_addr, record.value, memory->size);
+        return true;
+    }
+    case TRACE_OP_DATA:
+    {
+        struct trace_data record;
+        if (!read_head(reader, &record, sizeof(record))
+            || !valid_block(ctx, record.block))
+            return false;
+        struct gpu_alloc const* const memory = &ctx->allocs[record.block];
+        if (reader->size > memory->size)
+            return false;
+        memcpy(memory->cpu_addr, reader->data, reader->size);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+static bool replay_command(
+    struct replay* replay, enum trace_op op, struct record_reader* reader)
+{
+    struct gfx_context* const ctx = replay->ctx;
+    // Every command starts with its command buffer
+    uint32_t cmdbuf_index;
+    if (reader->size < sizeof(cmdbuf_index))
+        return false;
+    memcpy(&cmdbuf_index, reader->data, sizeof(cmdbuf_index));
+    if (!valid_cmdbuf(ctx, cmdbuf_index))
+        return false;
+    DkCmdBuf const cmdbuf = ctx->cmdbufs[cmdbuf_index];
+
+    switch (op)
+    {
+    case TRACE_OP_TEXTURE:
+    {
+        struct trace_texture record;
+        DkGpuAddr tic_addr;
+        DkGpuAddr tsc_addr;
+        DkImageView view;
+        if (!read_head(reader, &record, sizeof(record))
+            || !resolve_ref(ctx, record.tic, &tic_addr)
+            || !resolve_ref(ctx, record.tsc, &tsc_addr)
+            || !resolve_view(replay, &record.view, &view))
+            return false;
+        bind_texture(ctx, cmdbuf, tic_addr, tsc_addr, &view, &record.sampler,
+            record.stage, record.index);
+        return true;
+    }
+    case TRACE_OP_BIND_RENDER_TARGETS:
+    {
+        struct trace_render_targets record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        uint32_t const num_views =
+            record.num_color_targets + (record.has_depth_target != 0);
+        struct trace_view const* const traced =
+            read_tail(reader, num_views, sizeof(*traced));
+        if (!traced || num_views > MAX_RENDER_TARGETS)
+            return false;
+
+        DkImageView views[MAX_RENDER_TARGETS];
+        DkImageView const* color_targets[MAX_RENDER_TARGETS];
+        for (uint32_t i = 0; i < num_views; ++i)
+        {
+            struct trace_view view;
+            memcpy(&view, &traced[i], sizeof(view));
+            if (!resolve_view(replay, &view, &views[i]))
+                return false;
+            color_targets[i] = &views[i];
+        }
+        dkCmdBufBindRenderTargets(cmdbuf, color_targets,
+            record.num_color_targets, record.has_depth_target
+                ? &views[record.num_color_targets] : NULL);
+        return true;
+    }
+    case TRACE_OP_SET_VIEWPORTS:
+    case TRACE_OP_SET_SCISSORS:
+    {
+        struct trace_array record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        if (op == TRACE_OP_SET_VIEWPORTS)
+        {
+            DkViewport const* const viewports =
+                read_tail(reader, record.num, sizeof(*viewports));
+            if (!viewports)
+                return false;
+            dkCmdBufSetViewports(cmdbuf, record.first, viewports, record.num);
+        }
+        else
+        {
+            DkScissor const* const scissors =
+                read_tail(reader, record.num, sizeof(*scissors));
+            if (!scissors)
+                return false;
+            dkCmdBufSetScissors(cmdbuf, record.first, scissors, record.num);
+        }
+        return true;
+    }
+    case TRACE_OP_CLEAR_COLOR:
+    {
+        struct trace_clear_color record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        dkCmdBufClearColor(cmdbuf, record.target, record.mask, record.data);
+        return true;
+    }
+    case TRACE_OP_CLEAR_DEPTH_STENCIL:
+    {
+        struct trace_clear_depth_stencil record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        dkCmdBufClearDepthStencil(cmdbuf, record.clear_depth, record.depth,
+            record.stencil_mask, record.stencil_value);
+        return true;
+    }
+    case TRACE_OP_BIND_SHADERS:
+    {
+        struct trace_array record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        uint32_t const* const ids = read_tail(reader, record.num, sizeof(*ids));
+        DkShader const* shaders[MAX_TEST_SHADERS];
+        if (!ids || record.num > MAX_TEST_SHADERS)
+            return false;
+        for (uint32_t i = 0; i < record.num; ++i)
+        {
+            if (ids[i] >= ctx->num_shaders)
+                return false;
+            shaders[i] = ctx->shaders[ids[i]];
+        }
+        dkCmdBufBindShaders(cmdbuf, record.first, shaders, record.num);
+        return true;
+    }
+    case TRACE_OP_BIND_DEPTH_STENCIL_STATE:
+    {
+        struct trace_depth_stencil_state record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        dkCmdBufBindDepthStencilState(cmdbuf, &record.state);
+        return true;
+    }
+    case TRACE_OP_BIND_VTX_ATTRIB_STATE:
+    {
+        struct trace_array record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        DkVtxAttribState const* const attribs =
+            read_tail(reader, record.num, sizeof(*attribs));
+        if (!attribs)
+            return false;
+        dkCmdBufBindVtxAttribState(cmdbuf, attribs, record.num);
+        return true;
+    }
+    case TRACE_OP_BIND_VTX_BUFFER_STATE:
+    {
+        struct trace_array record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        DkVtxBufferState const* const buffers =
+            read_tail(reader, record.num, sizeof(*buffers));
+        if (!buffers)
+            return false;
+        dkCmdBufBindVtxBufferState(cmdbuf, buffers, record.num);
+        return true;
+    }
+    case TRACE_OP_BIND_VTX_BUFFERS:
+    {
+        struct trace_array record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        struct trace_extent const* const extents =
+            read_tail(reader, record.num, sizeof(*extents));
+        DkBufExtents buffers[MAX_VTX_BUFFERS];
+        if (!extents || record.num > MAX_VTX_BUFFERS)
+            return false;
+        for (uint32_t i = 0; i < record.num; ++i)
+        {
+            if (!resolve_ref(ctx, extents[i].addr, &buffers[i].addr))
+                return false;
+            buffers[i].size = extents[i].size;
+        }
+        dkCmdBufBindVtxBuffers(cmdbuf, record.first, buffers, record.num);
+        return true;
+    }
+    case TRACE_OP_DRAW:
+    {
+        struct trace_draw record;
+        if (!read_head(reader, &record, sizeof(record)))
+            return false;
+        dkCmdBufDraw(cmdbuf, record.prim, record.vertex_count,
+            record.instance_count, record.first_vertex,
+            record.first_instance);
+        return true;
+    }
+    case TRACE_OP_SUBMIT:
+        submit_commands(ctx, cmdbuf);
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool replay_record(
+    struct replay* replay, enum trace_op op, struct record_reader* reader)
+{
+    switch (op)
+    {
+    case TRACE_OP_END_TEST:
+    {
+        struct trace_end_test record;
+        if (!read_head(reader, &record, sizeof(record))
+            || !valid_block(replay->ctx, record.result))
+            return false;
+        replay->result = replay->ctx->allocs[record.result];
+        replay->has_result = true;
+        replay->expected_hash = record.hash;
+        return true;
+    }
+    case TRACE_OP_MEMBLOCK:
+    case TRACE_OP_CMDBUF:
+    case TRACE_OP_IMAGE:
+    case TRACE_OP_SHADER:
+    case TRACE_OP_TIC_POOL:
+    case TRACE_OP_TSC_POOL:
+    case TRACE_OP_FILL:
+    case TRACE_OP_DATA:
+        return replay_resource(replay, op, reader);
+    default:
+        return replay_command(replay, op, reader);
+    }
+}
+
+// Runs the test's records once, leaving its resources in the context
+static bool replay_test(struct replay* replay, struct trace_test const* test)
+{
+    replay->num_images = 0;
+    replay->has_result = false;
+    for (size_t offset = 0; offset < test->size;)
+    {
+        struct trace_record_header header;
+        memcpy(&header, test->records + offset, sizeof(header));
+        offset += sizeof(header);
+
+        struct record_reader reader = {test->records + offset, header.size};
+        if (!replay_record(replay, header.op, &reader))
+        {
+            printf("Invalid record %" PRIu32 " in \"%s\"\n",
+                header.op, test->name);
+            return false;
+        }
+        offset += (header.size + 7) & ~(size_t)7;
+    }
+    if (!replay->has_result)
+    {
+        printf("\"%s\" has no result\n", test->name);
+        return false;
+    }
+    return true;
+}
+
+static bool read_header(FILE* file, struct trace_record_header* header)
+{
+    return fread(header, sizeof(*header), 1, file) == 1
+        && header->op < NUM_TRACE_OPS;
+}
+
+// Reads up to the next test's end. Returns false at the end of the trace,
+// *valid tells whether that was cleanly between tests.
+static bool read_test(FILE* file, struct trace_test* test, bool* valid)
+{
+    struct trace_record_header header;
+    *valid = true;
+    if (fread(&header, sizeof(header), 1, file) != 1)
+        return false;
+
+    *valid = false;
+    if (header.op != TRACE_OP_BEGIN_TEST || header.size >= sizeof(test->name))
+        return false;
+    if (header.size && fread(test->name, header.size, 1, file) != 1)
+        return false;
+    test->name[header.size] = '\0';
+
+    test->size = 0;
+    do
+    {
+        if (!read_header(file, &header))
+            return false;
+        size_t const padded_size = (header.size + 7) & ~(size_t)7;
+        size_t const needed = test->size + sizeof(header) + padded_size;
+        if (needed > test->capacity)
+        {
+            test->capacity = needed * 2;
+            uint8_t* const records = checked_malloc(test->capacity);
+            if (test->size)
+                memcpy(records, test->records, test->size);
+            free(test->records);
+            test->records = records;
+        }
+        memcpy(test->records + test->size, &header, sizeof(header));
+        test->size += sizeof(header);
+        if (header.size && fread(test->records + test->size, header.size, 1,
+                file) != 1)
+            return false;
+        test->size += padded_size;
+    }
+    while (header.op != TRACE_OP_END_TEST);
+
+    *valid = true;
+    return true;
+}
+
+static bool check_file_header(FILE* file)
+{
+    struct trace_file_header header;
+    if (fread(&header, sizeof(header), 1, file) != 1
+        || header.magic != TRACE_MAGIC)
+    {
+        printf("Not a command trace\n");
+        return false;
+    }
+    if (header.version != TRACE_VERSION)
+    {
+        printf("Trace version %" PRIu32 " is not supported, expected %d\n",
+            header.version, TRACE_VERSION);
+        return false;
+    }
+    if (header.view_size != sizeof(DkImageView)
+        || header.sampler_size != sizeof(DkSampler)
+        || header.depth_stencil_size != sizeof(DkDepthStencilState))
+    {
+        printf("Trace recorded with other deko3d struct layouts\n");
+        return false;
+    }
+    return true;
+}
+
+// Counts the selected tests, skipping over their records
+static size_t count_tests(FILE* file, struct test_filter const* filter)
+{
+    size_t count = 0;
+    struct trace_record_header header;
+    while (read_header(file, &header))
+    {
+        char name[64];
+        if (header.op == TRACE_OP_BEGIN_TEST && header.size < sizeof(name))
+        {
+            if (header.size && fread(name, header.size, 1, file) != 1)
+                break;
+            name[header.size] = '\0';
+            count += test_filter_selects(filter, name, NULL);
+        }
+        else if (fseek(file, header.size, SEEK_CUR) != 0)
+            break;
+    }
+    return count;
+}
+
+bool replay_trace(DkDevice device, DkQueue queue, char const* path,
+    uint32_t count, struct test_filter const* filter, struct test_log* log,
+    FILE* timing_log)
+{
+    FILE* const file = fopen(path, "rb");
+    if (!file)
+    {
+        printf("Failed to open \"%s\"\n", path);
+        return false;
+    }
+    if (!check_file_header(file))
+    {
+        fclose(file);
+        return false;
+    }
+    long const records_start = ftell(file);
+    size_t const num_selected = count_tests(file, filter);
+    fseek(file, records_start, SEEK_SET);
+
+    // Timestamps are only taken for the timing log
+    struct gpu_timer timer;
+    struct gpu_timer* const gpu_timer = timing_log ? &timer : NULL;
+    if (gpu_timer)
+        gpu_timer_create(gpu_timer, device, queue, 1);
+
+    struct shader_cache shader_cache;
+    shader_cache_init(&shader_cache, device);
+    struct gfx_context ctx;
+    init_context(&ctx, device, queue, NULL, &shader_cache);
+    ctx.timer = gpu_timer;
+
+    struct replay replay = {.ctx = &ctx};
+    struct trace_test test = {0};
+
+    test_log_begin_suite(log, "replay");
+    test_log_printf(log, "Replaying %s, %" PRIu32 " times each...\n\n",
+        path, count);
+    test_log_flush(log);
+
+    size_t failures = 0;
+    size_t num_run = 0;
+    bool valid = true;
+    while (valid && read_test(file, &test, &valid))
+    {
+        if (!test_filter_selects(filter, test.name, NULL))
+            continue;
+        test_log_begin_test(log, num_run++, num_selected, test.name, 45);
+
+        bool pass = true;
+        for (uint32_t i = 0; valid && i < count; ++i)
+        {
+            struct test_timing timing = {0};
+            ctx.timing = &timing;
+            ctx.clock = timing_now_ns();
+
+            valid = replay_test(&replay, &test);
+            timing_lap(&timing, PHASE_RECORD, &ctx.clock);
+            wait_commands(&ctx);
+            uint64_t const hash = valid ? hash_alloc(&replay.result,
+                alloc_info(&ctx, &replay.result).size) : 0;
+            timing_lap(&timing, PHASE_VERIFY, &ctx.clock);
+            reset_context(&ctx);
+
+            bool const iteration_pass = valid && hash == replay.expected_hash;
+            if (!iteration_pass && pass)
+                test_log_printf(log, "got 0x%016" PRIx64 " ", hash);
+            pass = pass && iteration_pass;
+            timing_write(timing_log, "replay", test.name, iteration_pass,
+                &timing);
+        }
+        failures += !pass;
+        test_log_end_test(log, pass);
+        if (test_log_budget_exceeded(log))
+        {
+            test_log_printf(log, "\nStopping, %zu tests failed\n",
+                log->num_failed);
+            break;
+        }
+    }
+    if (!valid)
+        test_log_printf(log, "\nThe trace is truncated or corrupt\n");
+
+    test_log_printf(log,
+        "\n%3d%% tests passed, %zd tests failed out of %zd\n\n",
+        num_run ? (int)((num_run - failures) * 100 / (float)num_run) : 100,
+        failures, num_run);
+    test_log_flush(log);
+
+    free(test.records);
+    destroy_context(&ctx);
+    shader_cache_destroy(&shader_cache);
+    if (gpu_timer)
+        gpu_timer_destroy(gpu_timer);
+    fclose(file);
+    return valid;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <deko3d.h>
+
+#include "graphics_context.h"
+#include "test_filter.h"
+#include "test_log.h"
+
+#define TRACE_MAX_IMAGES 32
+
+// Binary trace of the graphics tests: every resource a test creates, the
+// commands it records, the contents of its memory at submit and the hash it
+// got. Resources are referred to by creation order, so a replay does not
+// depend on the addresses of the recording run.
+//
+// Image views, samplers and depth stencil states are written as the deko3d
+// structs they are. A trace only replays against the same layouts, so traces
+// from the host mock don't replay on a device nor the other way around. The
+// struct sizes are checked, a layout change of the same size is not caught.
+struct cmd_trace
+{
+    FILE* file;
+    // Images of the test being recorded, indexed by id
+    DkImage const* images[TRACE_MAX_IMAGES];
+    size_t num_images;
+};
+
+bool cmd_trace_open(struct cmd_trace* trace, char const* path);
+void cmd_trace_close(struct cmd_trace* trace);
+
+// Test boundaries, no-ops unless the context has a trace
+void cmd_trace_begin_test(struct gfx_context* ctx, char const* name);
+void cmd_trace_end_test(
+    struct gfx_context* ctx, struct gpu_alloc const* result, uint64_t hash);
+
+// Called by the context for resources it just created
+void cmd_trace_memblock(struct gfx_context* ctx, size_t size, int type);
+void cmd_trace_cmdbuf(struct gfx_context* ctx);
+void cmd_trace_image(struct gfx_context* ctx, DkImage const* image,
+    DkImageFormat format, int width, int height, int flags);
+void cmd_trace_shader(struct gfx_context* ctx, char const* name,
+    void const* dksh, size_t dksh_size);
+void cmd_trace_tic_pool(struct gfx_context* ctx, DkCmdBuf cmdbuf, uint32_t num);
+void cmd_trace_tsc_pool(struct gfx_context* ctx, DkCmdBuf cmdbuf, uint32_t num);
+void cmd_trace_texture(
+    struct gfx_context* ctx, DkCmdBuf cmdbuf, DkGpuAddr tic_addr,
+    DkGpuAddr tsc_addr, DkImageView const* view, DkSampler const* sampler,
+    DkStage stage, uint32_t index);
+// Writes the memory the commands read, then the submit
+void cmd_trace_submit(struct gfx_context* ctx, DkCmdBuf cmdbuf);
+
+// deko3d commands as recorded by the tests, forwarded to deko3d
+void rec_bind_render_targets(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    DkImageView const* const color_targets[], uint32_t num_color_targets,
+    DkImageView const* depth_target);
+void rec_set_viewports(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t first, DkViewport const viewports[], uint32_t num);
+void rec_set_scissors(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t first, DkScissor const scissors[], uint32_t num);
+void rec_clear_color(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t target, uint32_t mask, void const* data);
+void rec_clear_depth_stencil(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    bool clear_depth, float depth, uint8_t stencil_mask,
+    uint8_t stencil_value);
+void rec_bind_shaders(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t stage_mask, DkShader const* const shaders[], uint32_t num);
+void rec_bind_depth_stencil_state(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    DkDepthStencilState const* state);
+void rec_bind_vtx_attrib_state(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    DkVtxAttribState const attribs[], uint32_t num);
+void rec_bind_vtx_buffer_state(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    DkVtxBufferState const buffers[], uint32_t num);
+void rec_bind_vtx_buffers(struct gfx_context* ctx, DkCmdBuf cmdbuf,
+    uint32_t first, DkBufExtents const buffers[], uint32_t num);
+void rec_draw(struct gfx_context* ctx, DkCmdBuf cmdbuf, DkPrimitive prim,
+    uint32_t vertex_count, uint32_t instance_count, uint32_t first_vertex,
+    uint32_t first_instance);
+
+// Re-issues the selected tests of a trace count times each, without the
+// shader pack or the test functions. A test passes when every run hashes to
+// what was recorded. Returns false when the trace can't be read.
+bool replay_trace(DkDevice device, DkQueue queue, char const* path,
+    uint32_t count, struct test_filter const* filter, struct test_log* log,
+    FILE* timing_log);
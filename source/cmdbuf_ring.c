@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deko3d.h>
+
+#include "cmdbuf_ring.h"
+
+// Memory a command buffer starts with and grows by, enough for most tests
+#define CMDBUF_CHUNK_SIZE 0x1000
+#define CMDBUF_BLOCK_SIZE 0x10000
+
+// Also the memory callback of the command buffers
+static void add_memory(void* user_data, DkCmdBuf cmdbuf, size_t min_size)
+{
+    struct cmdbuf_slot* const slot = user_data;
+    size_t const size =
+        min_size > CMDBUF_CHUNK_SIZE ? min_size : CMDBUF_CHUNK_SIZE;
+    struct gpu_alloc const chunk =
+        gpu_arena_alloc(&slot->memory, size, DK_CMDMEM_ALIGNMENT);
+    dkCmdBufAddMemory(cmdbuf, chunk.memblock, chunk.offset, chunk.size);
+}
+
+void cmdbuf_ring_init(struct cmdbuf_ring* ring, DkDevice device)
+{
+    memset(ring, 0, sizeof(*ring));
+    for (size_t i = 0; i < CMDBUF_RING_SIZE; ++i)
+    {
+        struct cmdbuf_slot* const slot = &ring->slots[i];
+        gpu_arena_init(&slot->memory, device, BLOCK_NONE, CMDBUF_BLOCK_SIZE);
+
+        DkCmdBufMaker cmdbuf_mk;
+        dkCmdBufMakerDefaults(&cmdbuf_mk, device);
+        cmdbuf_mk.userData = slot;
+        cmdbuf_mk.cbAddMem = add_memory;
+        slot->cmdbuf = dkCmdBufCreate(&cmdbuf_mk);
+    }
+}
+
+static void wait_slot(struct cmdbuf_slot* slot)
+{
+    if (!slot->is_pending)
+        return;
+    dkFenceWait(&slot->fence, -1);
+    slot->is_pending = false;
+}
+
+void cmdbuf_ring_destroy(struct cmdbuf_ring* ring)
+{
+    for (size_t i = 0; i < CMDBUF_RING_SIZE; ++i)
+    {
+        struct cmdbuf_slot* const slot = &ring->slots[i];
+        wait_slot(slot);
+        dkCmdBufDestroy(slot->cmdbuf);
+        gpu_arena_destroy(&slot->memory);
+    }
+    memset(ring, 0, sizeof(*ring));
+}
+
+DkCmdBuf cmdbuf_ring_acquire(struct cmdbuf_ring* ring)
+{
+    struct cmdbuf_slot* const slot = &ring->slots[ring->next];
+    if (slot->is_recording)
+    {
+        printf("Too many command buffers recording! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+    ring->next = (ring->next + 1) % CMDBUF_RING_SIZE;
+
+    wait_slot(slot);
+    // Clearing keeps recording in the chunk it was at, start over at the
+    // beginning of the slot's memory
+    dkCmdBufClear(slot->cmdbuf);
+    gpu_arena_reset(&slot->memory);
+    add_memory(slot, slot->cmdbuf, CMDBUF_CHUNK_SIZE);
+    slot->is_recording = true;
+    return slot->cmdbuf;
+}
+
+void cmdbuf_ring_signal(
+    struct cmdbuf_ring* ring, DkQueue queue, DkCmdBuf cmdbuf)
+{
+    for (size_t i = 0; i < CMDBUF_RING_SIZE; ++i)
+    {
+        struct cmdbuf_slot* const slot = &ring->slots[i];
+        if (slot->cmdbuf != cmdbuf)
+            continue;
+        dkQueueSignalFence(queue, &slot->fence, true);
+        dkQueueFlush(queue);
+        slot->is_recording = false;
+        slot->is_pending = true;
+        return;
+    }
+    printf("Command buffer not from the ring! Aborting...\n");
+    exit(EXIT_FAILURE);
+}
+
+void cmdbuf_ring_wait(struct cmdbuf_ring* ring)
+{
+    for (size_t i = 0; i < CMDBUF_RING_SIZE; ++i)
+        wait_slot(&ring->slots[i]);
+}
+
+void cmdbuf_ring_release(struct cmdbuf_ring* ring)
+{
+    for (size_t i = 0; i < CMDBUF_RING_SIZE; ++i)
+        ring->slots[i].is_recording = false;
+}
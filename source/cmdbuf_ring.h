@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <deko3d.h>
+
+#include "gpu_arena.h"
+
+#define CMDBUF_RING_SIZE 4
+
+struct cmdbuf_slot
+{
+    DkCmdBuf cmdbuf;
+    // Signaled when the GPU is done with the last submission
+    DkFence fence;
+    bool is_recording;
+    bool is_pending;
+    // Chunks of command memory, the command buffer asks for more when it
+    // runs out
+    struct gpu_arena memory;
+};
+
+// Command buffers kept for the whole run and handed out in turn. A slot is
+// cleared instead of recreated once its fence says the GPU is done with it,
+// and its memory stays, so recording doesn't allocate once the slots have
+// grown to what the tests record.
+struct cmdbuf_ring
+{
+    struct cmdbuf_slot slots[CMDBUF_RING_SIZE];
+    size_t next;
+};
+
+void cmdbuf_ring_init(struct cmdbuf_ring* ring, DkDevice device);
+
+// Waits for the GPU to be done with every slot
+void cmdbuf_ring_destroy(struct cmdbuf_ring* ring);
+
+// The next command buffer, empty. Aborts when every slot is still recording.
+DkCmdBuf cmdbuf_ring_acquire(struct cmdbuf_ring* ring);
+
+// Signals the slot's fence after what was submitted from the command buffer
+// and flushes the queue, so the GPU starts on it
+void cmdbuf_ring_signal(
+    struct cmdbuf_ring* ring, DkQueue queue, DkCmdBuf cmdbuf);
+
+// Waits for the GPU to be done with everything submitted from the ring
+void cmdbuf_ring_wait(struct cmdbuf_ring* ring);
+
+// Slots that were acquired but never submitted can be acquired again
+void cmdbuf_ring_release(struct cmdbuf_ring* ring);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sass_decode.h"
+
+// Data tests run one invocation per input tuple in workgroups of this size
+#define DATA_TEST_WORKGROUP_SIZE 128
+#define DATA_TEST_MAX_WORDS 4
+
+#define TEST_VARIANT_MAX_PATCHES 8
+
+// One expansion of a template program, unused patches are left zeroed
+struct test_variant
+{
+    char const* name;
+    uint32_t expected_value;
+    struct sass_patch patches[TEST_VARIANT_MAX_PATCHES];
+};
+
+struct test_variants
+{
+    struct test_variant const* variants;
+    size_t count;
+};
+
+#define DEFINE_MTEST(id) bool test_##id(uint32_t* results)
+
+#define DECLARE_MTEST(id) DEFINE_MTEST(id);
+
+#define DEFINE_DTEST_INPUTS(id) \
+    void inputs_##id(uint32_t* inputs, uint32_t num_inputs)
+
+#define DEFINE_DTEST_REFERENCE(id) \
+    void reference_##id(uint32_t const* input, uint32_t* expected)
+
+#define DECLARE_DTEST(id)     \
+    DEFINE_DTEST_INPUTS(id);  \
+    DEFINE_DTEST_REFERENCE(id);
+
+#define DEFINE_VTEST(id) struct test_variants const variants_##id
+
+#define DECLARE_VTEST(id) extern DEFINE_VTEST(id);
+
+#define TEST_VARIANTS(table) { table, sizeof(table) / sizeof(table[0]) }
@@ -1,8 +1,17 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdio.h>
 
 #include <switch.h>
 #include <deko3d.h>
 
-void run_compute_tests(DkDevice device, DkQueue queue, bool automatic_mode);
+#include "goldens.h"
+#include "shader_pack.h"
+#include "test_filter.h"
+#include "test_log.h"
+
+void run_compute_tests(DkDevice device, DkQueue queue,
+    struct shader_pack const* pack, struct test_filter const* filter,
+    struct goldens* goldens, struct test_log* log, bool batched_mode,
+    FILE* timing_log);
@@ -0,0 +1,138 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "compute_checks.h"
+#include "fp16.h"
+
+#define DATA_TEST_SEED 0x2545f491
+
+static uint32_t const int_edges[] = {
+    0x00000000, 0x00000001, 0x00000002, 0x7fffffff,
+    0x80000000, 0x80000001, 0xfffffffe, 0xffffffff,
+};
+
+static uint32_t const float_edges[] = {
+    0x00000000, 0x80000000, 0x00000001, 0x807fffff,
+    0x00800000, 0x3f800000, 0xbf800000, 0x3f800001,
+    0x33800000, 0x4b800000, 0x7f7fffff, 0xff7fffff,
+    0x7f800000, 0xff800000, 0x7fc00000, 0x7f800001,
+};
+
+static uint16_t const half_edges[] = {
+    0x0000, 0x8000, 0x0001, 0x83ff, 0x0400, 0x3c00, 0xbc00, 0x3c01,
+    0x1400, 0x7bff, 0xfbff, 0x7c00, 0xfc00, 0x7e00, 0x7c01, 0x5bff,
+};
+
+#define NUM_EDGES(edges) (sizeof(edges) / sizeof(edges[0]))
+
+static uint32_t xorshift(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// The first tuples are every combination of the edge values, the rest are
+// random words from a fixed seed
+static void fill_inputs(uint32_t* inputs, uint32_t num_inputs, int words,
+    uint32_t const* edges, uint32_t num_edges)
+{
+    uint32_t num_combinations = 1;
+    for (int i = 0; i < words; ++i)
+        num_combinations *= num_edges;
+
+    uint32_t state = DATA_TEST_SEED;
+    for (uint32_t i = 0; i < num_inputs; ++i)
+    {
+        uint32_t combination = i;
+        for (int j = 0; j < words; ++j)
+        {
+            if (i < num_combinations)
+            {
+                inputs[i * words + j] = edges[combination % num_edges];
+                combination /= num_edges;
+            }
+            else
+                inputs[i * words + j] = xorshift(&state);
+        }
+    }
+}
+
+static uint32_t flush_float(uint32_t bits)
+{
+    return (bits & 0x7f800000) == 0 ? bits & 0x80000000 : bits;
+}
+
+static float as_float(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint32_t as_uint(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+// 64-bit add through IADD.CC and IADD.X.CC, the output is the sum and the
+// condition codes left by the high half
+DEFINE_DTEST_INPUTS(data_iadd_x_cc)
+{
+    fill_inputs(inputs, num_inputs, 4, int_edges, NUM_EDGES(int_edges));
+}
+
+DEFINE_DTEST_REFERENCE(data_iadd_x_cc)
+{
+    uint64_t const a = input[0] | (uint64_t)input[1] << 32;
+    uint64_t const b = input[2] | (uint64_t)input[3] << 32;
+    uint64_t const sum = a + b;
+    bool const carry = sum < a;
+    bool const overflow = ((a ^ sum) & (b ^ sum)) >> 63;
+    expected[0] = (uint32_t)sum;
+    expected[1] = (uint32_t)(sum >> 32);
+    expected[2] = (sum == 0) | (uint32_t)(sum >> 63) << 1 | carry << 2
+        | overflow << 3;
+    expected[3] = 0;
+}
+
+DEFINE_DTEST_INPUTS(data_fadd_ftz)
+{
+    fill_inputs(inputs, num_inputs, 2, float_edges, NUM_EDGES(float_edges));
+}
+
+DEFINE_DTEST_REFERENCE(data_fadd_ftz)
+{
+    float const a = as_float(flush_float(input[0]));
+    float const b = as_float(flush_float(input[1]));
+    float const result = a + b;
+    expected[0] = isnan(result) ? 0x7fffffff : flush_float(as_uint(result));
+}
+
+// Edge halves are paired with themselves and with the list reversed, so
+// both lanes see every edge
+DEFINE_DTEST_INPUTS(data_hadd2)
+{
+    uint32_t const num_halves = NUM_EDGES(half_edges);
+    uint32_t edges[NUM_EDGES(half_edges) * 2];
+    for (uint32_t i = 0; i < num_halves; ++i)
+    {
+        edges[i * 2] = half_edges[i] * 0x10001u;
+        edges[i * 2 + 1] =
+            half_edges[i] | (uint32_t)half_edges[num_halves - 1 - i] << 16;
+    }
+    fill_inputs(inputs, num_inputs, 2, edges, NUM_EDGES(edges));
+}
+
+DEFINE_DTEST_REFERENCE(data_hadd2)
+{
+    struct fp16x2_mods const mods = {0};
+    expected[0] = fp16x2_execute(FP16X2_ADD, &mods, input[0], input[1], 0, 0);
+}
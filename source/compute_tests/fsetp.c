@@ -0,0 +1,96 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "compute_checks.h"
+
+// fsetp.sass loads its operands with MOV32I at instructions 2 and 3, then
+// compares them with FSETP.<cmp>.FTZ.AND at instruction 4
+#define FSETP_INSN_A 2
+#define FSETP_INSN_B 3
+#define FSETP_INSN_SETP 4
+
+enum fsetp_compare
+{
+    FSETP_F, FSETP_LT, FSETP_EQ, FSETP_LE, FSETP_GT, FSETP_NE, FSETP_GE,
+    FSETP_NUM, FSETP_NAN, FSETP_LTU, FSETP_EQU, FSETP_LEU, FSETP_GTU,
+    FSETP_NEU, FSETP_GEU, FSETP_T,
+};
+
+#define FSETP_VARIANT(name, compare, a, b, expected)                           \
+    { name, expected,                                                          \
+      { { FSETP_INSN_A, 20, 32, a }, { FSETP_INSN_B, 20, 32, b },              \
+        { FSETP_INSN_SETP, 48, 4, FSETP_##compare } } }
+
+static struct test_variant const fsetp_variants[] =
+{
+    FSETP_VARIANT("FSETP.F",     F,   0x3f800000, 0xbf800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.LT 1",  LT,  0xbf800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LT 2",  LT,  0x3f800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.LT 3",  LT,  0xffffffff, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.LT 4",  LT,  0x3f800000, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.LT 5",  LT,  0xffffffff, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.EQ 1",  EQ,  0x3f800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.EQ 2",  EQ,  0x3f800000, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.EQ 3",  EQ,  0xffffffff, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.EQ 4",  EQ,  0xffffffff, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.EQ 5",  EQ,  0x3f800000, 0xbf800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.LE 1",  LE,  0x3f800000, 0xbf800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.LE 2",  LE,  0x3f800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LE 3",  LE,  0xbf800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LE 4",  LE,  0x3f800000, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.LE 5",  LE,  0xffffffff, 0xbf800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.GT 1",  GT,  0x3f800000, 0xbf800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GT 2",  GT,  0x3f800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.GT 3",  GT,  0xbf800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.GT 4",  GT,  0xffffffff, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.GT 5",  GT,  0xbf800000, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.NE 1",  NE,  0x3f800000, 0xbf800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.NE 2",  NE,  0x3f800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.NE 3",  NE,  0xffffffff, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.NE 4",  NE,  0x3f800000, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.GE 1",  GE,  0x3f800000, 0xbf800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GE 2",  GE,  0x3f800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GE 3",  GE,  0xbf800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.GE 4",  GE,  0xbf800000, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.GE 5",  GE,  0xffffffff, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.NUM 1", NUM, 0x3f800000, 0xbf800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.NUM 2", NUM, 0x3f800000, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.NUM 3", NUM, 0xffffffff, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.NUM 4", NUM, 0xffffffff, 0xffffffff, 0x0000dead),
+    FSETP_VARIANT("FSETP.NAN 1", NAN, 0x3f800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.NAN 2", NAN, 0xffffffff, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.NAN 3", NAN, 0xffffffff, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.NAN 4", NAN, 0xffffffff, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LTU 1", LTU, 0xbf800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LTU 2", LTU, 0x3f800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.LTU 3", LTU, 0xffffffff, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LTU 4", LTU, 0x3f800000, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LTU 5", LTU, 0xffffffff, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.EQU 1", EQU, 0x3f800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.EQU 2", EQU, 0x3f800000, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.EQU 3", EQU, 0xffffffff, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.EQU 4", EQU, 0xffffffff, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.EQU 5", EQU, 0x3f800000, 0xbf800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.LEU 1", LEU, 0x3f800000, 0xbf800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.LEU 2", LEU, 0x3f800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LEU 3", LEU, 0xbf800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LEU 4", LEU, 0x3f800000, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.LEU 5", LEU, 0xffffffff, 0xbf800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GTU 1", GTU, 0x3f800000, 0xbf800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GTU 2", GTU, 0x3f800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.GTU 3", GTU, 0xbf800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.GTU 4", GTU, 0xffffffff, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GTU 5", GTU, 0xbf800000, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.NEU 1", NEU, 0x3f800000, 0xbf800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.NEU 2", NEU, 0x3f800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.NEU 3", NEU, 0xffffffff, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.NEU 4", NEU, 0x3f800000, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GEU 1", GEU, 0x3f800000, 0xbf800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GEU 2", GEU, 0x3f800000, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GEU 3", GEU, 0xbf800000, 0x3f800000, 0x0000dead),
+    FSETP_VARIANT("FSETP.GEU 4", GEU, 0xbf800000, 0xffffffff, 0x0000cafe),
+    FSETP_VARIANT("FSETP.GEU 5", GEU, 0xffffffff, 0x3f800000, 0x0000cafe),
+    FSETP_VARIANT("FSETP.T",     T,   0x3f800000, 0xbf800000, 0x0000cafe),
+};
+
+DEFINE_VTEST(fsetp) = TEST_VARIANTS(fsetp_variants);
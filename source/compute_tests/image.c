@@ -1,4 +1,3 @@
-#include <assert.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -6,11 +5,11 @@
 
 #include <deko3d.h>
 
+#include "gpu_arena.h"
 #include "helper.h"
 
 struct descriptor_set
 {
-    DkMemBlock memblock;
     DkGpuAddr gpu_addr;
     DkImageDescriptor* descriptors;
 };
@@ -18,7 +17,6 @@ struct descriptor_set
 struct image
 {
     DkImage image;
-    DkMemBlock memblock;
     void* memory;
 };
 
@@ -28,22 +26,19 @@ struct test_image
     struct image* image;
 };
 
-static struct descriptor_set make_image_descriptor_set(DkDevice device, size_t num)
+static struct descriptor_set make_image_descriptor_set(
+    struct gpu_arena* arenas, size_t num)
 {
+    struct gpu_alloc const memory = gpu_arena_alloc(&arenas[BLOCK_NONE],
+        num * sizeof(DkImageDescriptor), DK_IMAGE_DESCRIPTOR_ALIGNMENT);
     struct descriptor_set obj;
-    obj.memblock = make_memory_block(device, num * sizeof(DkImageDescriptor),
-        DkMemBlockFlags_CpuUncached | DkMemBlockFlags_GpuCached);
-    obj.gpu_addr = dkMemBlockGetGpuAddr(obj.memblock);
-    obj.descriptors = dkMemBlockGetCpuAddr(obj.memblock);
+    obj.gpu_addr = memory.gpu_addr;
+    obj.descriptors = memory.cpu_addr;
     return obj;
 }
 
-static void destroy_descriptor_set(struct descriptor_set const* obj)
-{
-    dkMemBlockDestroy(obj->memblock);
-}
-
-static struct image* make_image(DkDevice device, DkImageDescriptor* descriptor,
+static struct image* make_image(DkDevice device, struct gpu_arena* arenas,
+    DkImageDescriptor* descriptor,
     DkImageType type, DkImageFormat format, uint32_t width, uint32_t height,
     uint32_t depth)
 {
@@ -59,15 +54,14 @@ static struct image* make_image(DkDevice device, DkImageDescriptor* descriptor,
     dkImageLayoutInitialize(&layout, &layout_maker);
 
     uint64_t size = dkImageLayoutGetSize(&layout);
-    assert(size < DK_MEMBLOCK_ALIGNMENT);
+    struct gpu_alloc const memory = gpu_arena_alloc(&arenas[BLOCK_IMAGE],
+        size, dkImageLayoutGetAlignment(&layout));
+    memset(memory.cpu_addr, 0, size);
 
     struct image* obj = malloc(sizeof *obj);
-    obj->memblock = make_memory_block(device, DK_MEMBLOCK_ALIGNMENT,
-        DkMemBlockFlags_CpuUncached | DkMemBlockFlags_GpuCached
-            | DkMemBlockFlags_ZeroFillInit | DkMemBlockFlags_Image);
-    obj->memory = dkMemBlockGetCpuAddr(obj->memblock);
+    obj->memory = memory.cpu_addr;
 
-    dkImageInitialize(&obj->image, &layout, obj->memblock, 0);
+    dkImageInitialize(&obj->image, &layout, memory.memblock, memory.offset);
 
     DkImageView image_view = {
         .pImage = &obj->image,
@@ -81,26 +75,20 @@ static struct image* make_image(DkDevice device, DkImageDescriptor* descriptor,
     return obj;
 }
 
-static void destroy_image(struct image* obj)
-{
-    dkMemBlockDestroy(obj->memblock);
-    free(obj);
-}
-
+// The memory goes back to the arenas after the test
 static void destroy_test_image(struct test_image test_image)
 {
-    destroy_descriptor_set(&test_image.set);
-    destroy_image(test_image.image);
+    free(test_image.image);
 }
 
 static struct test_image image_test(DkDevice device, DkQueue queue,
-    DkCmdBuf cmdbuf, uint32_t type, uint32_t format, uint32_t width,
-    uint32_t height, uint32_t depth,
+    DkCmdBuf cmdbuf, struct gpu_arena* arenas, uint32_t type,
+    uint32_t format, uint32_t width, uint32_t height, uint32_t depth,
     void (*image_writer)(struct image*, void const*), void const *userdata)
 {
-    struct descriptor_set set = make_image_descriptor_set(device, 1);
-    struct image *image = make_image(device, &set.descriptors[0], type,
-        format, width, height, depth);
+    struct descriptor_set set = make_image_descriptor_set(arenas, 1);
+    struct image *image = make_image(device, arenas, &set.descriptors[0],
+        type, format, width, height, depth);
 
     if (image_writer)
         image_writer(image, userdata);
@@ -117,12 +105,12 @@ static struct test_image image_test(DkDevice device, DkQueue queue,
 }
 
 static void simple_image_test(DkDevice device, DkQueue queue,
-    DkCmdBuf cmdbuf, uint32_t type, uint32_t format, uint32_t width,
-    uint32_t height, uint32_t depth,
+    DkCmdBuf cmdbuf, struct gpu_arena* arenas, uint32_t type,
+    uint32_t format, uint32_t width, uint32_t height, uint32_t depth,
     void (*image_writer)(struct image*, void const*), void const *userdata)
 {
-    destroy_test_image(image_test(device, queue, cmdbuf, type, format, width,
-        height, depth, image_writer, userdata));
+    destroy_test_image(image_test(device, queue, cmdbuf, arenas, type, format,
+        width, height, depth, image_writer, userdata));
 }
 
 static void write32(struct image* image, void const* userdata)
@@ -137,8 +125,8 @@ static void write64(struct image* image, void const* userdata)
 
 DEFINE_ETEST(sust_p_rgba)
 {
-    struct test_image image = image_test(device, queue, cmdbuf, DkImageType_2D,
-        DkImageFormat_R32_Float, 1, 1, 1, NULL, NULL);
+    struct test_image image = image_test(device, queue, cmdbuf, arenas,
+        DkImageType_2D, DkImageFormat_R32_Float, 1, 1, 1, NULL, NULL);
     memcpy(results, image.image->memory, sizeof(uint32_t));
     destroy_test_image(image);
 }
@@ -146,90 +134,90 @@ DEFINE_ETEST(sust_p_rgba)
 DEFINE_ETEST(suld_p_rgba)
 {
     float const data = 36.0f;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_R32_Float, 1, 1, 1, write32, &data);
 }
 
 DEFINE_ETEST(suld_d_32_r32f)
 {
     float const data = 75.0f;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_R32_Float, 1, 1, 1, write32, &data);
 }
 
 DEFINE_ETEST(suld_d_32_rgba8u)
 {
     uint32_t const data = 0x20406080;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA8_Unorm, 1, 1, 1, write32, &data);
 }
 
 DEFINE_ETEST(suld_d_32_bgra8u)
 {
     uint32_t const data = 0x21416181;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_BGRA8_Unorm, 1, 1, 1, write32, &data);
 }
 
 DEFINE_ETEST(suld_d_32_rgba8s)
 {
     uint32_t const data = 0x65fe12ff;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA8_Snorm, 1, 1, 1, write32, &data);
 }
 
 DEFINE_ETEST(suld_d_32_rgba8ui)
 {
     uint32_t const data = 0xdeadbeec;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA8_Uint, 1, 1, 1, write32, &data);
 }
 
 DEFINE_ETEST(suld_d_32_rgba8i)
 {
     uint32_t const data = 0x11a220ff;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA8_Sint, 1, 1, 1, write32, &data);
 }
 
 DEFINE_ETEST(suld_d_64_rg32f)
 {
     uint64_t const data = 0x013275ab32452ffcc;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RG32_Float, 1, 1, 1, write64, &data);
 }
 
 DEFINE_ETEST(suld_d_64_rgba16f)
 {
     uint64_t const data = 0x1111222233334444;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA16_Float, 1, 1, 1, write64, &data);
 }
 
 DEFINE_ETEST(suld_d_64_rgba16s)
 {
     uint64_t const data = 0x00ff1365a020b0c3;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA16_Snorm, 1, 1, 1, write64, &data);
 }
 
 DEFINE_ETEST(suld_d_64_rgba16u)
 {
     uint64_t const data = 0xa8943bc24389a234;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA16_Unorm, 1, 1, 1, write64, &data);
 }
 
 DEFINE_ETEST(suld_d_64_rgba16i)
 {
     uint64_t const data = 0xc235abe456630a13;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA16_Sint, 1, 1, 1, write64, &data);
 }
 
 DEFINE_ETEST(suld_d_64_rgba16ui)
 {
     uint64_t const data = 0x157c4deab9432573;
-    simple_image_test(device, queue, cmdbuf, DkImageType_2D,
+    simple_image_test(device, queue, cmdbuf, arenas, DkImageType_2D,
         DkImageFormat_RGBA16_Uint, 1, 1, 1, write64, &data);
 }
@@ -2,7 +2,7 @@
 #include <stdint.h>
 #include <string.h>
 
-#include "helper.h"
+#include "compute_checks.h"
 
 DEFINE_MTEST(shfl_idx)
 {
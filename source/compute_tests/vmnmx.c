@@ -0,0 +1,34 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "compute_checks.h"
+
+// vmnmx_sat.sass runs VMNMX.SAT R2, R2, R3, R4 at instruction 5
+#define VMNMX_INSN_VMNMX 5
+
+#define VMNMX_U32 0
+#define VMNMX_S32 1
+#define VMNMX_UD 0
+#define VMNMX_SD 1
+#define VMNMX_MN 0
+#define VMNMX_MX 1
+
+// dest is UD for an unsigned result and SD for a signed one
+#define VMNMX_SAT_VARIANT(name, dest, type_a, type_b, mx, expected)            \
+    { name, expected,                                                          \
+      { { VMNMX_INSN_VMNMX, 48, 2, VMNMX_##type_a | VMNMX_##type_b << 1 },     \
+        { VMNMX_INSN_VMNMX, 54, 1, VMNMX_##dest },                             \
+        { VMNMX_INSN_VMNMX, 56, 1, VMNMX_##mx } } }
+
+static struct test_variant const vmnmx_sat_variants[] =
+{
+    VMNMX_SAT_VARIANT("VMNMX.SAT 1",  UD, S32, S32, MN, 0x00000000),
+    VMNMX_SAT_VARIANT("VMNMX.SAT 2",  UD, S32, U32, MN, 0x00000000),
+    VMNMX_SAT_VARIANT("VMNMX.SAT 3",  UD, U32, S32, MN, 0x00000008),
+    VMNMX_SAT_VARIANT("VMNMX.SAT 4",  SD, U32, U32, MX, 0x7fffffff),
+    VMNMX_SAT_VARIANT("VMNMX.SAT 5",  SD, S32, U32, MN, 0x90000000),
+    VMNMX_SAT_VARIANT("VMNMX.SAT 6",  SD, U32, S32, MX, 0x7fffffff),
+    VMNMX_SAT_VARIANT("VMNMX.SAT 7",  SD, S32, S32, MN, 0x90000000),
+};
+
+DEFINE_VTEST(vmnmx_sat) = TEST_VARIANTS(vmnmx_sat_variants);
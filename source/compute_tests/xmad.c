@@ -0,0 +1,71 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "compute_checks.h"
+
+// xmad_rr.sass loads R0-R3 with MOV32I at instructions 2 to 5, then runs
+// XMAD R0, R1, R2, R3 at instruction 6
+#define XMAD_INSN_OPERANDS 2
+#define XMAD_INSN_XMAD 6
+
+enum xmad_mode
+{
+    XMAD_MODE_C, XMAD_MODE_CLO, XMAD_MODE_CHI, XMAD_MODE_CSFU, XMAD_MODE_CBCC,
+};
+
+// Each mode is checked against its own set of operands
+#define XMAD_OPERANDS_C    0xd31891d0, 0x9a321bc7, 0xc3892d41, 0xf0a4820a
+#define XMAD_OPERANDS_CLO  0xe3ca9e2a, 0xc421a254, 0xa080b474, 0xf3869a3b
+#define XMAD_OPERANDS_CHI  0xa523b764, 0x92be890f, 0xab53c342, 0xcefa9afa
+#define XMAD_OPERANDS_CSFU 0xe8cafe32, 0xf20ad3d2, 0xa038be0a, 0xbe93a033
+#define XMAD_OPERANDS_CBCC 0x9a78ab42, 0x81509abe, 0x8ab4fe20, 0xa32b8530
+
+#define XMAD_PATCHES(...) XMAD_PATCHES_(__VA_ARGS__)
+#define XMAD_PATCHES_(mode, psl, mrg, hi_a, hi_b, r0, r1, r2, r3)              \
+    { { XMAD_INSN_OPERANDS + 0, 20, 32, r0 },                                  \
+      { XMAD_INSN_OPERANDS + 1, 20, 32, r1 },                                  \
+      { XMAD_INSN_OPERANDS + 2, 20, 32, r2 },                                  \
+      { XMAD_INSN_OPERANDS + 3, 20, 32, r3 },                                  \
+      { XMAD_INSN_XMAD, 35, 3, (hi_b) | (psl) << 1 | (mrg) << 2 },             \
+      { XMAD_INSN_XMAD, 50, 4, (mode) | (hi_a) << 3 } }
+
+// hi_a and hi_b select the high half of R1 and R2
+#define XMAD_VARIANT(name, mode, psl, mrg, hi_a, hi_b, expected)               \
+    { name, expected, XMAD_PATCHES(XMAD_MODE_##mode, psl, mrg, hi_a, hi_b,     \
+      XMAD_OPERANDS_##mode) }
+
+static struct test_variant const xmad_rr_variants[] =
+{
+    XMAD_VARIANT("XMAD_RR.MRG UU00 CBCC",     CBCC, 0, 1, 0, 0, 0xfe2060f0),
+    XMAD_VARIANT("XMAD_RR.MRG UU00 CHI",      CHI,  0, 1, 0, 0, 0xc34291d8),
+    XMAD_VARIANT("XMAD_RR.MRG UU00 CLO",      CLO,  0, 1, 0, 0, 0xb474384b),
+    XMAD_VARIANT("XMAD_RR.MRG UU00 C",        C,    0, 1, 0, 0, 0x2d418a91),
+    XMAD_VARIANT("XMAD_RR.MRG UU00 CSFU",     CSFU, 0, 1, 0, 0, 0xbe0ac267),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU00 CBCC", CBCC, 1, 1, 0, 0, 0xfe208530),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU00 CHI",  CHI,  1, 1, 0, 0, 0xc342cefa),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU00 CLO",  CLO,  1, 1, 0, 0, 0xb4749a3b),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU00 C",    C,    1, 1, 0, 0, 0x2d41820a),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU00 CSFU", CSFU, 1, 1, 0, 0, 0xbe0aa033),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU01 CBCC", CBCC, 1, 1, 0, 1, 0xfe208530),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU01 CHI",  CHI,  1, 1, 0, 1, 0xc342cefa),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU01 CLO",  CLO,  1, 1, 0, 1, 0xb4749a3b),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU01 C",    C,    1, 1, 0, 1, 0x2d41820a),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU01 CSFU", CSFU, 1, 1, 0, 1, 0xbe0aa033),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU11 CBCC", CBCC, 1, 1, 1, 1, 0xfe208530),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU11 CHI",  CHI,  1, 1, 1, 1, 0xc342cefa),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU11 CLO",  CLO,  1, 1, 1, 1, 0xb4749a3b),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU11 C",    C,    1, 1, 1, 1, 0x2d41820a),
+    XMAD_VARIANT("XMAD_RR.PSL.MRG UU11 CSFU", CSFU, 1, 1, 1, 1, 0xbe0aa033),
+    XMAD_VARIANT("XMAD_RR.PSL UU00 CBCC",     CBCC, 1, 0, 0, 0, 0x7d0b8530),
+    XMAD_VARIANT("XMAD_RR.PSL UU00 CHI",      CHI,  1, 0, 0, 0, 0xc2decefa),
+    XMAD_VARIANT("XMAD_RR.PSL UU00 CLO",      CLO,  1, 0, 0, 0, 0x9e109a3b),
+    XMAD_VARIANT("XMAD_RR.PSL UU00 C",        C,    1, 0, 0, 0, 0xf92b820a),
+    XMAD_VARIANT("XMAD_RR.PSL UU00 CSFU",     CSFU, 1, 0, 0, 0, 0xe0c7a033),
+    XMAD_VARIANT("XMAD_RR UU00 CBCC",         CBCC, 0, 0, 0, 0, 0x3ae760f0),
+    XMAD_VARIANT("XMAD_RR UU00 CHI",          CHI,  0, 0, 0, 0, 0x688a91d8),
+    XMAD_VARIANT("XMAD_RR UU00 CLO",          CLO,  0, 0, 0, 0, 0x726d384b),
+    XMAD_VARIANT("XMAD_RR UU00 C",            C,    0, 0, 0, 0, 0xf58d8a91),
+    XMAD_VARIANT("XMAD_RR UU00 CSFU",         CSFU, 0, 0, 0, 0, 0x5bd1c267),
+};
+
+DEFINE_VTEST(xmad_rr) = TEST_VARIANTS(xmad_rr_variants);
@@ -1,9 +1,18 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "dksh_gen.h"
+#include "sass_analyze.h"
+
+// Bytes of scratch memory per reconvergence stack token
+#define CRS_ENTRY_SIZE 16
+// The CRS size every program had before it was derived. The entry size is
+// not checked on hardware yet, so the derived size only ever adds to this.
+#define MIN_CRS_SIZE 0x800
 
 struct dksh_header
 {
@@ -76,49 +85,147 @@ static size_t align8(size_t n)
     return (n + 0xF) & ~0xF;
 }
 
-size_t calculate_compute_dksh_size(size_t code_size)
+static size_t control_size(size_t num_programs)
+{
+    return align256(sizeof(struct dksh_header)
+        + num_programs * sizeof(struct dksh_program_header));
+}
+
+void dksh_builder_init(struct dksh_builder* builder)
+{
+    memset(builder, 0, sizeof(*builder));
+}
+
+void dksh_builder_destroy(struct dksh_builder* builder)
+{
+    free(builder->programs);
+    free(builder->code);
+    dksh_builder_init(builder);
+}
+
+static void* grow(void* array, size_t* capacity, size_t needed, size_t size)
+{
+    if (needed <= *capacity)
+        return array;
+    size_t new_capacity = *capacity ? *capacity : 16;
+    while (new_capacity < needed)
+        new_capacity *= 2;
+    array = realloc(array, new_capacity * size);
+    if (!array)
+    {
+        printf("Out of memory! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+    *capacity = new_capacity;
+    return array;
+}
+
+uint32_t dksh_builder_add_compute(struct dksh_builder* builder,
+    uint8_t const* code, size_t code_size, int block_dim_x, int block_dim_y,
+    int block_dim_z, int local_mem_size, int shared_mem_size)
+{
+    builder->programs = grow(builder->programs, &builder->programs_capacity,
+        builder->num_programs + 1, sizeof(*builder->programs));
+    // Entrypoints keep the 256 byte alignment a standalone DKSH's code has
+    size_t const entrypoint = align256(builder->code_size);
+    builder->code = grow(builder->code, &builder->code_capacity,
+        entrypoint + code_size, 1);
+
+    // Padding between programs stays zero
+    memset(builder->code + builder->code_size, 0,
+        entrypoint - builder->code_size);
+    memcpy(builder->code + entrypoint, code, code_size);
+    builder->code_size = entrypoint + code_size;
+
+    struct dksh_builder_program* program =
+        &builder->programs[builder->num_programs];
+    program->entrypoint = entrypoint;
+    program->code_size = code_size;
+    program->block_dims[0] = block_dim_x;
+    program->block_dims[1] = block_dim_y;
+    program->block_dims[2] = block_dim_z;
+    program->local_mem_size = local_mem_size;
+    program->shared_mem_size = shared_mem_size;
+    return builder->num_programs++;
+}
+
+uint8_t* dksh_builder_code(struct dksh_builder* builder, uint32_t program_id)
 {
-    size_t headers = sizeof(struct dksh_header) + sizeof(struct dksh_program_header);
-    return align256(headers) + code_size;
+    return builder->code + builder->programs[program_id].entrypoint;
+}
+
+size_t dksh_builder_size(struct dksh_builder const* builder)
+{
+    return control_size(builder->num_programs)
+        + align256(builder->code_size);
+}
+
+static void fill_compute_program(struct dksh_program_header* prog,
+    struct dksh_builder_program const* program, uint8_t const* code)
+{
+    struct sass_resources resources;
+    if (!sass_analyze(code, program->code_size, program->local_mem_size,
+            program->shared_mem_size, &resources))
+    {
+        printf("Out of memory! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int local_pos_sz = align8(resources.local_mem_size);
+    int local_neg_sz = 0;
+    int crs_sz = align8(resources.crs_depth * CRS_ENTRY_SIZE);
+    if (crs_sz < MIN_CRS_SIZE)
+        crs_sz = MIN_CRS_SIZE;
+
+    memset(prog, 0, sizeof(*prog));
+    prog->type = 5; // compute
+    prog->entrypoint = program->entrypoint;
+    prog->num_gprs = resources.num_gprs;
+    prog->constbuf1_off = 0;
+    prog->constbuf1_sz = 0;
+    prog->per_warp_scratch_sz = (local_pos_sz + local_neg_sz) * 32 + crs_sz;
+    for (int i = 0; i < 3; ++i)
+        prog->comp.block_dims[i] = program->block_dims[i];
+    prog->comp.shared_mem_sz = align256(resources.shared_mem_size);
+    prog->comp.local_pos_mem_sz = local_pos_sz;
+    prog->comp.local_neg_mem_sz = local_neg_sz;
+    prog->comp.crs_sz = crs_sz;
+    prog->comp.num_barriers = resources.num_barriers;
+    prog->reserved = 0;
 }
 
-void generate_compute_dksh(
-    uint8_t* dksh, size_t code_size, uint8_t const* code, int num_gprs,
-    int block_dim_x, int block_dim_y, int block_dim_z, int local_mem_size,
-    int shared_mem_size, int num_barriers)
+void dksh_builder_emit_code(struct dksh_builder const* builder, uint8_t* dksh)
 {
+    size_t const control_sz = control_size(builder->num_programs);
+    uint8_t* const code = dksh + control_sz;
+    memcpy(code, builder->code, builder->code_size);
+    memset(code + builder->code_size, 0,
+        align256(builder->code_size) - builder->code_size);
+
     struct dksh_header header;
     header.magic = 0x48534B44; // DKSH
     header.header_sz = sizeof(struct dksh_header);
-    header.control_sz = align256(sizeof(struct dksh_header) + sizeof(struct dksh_program_header));
-    header.code_sz = align256(code_size);
+    header.control_sz = control_sz;
+    header.code_sz = align256(builder->code_size);
     header.programs_off = sizeof(struct dksh_header);
-    header.num_programs = 1;
+    header.num_programs = builder->num_programs;
+    memcpy(dksh, &header, sizeof(header));
 
-    int local_pos_sz = align8(local_mem_size);
-    int local_neg_sz = 0;
-    int crs_sz = 0x800;
+    size_t const headers_end = sizeof(struct dksh_header)
+        + builder->num_programs * sizeof(struct dksh_program_header);
+    memset(dksh + headers_end, 0, control_sz - headers_end);
+}
+
+void dksh_builder_emit_program(
+    struct dksh_builder const* builder, uint8_t* dksh, uint32_t program_id)
+{
+    struct dksh_builder_program const* program =
+        &builder->programs[program_id];
+    uint8_t const* code =
+        dksh + control_size(builder->num_programs) + program->entrypoint;
 
     struct dksh_program_header prog;
-    prog.type = 5; // compute
-    prog.entrypoint = 0;
-    prog.num_gprs = num_gprs;
-    prog.constbuf1_off = 0;
-    prog.constbuf1_sz = 0;
-    prog.per_warp_scratch_sz = (local_pos_sz + local_neg_sz) * 32 + crs_sz;
-    prog.comp.block_dims[0] = block_dim_x;
-    prog.comp.block_dims[1] = block_dim_y;
-    prog.comp.block_dims[2] = block_dim_z;
-    prog.comp.shared_mem_sz = align256(shared_mem_size);
-    prog.comp.local_pos_mem_sz = local_pos_sz;
-    prog.comp.local_neg_mem_sz = local_neg_sz;
-    prog.comp.crs_sz = crs_sz;
-    prog.comp.num_barriers = num_barriers;
-    prog.reserved = 0;
-
-    size_t begin_size = sizeof(header) + sizeof(prog);
-    memcpy(dksh, &header, sizeof(header));
-    memcpy(dksh + sizeof(header), &prog, sizeof(prog));
-    memset(dksh + begin_size, 0, align256(begin_size) - begin_size);
-    memcpy(dksh + align256(begin_size), code, code_size);
+    fill_compute_program(&prog, program, code);
+    memcpy(dksh + sizeof(struct dksh_header) + program_id * sizeof(prog),
+        &prog, sizeof(prog));
 }
@@ -2,9 +2,48 @@
 #include <stddef.h>
 #include <stdint.h>
 
-size_t calculate_compute_dksh_size(size_t code_size);
+struct dksh_builder_program
+{
+    uint32_t entrypoint;
+    size_t code_size;
+    int block_dims[3];
+    int local_mem_size;
+    int shared_mem_size;
+};
 
-void generate_compute_dksh(
-    uint8_t* dksh, size_t code_size, uint8_t const* code, int num_gprs,
-    int block_dim_x, int block_dim_y, int block_dim_z, int local_mem_size,
-    int shared_mem_size, int num_barriers);
+// Accumulates compute programs into a single DKSH: one control section with
+// a header per program, followed by the programs' code packed together
+struct dksh_builder
+{
+    struct dksh_builder_program* programs;
+    size_t num_programs;
+    size_t programs_capacity;
+    uint8_t* code;
+    size_t code_size;
+    size_t code_capacity;
+};
+
+void dksh_builder_init(struct dksh_builder* builder);
+void dksh_builder_destroy(struct dksh_builder* builder);
+
+// Copies a program into the builder and returns its program id, the
+// programId to give to dkShaderMakerDefaults' maker. Registers, barriers,
+// memory and stack sizes are derived from the code when the DKSH is emitted.
+// The memory sizes given only bound accesses whose address is not known
+// statically.
+uint32_t dksh_builder_add_compute(struct dksh_builder* builder,
+    uint8_t const* code, size_t code_size, int block_dim_x, int block_dim_y,
+    int block_dim_z, int local_mem_size, int shared_mem_size);
+
+// The builder's copy of a program, which may be patched before emitting.
+// Valid until the next program is added.
+uint8_t* dksh_builder_code(struct dksh_builder* builder, uint32_t program_id);
+
+size_t dksh_builder_size(struct dksh_builder const* builder);
+
+// Writes the DKSH, dksh_builder_size bytes, in steps: the DKSH header and
+// code first, then each program's header, which is where the code is
+// analyzed
+void dksh_builder_emit_code(struct dksh_builder const* builder, uint8_t* dksh);
+void dksh_builder_emit_program(
+    struct dksh_builder const* builder, uint8_t* dksh, uint32_t program_id);
@@ -0,0 +1,732 @@
+#include "fp16.h"
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FP16_SIMD "sse2"
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FP16_SIMD "neon"
+#endif
+
+static uint32_t float_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static uint16_t overflow_value(bool negative, enum fp16_rounding rounding)
+{
+    bool to_infinity;
+    switch (rounding)
+    {
+    case FP16_RN:
+        to_infinity = true;
+        break;
+    case FP16_RM:
+        to_infinity = negative;
+        break;
+    case FP16_RP:
+        to_infinity = !negative;
+        break;
+    default:
+        to_infinity = false;
+        break;
+    }
+    return (negative ? 0x8000 : 0) | (to_infinity ? 0x7c00 : 0x7bff);
+}
+
+static bool round_up(bool negative, bool odd, uint64_t remainder,
+    uint64_t halfway, enum fp16_rounding rounding)
+{
+    switch (rounding)
+    {
+    case FP16_RN:
+        return remainder > halfway || (remainder == halfway && odd);
+    case FP16_RM:
+        return negative && remainder;
+    case FP16_RP:
+        return !negative && remainder;
+    default:
+        return false;
+    }
+}
+
+// Rounds significand * 2^(exponent - fraction_bits) to a half, where the
+// significand's leading bit is at most at fraction_bits
+static uint16_t round_to_half(bool negative, int exponent,
+    uint64_t significand, int fraction_bits, enum fp16_rounding rounding)
+{
+    if (exponent > 15)
+        return overflow_value(negative, rounding);
+
+    int shift = fraction_bits - 10;
+    if (exponent < -14)
+    {
+        shift += -14 - exponent;
+        exponent = -14;
+    }
+    if (shift > fraction_bits + 2)
+        shift = fraction_bits + 2;
+
+    uint64_t const truncated = significand >> shift;
+    uint64_t const remainder = significand & ((UINT64_C(1) << shift) - 1);
+    bool const increment = round_up(negative, truncated & 1, remainder,
+        UINT64_C(1) << (shift - 1), rounding);
+
+    // The implicit bit carries into the exponent, and rounding past the
+    // largest finite value carries into infinity
+    uint32_t const result = ((uint32_t)(exponent + 14) << 10)
+        + (uint32_t)truncated + increment;
+    return (negative ? 0x8000 : 0) | (uint16_t)result;
+}
+
+float fp16_to_float(uint16_t half)
+{
+    uint32_t const sign = (uint32_t)(half & 0x8000) << 16;
+    int exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+
+    if (exponent == 0x1f)
+        return bits_float(sign | (mantissa ? 0x7fc00000 : 0x7f800000));
+    if (exponent == 0)
+    {
+        if (mantissa == 0)
+            return bits_float(sign);
+        exponent = 1;
+        while (!(mantissa & 0x400))
+        {
+            mantissa <<= 1;
+            --exponent;
+        }
+        mantissa &= 0x3ff;
+    }
+    return bits_float(sign | (uint32_t)(exponent + 112) << 23
+        | mantissa << 13);
+}
+
+uint16_t fp16_from_float(float value, enum fp16_rounding rounding)
+{
+    uint32_t const bits = float_bits(value);
+    bool const negative = bits >> 31;
+    uint32_t const magnitude = bits & 0x7fffffff;
+    if (magnitude > 0x7f800000)
+        return FP16_NAN;
+    if (magnitude == 0x7f800000)
+        return (negative ? 0x8000 : 0) | 0x7c00;
+    if (magnitude == 0)
+        return negative ? 0x8000 : 0;
+
+    int const biased = (int)(magnitude >> 23);
+    uint32_t const mantissa = magnitude & 0x7fffff;
+    if (biased == 0)
+        return round_to_half(negative, -126, mantissa, 23, rounding);
+    return round_to_half(negative, biased - 127, mantissa | 0x800000, 23,
+        rounding);
+}
+
+uint16_t fp16_from_double(double value, enum fp16_rounding rounding)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bool const negative = bits >> 63;
+    uint64_t const magnitude = bits & ~(UINT64_C(1) << 63);
+    uint64_t const infinity = UINT64_C(0x7ff) << 52;
+    if (magnitude > infinity)
+        return FP16_NAN;
+    if (magnitude == infinity)
+        return (negative ? 0x8000 : 0) | 0x7c00;
+    if (magnitude == 0)
+        return negative ? 0x8000 : 0;
+
+    int const biased = (int)(magnitude >> 52);
+    uint64_t const mantissa = magnitude & ((UINT64_C(1) << 52) - 1);
+    if (biased == 0)
+        return round_to_half(negative, -1022, mantissa, 52, rounding);
+    return round_to_half(negative, biased - 1023,
+        mantissa | UINT64_C(1) << 52, 52, rounding);
+}
+
+uint32_t fp16_to_int(uint16_t half, enum fp16_rounding rounding, int width,
+    bool is_signed)
+{
+    int64_t const min = is_signed ? -(INT64_C(1) << (width - 1)) : 0;
+    int64_t const max = is_signed ? (INT64_C(1) << (width - 1)) - 1
+                                  : (INT64_C(1) << width) - 1;
+    bool const negative = half >> 15;
+    int const biased = (half >> 10) & 0x1f;
+    uint32_t const mantissa = half & 0x3ff;
+
+    if (biased == 0x1f)
+    {
+        if (mantissa)
+            return 0;
+        return (uint32_t)(negative ? min : max);
+    }
+
+    // |value| = significand * 2^(exponent - 10)
+    uint32_t const significand = biased ? mantissa | 0x400 : mantissa;
+    int const exponent = (biased ? biased : 1) - 15;
+    int64_t magnitude;
+    if (exponent >= 10)
+        magnitude = (int64_t)significand << (exponent - 10);
+    else
+    {
+        int const shift = 10 - exponent;
+        uint32_t const truncated = significand >> shift;
+        uint32_t const remainder = significand & ((1u << shift) - 1);
+        magnitude = truncated + round_up(negative, truncated & 1, remainder,
+            1u << (shift - 1), rounding);
+    }
+
+    int64_t const value = negative ? -magnitude : magnitude;
+    if (value < min)
+        return (uint32_t)min;
+    if (value > max)
+        return (uint32_t)max;
+    return (uint32_t)value;
+}
+
+static uint16_t modify_half(uint16_t half, bool abs, bool neg, bool ftz)
+{
+    if (abs)
+        half &= 0x7fff;
+    if (neg)
+        half ^= 0x8000;
+    if (ftz && (half & 0x7c00) == 0)
+        half &= 0x8000;
+    return half;
+}
+
+static uint32_t swizzle_bits(uint32_t value, enum fp16_swizzle swizzle)
+{
+    switch (swizzle)
+    {
+    case FP16_SWIZZLE_H1_H0:
+        return value;
+    case FP16_SWIZZLE_F32:
+        return fp16_from_float(bits_float(value), FP16_RN) * 0x10001u;
+    case FP16_SWIZZLE_H0_H0:
+        return (value & 0xffff) * 0x10001u;
+    default:
+        return (value >> 16) * 0x10001u;
+    }
+}
+
+void fp16x2_unpack(uint32_t value, enum fp16_swizzle swizzle, bool abs,
+    bool neg, bool ftz, float out[2])
+{
+    uint32_t const halves = swizzle_bits(value, swizzle);
+    out[0] = fp16_to_float(modify_half(halves & 0xffff, abs, neg, ftz));
+    out[1] = fp16_to_float(modify_half(halves >> 16, abs, neg, ftz));
+}
+
+// NaN saturates to zero, and so does -0
+static double saturate(double value)
+{
+    return value > 0.0 ? (value < 1.0 ? value : 1.0) : 0.0;
+}
+
+uint32_t fp16x2_execute(enum fp16x2_op op, struct fp16x2_mods const* mods,
+    uint32_t a, uint32_t b, uint32_t c, uint32_t old)
+{
+    float va[2], vb[2], vc[2] = {0.0f, 0.0f};
+    fp16x2_unpack(a, mods->swizzle_a, mods->abs_a, mods->neg_a, mods->ftz,
+        va);
+    fp16x2_unpack(b, mods->swizzle_b, mods->abs_b, mods->neg_b, mods->ftz,
+        vb);
+    if (op == FP16X2_FMA)
+    {
+        fp16x2_unpack(c, mods->swizzle_c, false, mods->neg_c, mods->ftz,
+            vc);
+    }
+
+    double results[2];
+    uint16_t halves[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        switch (op)
+        {
+        case FP16X2_ADD:
+            results[i] = (double)va[i] + vb[i];
+            break;
+        case FP16X2_MUL:
+            results[i] = (double)va[i] * vb[i];
+            break;
+        default:
+            results[i] = fma(va[i], vb[i], vc[i]);
+            break;
+        }
+        if (mods->sat)
+            results[i] = saturate(results[i]);
+        halves[i] = modify_half(fp16_from_double(results[i], FP16_RN), false,
+            false, mods->ftz);
+    }
+
+    switch (mods->merge)
+    {
+    case FP16_MERGE_H1_H0:
+        return halves[0] | ((uint32_t)halves[1] << 16);
+    case FP16_MERGE_F32:
+    {
+        uint32_t const bits = float_bits((float)results[0]);
+        if (mods->ftz && (bits & 0x7f800000) == 0)
+            return bits & 0x80000000;
+        return bits;
+    }
+    case FP16_MERGE_MRG_H0:
+        return (old & 0xffff0000) | halves[0];
+    default:
+        return (old & 0x0000ffff) | ((uint32_t)halves[1] << 16);
+    }
+}
+
+#if defined(__SSE2__)
+
+typedef __m128i vec_u32;
+typedef __m128 vec_f32;
+
+static inline vec_u32 vu_set(uint32_t value)
+{
+    return _mm_set1_epi32((int)value);
+}
+
+static inline vec_u32 vu_load(uint32_t const* p)
+{
+    return _mm_loadu_si128((__m128i const*)p);
+}
+
+static inline void vu_store(uint32_t* p, vec_u32 value)
+{
+    _mm_storeu_si128((__m128i*)p, value);
+}
+
+static inline vec_u32 vu_and(vec_u32 a, vec_u32 b)
+{
+    return _mm_and_si128(a, b);
+}
+
+static inline vec_u32 vu_or(vec_u32 a, vec_u32 b)
+{
+    return _mm_or_si128(a, b);
+}
+
+static inline vec_u32 vu_xor(vec_u32 a, vec_u32 b)
+{
+    return _mm_xor_si128(a, b);
+}
+
+static inline vec_u32 vu_add(vec_u32 a, vec_u32 b)
+{
+    return _mm_add_epi32(a, b);
+}
+
+static inline vec_u32 vu_sub(vec_u32 a, vec_u32 b)
+{
+    return _mm_sub_epi32(a, b);
+}
+
+static inline vec_u32 vu_shl(vec_u32 value, int count)
+{
+    return _mm_slli_epi32(value, count);
+}
+
+static inline vec_u32 vu_shr(vec_u32 value, int count)
+{
+    return _mm_srli_epi32(value, count);
+}
+
+// Operands are below 2^31 so the signed compares are enough
+static inline vec_u32 vu_eq(vec_u32 a, vec_u32 b)
+{
+    return _mm_cmpeq_epi32(a, b);
+}
+
+static inline vec_u32 vu_gt(vec_u32 a, vec_u32 b)
+{
+    return _mm_cmpgt_epi32(a, b);
+}
+
+static inline vec_u32 vu_select(vec_u32 mask, vec_u32 a, vec_u32 b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline vec_u32 vu_from_f32(vec_f32 value)
+{
+    return _mm_castps_si128(value);
+}
+
+static inline vec_f32 vf_from_u32(vec_u32 value)
+{
+    return _mm_castsi128_ps(value);
+}
+
+static inline vec_f32 vf_add(vec_f32 a, vec_f32 b)
+{
+    return _mm_add_ps(a, b);
+}
+
+static inline vec_f32 vf_sub(vec_f32 a, vec_f32 b)
+{
+    return _mm_sub_ps(a, b);
+}
+
+static inline vec_f32 vf_mul(vec_f32 a, vec_f32 b)
+{
+    return _mm_mul_ps(a, b);
+}
+
+// maxps returns its second operand for NaN and for equal zeros
+static inline vec_f32 vf_saturate(vec_f32 value)
+{
+    return _mm_min_ps(_mm_max_ps(value, _mm_setzero_ps()),
+        _mm_set1_ps(1.0f));
+}
+
+static inline vec_u32 vu_load_u16(uint16_t const* p)
+{
+    return _mm_unpacklo_epi16(_mm_loadl_epi64((__m128i const*)p),
+        _mm_setzero_si128());
+}
+
+static inline void vu_store_u16(uint16_t* p, vec_u32 value)
+{
+    value = _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+    _mm_storel_epi64((__m128i*)p, _mm_packs_epi32(value, value));
+}
+
+static inline vec_f32 vf_load(float const* p)
+{
+    return _mm_loadu_ps(p);
+}
+
+static inline void vf_store(float* p, vec_f32 value)
+{
+    _mm_storeu_ps(p, value);
+}
+
+// Halves are in the low 16 bits of each lane. The exponent is rebiased with
+// integer arithmetic, denormals are normalized by a float subtraction.
+static inline vec_f32 half_to_float4(vec_u32 halves)
+{
+    vec_u32 const sign = vu_shl(vu_and(halves, vu_set(0x8000)), 16);
+    vec_u32 const magnitude = vu_and(halves, vu_set(0x7fff));
+    vec_u32 const exponent_mask = vu_set(0x7c00 << 13);
+    vec_u32 bits = vu_shl(magnitude, 13);
+    vec_u32 const exponent = vu_and(bits, exponent_mask);
+    bits = vu_add(bits, vu_set((127 - 15) << 23));
+
+    vec_u32 const is_infnan = vu_eq(exponent, exponent_mask);
+    bits = vu_add(bits, vu_and(is_infnan, vu_set((128 - 16) << 23)));
+
+    vec_u32 const is_denorm = vu_eq(exponent, vu_set(0));
+    vec_u32 const normalized = vu_from_f32(vf_sub(
+        vf_from_u32(vu_add(bits, vu_set(1 << 23))),
+        vf_from_u32(vu_set(113 << 23))));
+    bits = vu_select(is_denorm, normalized, bits);
+
+    vec_u32 const is_nan = vu_gt(magnitude, vu_set(0x7c00));
+    bits = vu_select(is_nan, vu_set(0x7fc00000), bits);
+    return vf_from_u32(vu_or(bits, sign));
+}
+
+// Round to nearest even. Results below the half normal range are rounded
+// by the float addition of 0.5, which has the half denormal ulp.
+static inline vec_u32 float_to_half4(vec_f32 values)
+{
+    vec_u32 const bits = vu_from_f32(values);
+    vec_u32 const sign = vu_shr(vu_and(bits, vu_set(0x80000000)), 16);
+    vec_u32 const magnitude = vu_and(bits, vu_set(0x7fffffff));
+
+    vec_u32 const denorm_magic = vu_set(126 << 23);
+    vec_u32 const denorm_result = vu_sub(vu_from_f32(vf_add(
+        vf_from_u32(magnitude), vf_from_u32(denorm_magic))), denorm_magic);
+
+    vec_u32 const odd = vu_and(vu_shr(magnitude, 13), vu_set(1));
+    vec_u32 const normal_result = vu_shr(vu_add(vu_add(magnitude,
+        vu_set(0xfff - (112u << 23))), odd), 13);
+
+    vec_u32 result = vu_select(vu_gt(vu_set(113 << 23), magnitude),
+        denorm_result, normal_result);
+    vec_u32 const overflows = vu_gt(magnitude, vu_set((143 << 23) - 1));
+    result = vu_select(overflows, vu_set(0x7c00), result);
+    result = vu_or(result, sign);
+    vec_u32 const is_nan = vu_gt(magnitude, vu_set(0x7f800000));
+    return vu_select(is_nan, vu_set(FP16_NAN), result);
+}
+
+static inline vec_u32 flush_halves(vec_u32 value)
+{
+    vec_u32 const zero_exponent = _mm_cmpeq_epi16(
+        _mm_and_si128(value, _mm_set1_epi16(0x7c00)), _mm_setzero_si128());
+    return _mm_andnot_si128(
+        _mm_and_si128(zero_exponent, _mm_set1_epi16(0x7fff)), value);
+}
+
+#elif defined(FP16_SIMD)
+
+typedef uint32x4_t vec_u32;
+typedef float32x4_t vec_f32;
+
+static inline vec_u32 vu_set(uint32_t value)
+{
+    return vdupq_n_u32(value);
+}
+
+static inline vec_u32 vu_load(uint32_t const* p)
+{
+    return vld1q_u32(p);
+}
+
+static inline void vu_store(uint32_t* p, vec_u32 value)
+{
+    vst1q_u32(p, value);
+}
+
+static inline vec_u32 vu_and(vec_u32 a, vec_u32 b)
+{
+    return vandq_u32(a, b);
+}
+
+static inline vec_u32 vu_or(vec_u32 a, vec_u32 b)
+{
+    return vorrq_u32(a, b);
+}
+
+static inline vec_u32 vu_xor(vec_u32 a, vec_u32 b)
+{
+    return veorq_u32(a, b);
+}
+
+static inline vec_u32 vu_shl(vec_u32 value, int count)
+{
+    return vshlq_u32(value, vdupq_n_s32(count));
+}
+
+static inline vec_u32 vu_shr(vec_u32 value, int count)
+{
+    return vshlq_u32(value, vdupq_n_s32(-count));
+}
+
+static inline vec_u32 vu_gt(vec_u32 a, vec_u32 b)
+{
+    return vcgtq_u32(a, b);
+}
+
+static inline vec_u32 vu_select(vec_u32 mask, vec_u32 a, vec_u32 b)
+{
+    return vbslq_u32(mask, a, b);
+}
+
+static inline vec_f32 vf_add(vec_f32 a, vec_f32 b)
+{
+    return vaddq_f32(a, b);
+}
+
+static inline vec_f32 vf_mul(vec_f32 a, vec_f32 b)
+{
+    return vmulq_f32(a, b);
+}
+
+// maxnm/minnm return the number for NaN inputs and order -0 below +0
+static inline vec_f32 vf_saturate(vec_f32 value)
+{
+    return vminnmq_f32(vmaxnmq_f32(value, vdupq_n_f32(0.0f)),
+        vdupq_n_f32(1.0f));
+}
+
+static inline vec_u32 vu_load_u16(uint16_t const* p)
+{
+    return vmovl_u16(vld1_u16(p));
+}
+
+static inline void vu_store_u16(uint16_t* p, vec_u32 value)
+{
+    vst1_u16(p, vmovn_u32(value));
+}
+
+static inline vec_f32 vf_load(float const* p)
+{
+    return vld1q_f32(p);
+}
+
+static inline void vf_store(float* p, vec_f32 value)
+{
+    vst1q_f32(p, value);
+}
+
+// The FCVT conversions keep NaN payloads, the NaNs are replaced to match
+// the scalar results
+static inline vec_f32 half_to_float4(vec_u32 halves)
+{
+    vec_u32 const bits = vreinterpretq_u32_f32(
+        vcvt_f32_f16(vreinterpret_f16_u16(vmovn_u32(halves))));
+    vec_u32 const is_nan = vu_gt(vu_and(halves, vu_set(0x7fff)),
+        vu_set(0x7c00));
+    return vreinterpretq_f32_u32(vu_select(is_nan,
+        vu_or(vu_and(bits, vu_set(0x80000000)), vu_set(0x7fc00000)), bits));
+}
+
+static inline vec_u32 float_to_half4(vec_f32 values)
+{
+    vec_u32 const halves = vmovl_u16(
+        vreinterpret_u16_f16(vcvt_f16_f32(values)));
+    vec_u32 const is_nan = vmvnq_u32(vceqq_f32(values, values));
+    return vu_select(is_nan, vu_set(FP16_NAN), halves);
+}
+
+static inline vec_u32 flush_halves(vec_u32 value)
+{
+    uint16x8_t const halves = vreinterpretq_u16_u32(value);
+    uint16x8_t const zero_exponent =
+        vceqq_u16(vandq_u16(halves, vdupq_n_u16(0x7c00)), vdupq_n_u16(0));
+    return vreinterpretq_u32_u16(vbicq_u16(halves,
+        vandq_u16(zero_exponent, vdupq_n_u16(0x7fff))));
+}
+
+#endif
+
+#if defined(FP16_SIMD)
+
+static inline vec_u32 swizzle4(vec_u32 value, enum fp16_swizzle swizzle)
+{
+    switch (swizzle)
+    {
+    case FP16_SWIZZLE_H0_H0:
+        value = vu_and(value, vu_set(0xffff));
+        return vu_or(value, vu_shl(value, 16));
+    case FP16_SWIZZLE_H1_H1:
+        value = vu_shr(value, 16);
+        return vu_or(value, vu_shl(value, 16));
+    default:
+        return value;
+    }
+}
+
+static inline vec_u32 modify4(vec_u32 value, bool abs, bool neg, bool ftz)
+{
+    if (abs)
+        value = vu_and(value, vu_set(0x7fff7fff));
+    if (neg)
+        value = vu_xor(value, vu_set(0x80008000));
+    if (ftz)
+        value = flush_halves(value);
+    return value;
+}
+
+// Half operands have 11 bit significands, so a single float add or mul
+// followed by rounding to half gives the same result as the exact
+// operation rounded once
+static inline vec_u32 execute4(enum fp16x2_op op,
+    struct fp16x2_mods const* mods, vec_u32 a, vec_u32 b)
+{
+    a = modify4(swizzle4(a, mods->swizzle_a), mods->abs_a, mods->neg_a,
+        mods->ftz);
+    b = modify4(swizzle4(b, mods->swizzle_b), mods->abs_b, mods->neg_b,
+        mods->ftz);
+
+    vec_u32 const low_mask = vu_set(0xffff);
+    vec_f32 const a0 = half_to_float4(vu_and(a, low_mask));
+    vec_f32 const a1 = half_to_float4(vu_shr(a, 16));
+    vec_f32 const b0 = half_to_float4(vu_and(b, low_mask));
+    vec_f32 const b1 = half_to_float4(vu_shr(b, 16));
+    vec_f32 r0 = op == FP16X2_ADD ? vf_add(a0, b0) : vf_mul(a0, b0);
+    vec_f32 r1 = op == FP16X2_ADD ? vf_add(a1, b1) : vf_mul(a1, b1);
+    if (mods->sat)
+    {
+        r0 = vf_saturate(r0);
+        r1 = vf_saturate(r1);
+    }
+
+    vec_u32 result = vu_or(float_to_half4(r0),
+        vu_shl(float_to_half4(r1), 16));
+    if (mods->ftz)
+        result = flush_halves(result);
+    return result;
+}
+
+#endif
+
+void fp16_to_float_n(float* out, uint16_t const* in, size_t count)
+{
+    size_t i = 0;
+#if defined(FP16_SIMD)
+    for (; i + 4 <= count; i += 4)
+        vf_store(out + i, half_to_float4(vu_load_u16(in + i)));
+#endif
+    for (; i < count; ++i)
+        out[i] = fp16_to_float(in[i]);
+}
+
+void fp16_from_float_n(uint16_t* out, float const* in, size_t count,
+    enum fp16_rounding rounding)
+{
+    size_t i = 0;
+#if defined(FP16_SIMD)
+    if (rounding == FP16_RN)
+    {
+        for (; i + 4 <= count; i += 4)
+            vu_store_u16(out + i, float_to_half4(vf_load(in + i)));
+    }
+#endif
+    for (; i < count; ++i)
+        out[i] = fp16_from_float(in[i], rounding);
+}
+
+void fp16x2_execute_n(enum fp16x2_op op, struct fp16x2_mods const* mods,
+    uint32_t* out, uint32_t const* a, uint32_t const* b, uint32_t const* c,
+    uint32_t const* old, size_t count)
+{
+    size_t i = 0;
+#if defined(FP16_SIMD)
+    // FMA and the F32 swizzle and merge stay on the scalar path
+    bool const vectorized = op != FP16X2_FMA
+        && mods->swizzle_a != FP16_SWIZZLE_F32
+        && mods->swizzle_b != FP16_SWIZZLE_F32
+        && mods->merge != FP16_MERGE_F32;
+    if (vectorized)
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            vec_u32 result = execute4(op, mods, vu_load(a + i),
+                vu_load(b + i));
+            if (mods->merge == FP16_MERGE_MRG_H0)
+            {
+                result = vu_or(vu_and(result, vu_set(0xffff)),
+                    vu_and(vu_load(old + i), vu_set(0xffff0000)));
+            }
+            else if (mods->merge == FP16_MERGE_MRG_H1)
+            {
+                result = vu_or(vu_and(result, vu_set(0xffff0000)),
+                    vu_and(vu_load(old + i), vu_set(0xffff)));
+            }
+            vu_store(out + i, result);
+        }
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        out[i] = fp16x2_execute(op, mods, a[i], b[i], c ? c[i] : 0,
+            old ? old[i] : 0);
+    }
+}
+
+char const* fp16_simd_name(void)
+{
+#if defined(FP16_SIMD)
+    return FP16_SIMD;
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+// Bit-exact model of the Maxwell half precision conversions and the paired
+// HADD2/HMUL2/HFMA2 arithmetic. The scalar functions define the reference
+// behaviour, the _n variants process arrays and use SSE2 or NEON where the
+// operation allows it.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Result of every conversion that produces a NaN
+#define FP16_NAN 0x7fff
+
+// Same values as the .RN/.RM/.RP/.RZ instruction fields
+enum fp16_rounding
+{
+    FP16_RN,
+    FP16_RM,
+    FP16_RP,
+    FP16_RZ,
+};
+
+enum fp16_swizzle
+{
+    FP16_SWIZZLE_H1_H0,
+    FP16_SWIZZLE_F32,
+    FP16_SWIZZLE_H0_H0,
+    FP16_SWIZZLE_H1_H1,
+};
+
+enum fp16_merge
+{
+    FP16_MERGE_H1_H0,
+    FP16_MERGE_F32,
+    FP16_MERGE_MRG_H0,
+    FP16_MERGE_MRG_H1,
+};
+
+enum fp16x2_op
+{
+    FP16X2_ADD,
+    FP16X2_MUL,
+    FP16X2_FMA,
+};
+
+// Operand and result modifiers. Fields the instruction form doesn't encode
+// are left zero.
+struct fp16x2_mods
+{
+    enum fp16_swizzle swizzle_a, swizzle_b, swizzle_c;
+    bool abs_a, neg_a;
+    bool abs_b, neg_b;
+    bool neg_c;
+    bool sat;
+    bool ftz;
+    enum fp16_merge merge;
+};
+
+float fp16_to_float(uint16_t half);
+uint16_t fp16_from_float(float value, enum fp16_rounding rounding);
+uint16_t fp16_from_double(double value, enum fp16_rounding rounding);
+
+// F2I.F16, rounding is the F2I field (nearest even, floor, ceil, trunc)
+uint32_t fp16_to_int(uint16_t half, enum fp16_rounding rounding, int width,
+    bool is_signed);
+
+// Applies a swizzle, then abs/neg and the denorm flush, to both halves
+void fp16x2_unpack(uint32_t value, enum fp16_swizzle swizzle, bool abs,
+    bool neg, bool ftz, float out[2]);
+
+// old is the previous destination value, used by the MRG merges
+uint32_t fp16x2_execute(enum fp16x2_op op, struct fp16x2_mods const* mods,
+    uint32_t a, uint32_t b, uint32_t c, uint32_t old);
+
+void fp16_to_float_n(float* out, uint16_t const* in, size_t count);
+void fp16_from_float_n(uint16_t* out, float const* in, size_t count,
+    enum fp16_rounding rounding);
+
+// c is only read by FMA and old only by the MRG merges, either can be NULL
+// otherwise
+void fp16x2_execute_n(enum fp16x2_op op, struct fp16x2_mods const* mods,
+    uint32_t* out, uint32_t const* a, uint32_t const* b, uint32_t const* c,
+    uint32_t const* old, size_t count);
+
+// "sse2", "neon" or "scalar"
+char const* fp16_simd_name(void);
@@ -0,0 +1,394 @@
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <switch.h>
+
+#include "goldens.h"
+#include "helper.h"
+#include "name_table.h"
+#include "test_filter.h"
+
+static uint64_t hash_key(char const* suite, char const* test)
+{
+    return name_hash_append(name_hash(suite) ^ '\t', test);
+}
+
+// "hw<hardware type>-fw<major>.<minor>.<micro>", "unknown" when the services
+// can't tell
+static void read_config(char* config, size_t size)
+{
+    snprintf(config, size, "unknown");
+
+    u64 hardware_type;
+    if (R_FAILED(splInitialize()))
+        return;
+    Result const rc = splGetConfig(SplConfigItem_HardwareType, &hardware_type);
+    splExit();
+    if (R_FAILED(rc))
+        return;
+
+    SetSysFirmwareVersion version;
+    if (R_FAILED(setsysInitialize()))
+        return;
+    Result const version_rc = setsysGetFirmwareVersion(&version);
+    setsysExit();
+    if (R_FAILED(version_rc))
+        return;
+
+    snprintf(config, size, "hw%" PRIu64 "-fw%u.%u.%u", (uint64_t)hardware_type,
+        version.major, version.minor, version.micro);
+}
+
+void goldens_init(struct goldens* goldens, bool is_updating)
+{
+    memset(goldens, 0, sizeof(*goldens));
+    name_table_init(&goldens->table);
+    name_table_init(&goldens->new_table);
+    goldens->is_updating = is_updating;
+    read_config(goldens->config, sizeof(goldens->config));
+}
+
+void goldens_free(struct goldens* goldens)
+{
+    for (size_t i = 0; i < goldens->num_entries; ++i)
+        free(goldens->entries[i].observed_tiles);
+    for (size_t i = 0; i < goldens->num_new_results; ++i)
+        free(goldens->new_results[i].tiles);
+    free(goldens->text);
+    free(goldens->entries);
+    name_table_free(&goldens->table);
+    name_table_free(&goldens->new_table);
+    free(goldens->new_results);
+    memset(goldens, 0, sizeof(*goldens));
+}
+
+static char* read_file(char const* path)
+{
+    FILE* const file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    long const size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0)
+    {
+        fclose(file);
+        return NULL;
+    }
+
+    char* const text = checked_malloc(size + 1);
+    size_t const read = fread(text, 1, size, file);
+    fclose(file);
+    text[read] = '\0';
+    return text;
+}
+
+// Splits the next line off text in place, NULL at the end
+static char* next_line(char** text)
+{
+    char* const line = *text;
+    if (!*line)
+        return NULL;
+    char* const end = line + strcspn(line, "\n");
+    *text = *end ? end + 1 : end;
+    *end = '\0';
+    if (end > line && end[-1] == '\r')
+        end[-1] = '\0';
+    return line;
+}
+
+// Splits a line into up to max_fields tab separated, non empty fields
+static int split_fields(char* line, char** fields, int max_fields)
+{
+    int num_fields = 0;
+    while (num_fields < max_fields)
+    {
+        char* const field = line;
+        line += strcspn(line, "\t");
+        if (line == field)
+            return 0;
+        fields[num_fields++] = field;
+        if (!*line)
+            return num_fields;
+        *line++ = '\0';
+    }
+    return 0;
+}
+
+static bool parse_entry(char* line, struct golden_entry* entry)
+{
+    char* fields[5];
+    int const num_fields = split_fields(line, fields, 5);
+    if (num_fields < 4)
+        return false;
+
+    char* end;
+    entry->value = strtoull(fields[3], &end, 0);
+    if (*end)
+        return false;
+    entry->suite = fields[0];
+    entry->test = fields[1];
+    entry->config = fields[2];
+    entry->tiles = num_fields == 5 ? fields[4] : NULL;
+    return true;
+}
+
+// Adds the entry, numbered after those added before it so the first match of
+// a probe is the first entry of the file. False when an entry has the same
+// test and configuration already.
+static bool add_entry(struct name_table* table,
+    struct golden_entry const* entries, size_t index)
+{
+    struct golden_entry const* const entry = &entries[index];
+    uint64_t const key = hash_key(entry->suite, entry->test);
+    struct name_probe probe = name_table_probe(table, key);
+    size_t other;
+    while (name_table_next(table, &probe, &other))
+    {
+        if (0 == strcmp(entries[other].test, entry->test)
+            && 0 == strcmp(entries[other].suite, entry->suite)
+            && 0 == strcmp(entries[other].config, entry->config))
+            return false;
+    }
+    name_table_add(table, key);
+    return true;
+}
+
+bool goldens_load(struct goldens* goldens, char const* path)
+{
+    char* const text = read_file(path);
+    if (!text)
+    {
+        printf("Failed to read \"%s\"\n", path);
+        return false;
+    }
+
+    // Every entry takes a line
+    size_t capacity = 1;
+    for (char const* c = text; *c; ++c)
+        capacity += *c == '\n';
+    struct golden_entry* const entries =
+        checked_malloc(capacity * sizeof(*entries));
+    memset(entries, 0, capacity * sizeof(*entries));
+
+    char* rest = text;
+    char* line = next_line(&rest);
+    unsigned version = 0;
+    if (!line || 1 != sscanf(line, "goldens %u", &version)
+        || version != GOLDENS_VERSION)
+    {
+        printf("%s: expected \"goldens %d\" on the first line\n", path,
+            GOLDENS_VERSION);
+        free(entries);
+        free(text);
+        return false;
+    }
+
+    struct name_table table;
+    name_table_init(&table);
+    size_t num_entries = 0;
+    for (int line_number = 2; (line = next_line(&rest)); ++line_number)
+    {
+        if (!*line || *line == '#')
+            continue;
+        if (!parse_entry(line, &entries[num_entries]))
+        {
+            printf("%s:%d: expected suite, test, configuration, value and "
+                "optionally tiles separated by tabs\n", path, line_number);
+        }
+        else if (!add_entry(&table, entries, num_entries))
+        {
+            printf("%s:%d: \"%s\" has an entry for \"%s\" already\n",
+                path, line_number, entries[num_entries].test,
+                entries[num_entries].config);
+        }
+        else
+        {
+            ++num_entries;
+            continue;
+        }
+        name_table_free(&table);
+        free(entries);
+        free(text);
+        return false;
+    }
+
+    free(goldens->text);
+    free(goldens->entries);
+    name_table_free(&goldens->table);
+    goldens->text = text;
+    goldens->entries = entries;
+    goldens->num_entries = num_entries;
+    goldens->table = table;
+    return true;
+}
+
+static struct golden_entry* find_entry(struct goldens const* goldens,
+    char const* suite, char const* test)
+{
+    if (!goldens || goldens->num_entries == 0)
+        return NULL;
+
+    struct name_probe probe =
+        name_table_probe(&goldens->table, hash_key(suite, test));
+    size_t index;
+    while (name_table_next(&goldens->table, &probe, &index))
+    {
+        struct golden_entry* const entry = &goldens->entries[index];
+        if (0 == strcmp(entry->test, test)
+            && 0 == strcmp(entry->suite, suite)
+            && glob_match(entry->config, goldens->config))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+struct golden_entry const* goldens_find(struct goldens const* goldens,
+    char const* suite, char const* test)
+{
+    return find_entry(goldens, suite, test);
+}
+
+uint64_t goldens_expected(struct goldens const* goldens, char const* suite,
+    char const* test, uint64_t builtin)
+{
+    struct golden_entry const* const entry = find_entry(goldens, suite, test);
+    return entry ? entry->value : builtin;
+}
+
+static char* copy_tiles(char const* tiles)
+{
+    if (!tiles)
+        return NULL;
+    size_t const size = strlen(tiles) + 1;
+    char* const copy = checked_malloc(size);
+    memcpy(copy, tiles, size);
+    return copy;
+}
+
+void goldens_record(struct goldens* goldens, char const* suite,
+    char const* test, uint64_t value, char const* tiles)
+{
+    if (!goldens || !goldens->is_updating)
+        return;
+
+    struct golden_entry* const entry = find_entry(goldens, suite, test);
+    bool is_recorded = entry && entry->is_observed;
+    uint64_t const key = hash_key(suite, test);
+    struct name_probe probe = name_table_probe(&goldens->new_table, key);
+    size_t index;
+    while (!entry && !is_recorded
+        && name_table_next(&goldens->new_table, &probe, &index))
+    {
+        is_recorded = 0 == strcmp(goldens->new_results[index].test, test)
+            && 0 == strcmp(goldens->new_results[index].suite, suite);
+    }
+    // Two tests of the same name would write the same key
+    if (is_recorded)
+    {
+        printf("\"%s\" recorded twice for the goldens! Aborting...\n", test);
+        exit(EXIT_FAILURE);
+    }
+
+    if (entry)
+    {
+        entry->observed = value;
+        free(entry->observed_tiles);
+        entry->observed_tiles = copy_tiles(tiles);
+        entry->is_observed = true;
+        return;
+    }
+
+    if (goldens->num_new_results == goldens->new_results_capacity)
+    {
+        size_t const capacity = goldens->new_results_capacity
+            ? goldens->new_results_capacity * 2 : 256;
+        struct golden_result* const results = checked_malloc(
+            capacity * sizeof(*results));
+        if (goldens->num_new_results)
+        {
+            memcpy(results, goldens->new_results,
+                goldens->num_new_results * sizeof(*results));
+        }
+        free(goldens->new_results);
+        goldens->new_results = results;
+        goldens->new_results_capacity = capacity;
+    }
+    name_table_add(&goldens->new_table, key);
+    goldens->new_results[goldens->num_new_results++] =
+        (struct golden_result){suite, test, value, copy_tiles(tiles)};
+}
+
+// True when the test has entries, none for this configuration
+static bool has_other_configs(struct goldens const* goldens,
+    char const* suite, char const* test)
+{
+    if (goldens->num_entries == 0)
+        return false;
+
+    struct name_probe probe =
+        name_table_probe(&goldens->table, hash_key(suite, test));
+    size_t index;
+    while (name_table_next(&goldens->table, &probe, &index))
+    {
+        struct golden_entry const* const entry = &goldens->entries[index];
+        if (0 == strcmp(entry->test, test)
+            && 0 == strcmp(entry->suite, suite))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void write_entry(FILE* file, char const* suite, char const* test,
+    char const* config, uint64_t value, char const* tiles)
+{
+    fprintf(file, "%s\t%s\t%s\t0x%" PRIx64, suite, test, config, value);
+    if (tiles)
+        fprintf(file, "\t%s", tiles);
+    fputc('\n', file);
+}
+
+bool goldens_write(struct goldens const* goldens, char const* path)
+{
+    FILE* const file = fopen(path, "w");
+    if (!file)
+    {
+        printf("Failed to open \"%s\", goldens are not saved\n", path);
+        return false;
+    }
+
+    fprintf(file, "goldens %d\n", GOLDENS_VERSION);
+    fprintf(file, "# suite\ttest\tconfiguration\tvalue\ttiles\n");
+    for (size_t i = 0; i < goldens->num_entries; ++i)
+    {
+        struct golden_entry const* const entry = &goldens->entries[i];
+        write_entry(file, entry->suite, entry->test, entry->config,
+            entry->is_observed ? entry->observed : entry->value,
+            entry->is_observed ? entry->observed_tiles : entry->tiles);
+    }
+
+    // Tests with entries for other consoles only get one for this console
+    for (size_t i = 0; i < goldens->num_new_results; ++i)
+    {
+        struct golden_result const* const result = &goldens->new_results[i];
+        char const* const config =
+            has_other_configs(goldens, result->suite, result->test)
+            ? goldens->config : "*";
+        write_entry(file, result->suite, result->test, config, result->value,
+            result->tiles);
+    }
+
+    bool const ok = !ferror(file);
+    if (fclose(file) != 0 || !ok)
+    {
+        printf("Failed to write \"%s\"\n", path);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "name_table.h"
+
+#define GOLDENS_VERSION 1
+
+// Expected values loaded from a golden file, overriding the ones built into
+// the test tables. The file is text, a version line followed by one entry per
+// line, fields separated by single tabs since test names have spaces:
+//
+//   goldens 1
+//   # suite<TAB>test<TAB>configuration<TAB>value
+//   compute<TAB>SHR_R.U32 Clamped<TAB>*<TAB>0xffffffff
+//   graphics<TAB>clear<TAB>hw1-fw*<TAB>0x1ba7e0d5288098cc<TAB>tile hashes
+//
+// Graphics entries may end with the hashes of the render target's tiles, see
+// tile_hash.h, to tell which parts of the image changed.
+//
+// A test may have several entries. The configuration is a glob matched
+// against "hw<hardware type>-fw<major>.<minor>.<micro>" of the console
+// running the tests, the first matching entry in file order is used.
+struct golden_entry
+{
+    char const* suite;
+    char const* test;
+    char const* config;
+    uint64_t value;
+    // Hex digits of the tile hashes, NULL without
+    char const* tiles;
+    // What the run got, when updating
+    uint64_t observed;
+    char* observed_tiles;
+    bool is_observed;
+};
+
+struct golden_result
+{
+    char const* suite;
+    char const* test;
+    uint64_t value;
+    char* tiles;
+};
+
+struct goldens
+{
+    // Loaded file, the entries' strings point into it
+    char* text;
+    struct golden_entry* entries;
+    size_t num_entries;
+    // Entry indices by suite and test name
+    struct name_table table;
+    char config[32];
+
+    // Values seen by the run for tests without a selected entry, when
+    // updating. The names are kept, not copied.
+    bool is_updating;
+    struct golden_result* new_results;
+    struct name_table new_table;
+    size_t num_new_results;
+    size_t new_results_capacity;
+};
+
+void goldens_init(struct goldens* goldens, bool is_updating);
+void goldens_free(struct goldens* goldens);
+
+// Prints what is wrong with the file and returns false when it can't be used,
+// a test listed twice for one configuration included
+bool goldens_load(struct goldens* goldens, char const* path);
+
+// The selected entry, NULL when there is none
+struct golden_entry const* goldens_find(struct goldens const* goldens,
+    char const* suite, char const* test);
+
+// The value of the selected entry, builtin when there is none
+uint64_t goldens_expected(struct goldens const* goldens, char const* suite,
+    char const* test, uint64_t builtin);
+
+// Notes the value a test got, and its tile hashes which may be NULL, for
+// goldens_write. No-op unless updating, aborts when the test was recorded
+// already.
+void goldens_record(struct goldens* goldens, char const* suite,
+    char const* test, uint64_t value, char const* tiles);
+
+// Writes the loaded entries, with the values recorded for the selected ones,
+// and an entry for every other recorded test
+bool goldens_write(struct goldens const* goldens, char const* path);
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deko3d.h>
+
+#include "gpu_arena.h"
+#include "helper.h"
+
+static uint32_t block_flags(int type)
+{
+    uint32_t const generic =
+        DkMemBlockFlags_CpuUncached | DkMemBlockFlags_GpuCached;
+
+    switch (type)
+    {
+    case BLOCK_NONE:
+        return generic;
+    case BLOCK_IMAGE:
+        return generic | DkMemBlockFlags_Image;
+    case BLOCK_CODE:
+        return generic | DkMemBlockFlags_Code;
+    default:
+        printf("invalid type %d\n", type);
+        return generic;
+    }
+}
+
+// The end of a code memblock can't hold code the GPU runs
+static size_t usable_size(struct gpu_arena const* arena, DkMemBlock memblock)
+{
+    size_t const size = dkMemBlockGetSize(memblock);
+    return arena->type == BLOCK_CODE ? size - DK_SHADER_CODE_UNUSABLE_SIZE
+                                     : size;
+}
+
+static size_t align_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void gpu_arena_init(
+    struct gpu_arena* arena, DkDevice device, int type, size_t block_size)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->device = device;
+    arena->type = type;
+    arena->block_size = block_size;
+}
+
+void gpu_arena_destroy(struct gpu_arena* arena)
+{
+    for (size_t i = 0; i < arena->num_memblocks; ++i)
+        dkMemBlockDestroy(arena->memblocks[i]);
+    free(arena->memblocks);
+    memset(arena, 0, sizeof(*arena));
+}
+
+static void add_memblock(struct gpu_arena* arena, size_t size)
+{
+    if (arena->num_memblocks == arena->capacity)
+    {
+        size_t const capacity = arena->capacity ? arena->capacity * 2 : 4;
+        DkMemBlock* const memblocks =
+            checked_malloc(capacity * sizeof(*memblocks));
+        if (arena->num_memblocks)
+        {
+            memcpy(memblocks, arena->memblocks,
+                arena->num_memblocks * sizeof(*memblocks));
+        }
+        free(arena->memblocks);
+        arena->memblocks = memblocks;
+        arena->capacity = capacity;
+    }
+
+    if (arena->type == BLOCK_CODE)
+        size += DK_SHADER_CODE_UNUSABLE_SIZE;
+    if (size < arena->block_size)
+        size = arena->block_size;
+    arena->memblocks[arena->num_memblocks++] =
+        make_memory_block(arena->device, size, block_flags(arena->type));
+}
+
+struct gpu_alloc gpu_arena_alloc(
+    struct gpu_arena* arena, size_t size, size_t alignment)
+{
+    // Memblocks that are too small for it are skipped until the next reset,
+    // one of the right size is made when none is left
+    while (arena->current < arena->num_memblocks)
+    {
+        DkMemBlock const memblock = arena->memblocks[arena->current];
+        // Memblocks are only DK_MEMBLOCK_ALIGNMENT aligned, it's the GPU
+        // address that needs the alignment
+        DkGpuAddr const base = dkMemBlockGetGpuAddr(memblock);
+        size_t const offset = align_up(base + arena->offset, alignment) - base;
+        if (offset + size <= usable_size(arena, memblock))
+        {
+            arena->offset = offset + size;
+            return (struct gpu_alloc){
+                .memblock = memblock,
+                .offset = (uint32_t)offset,
+                .size = (uint32_t)size,
+                .cpu_addr = (uint8_t*)dkMemBlockGetCpuAddr(memblock) + offset,
+                .gpu_addr = base + offset,
+            };
+        }
+        ++arena->current;
+        arena->offset = 0;
+    }
+
+    add_memblock(arena, size + (alignment > DK_MEMBLOCK_ALIGNMENT
+        ? alignment - DK_MEMBLOCK_ALIGNMENT : 0));
+    return gpu_arena_alloc(arena, size, alignment);
+}
+
+void gpu_arena_reset(struct gpu_arena* arena)
+{
+    arena->current = 0;
+    arena->offset = 0;
+}
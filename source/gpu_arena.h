@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deko3d.h>
+
+// What memory is for, which decides its memblock flags
+#define BLOCK_NONE 0
+#define BLOCK_IMAGE 1
+#define BLOCK_CODE 2
+#define NUM_BLOCK_TYPES 3
+
+// A range of one of an arena's memblocks
+struct gpu_alloc
+{
+    DkMemBlock memblock;
+    uint32_t offset;
+    uint32_t size;
+    void* cpu_addr;
+    DkGpuAddr gpu_addr;
+};
+
+// Hands out ranges of a few large memblocks of one type, kept until the arena
+// is destroyed. Allocations are carved in order and all freed at once by
+// gpu_arena_reset, so the memblocks are only created when a run first needs
+// that much memory.
+struct gpu_arena
+{
+    DkDevice device;
+    int type;
+    // Size of new memblocks, larger allocations get one their size
+    size_t block_size;
+    DkMemBlock* memblocks;
+    size_t num_memblocks;
+    size_t capacity;
+    // Memblock being carved and where its free space starts
+    size_t current;
+    size_t offset;
+};
+
+void gpu_arena_init(
+    struct gpu_arena* arena, DkDevice device, int type, size_t block_size);
+void gpu_arena_destroy(struct gpu_arena* arena);
+
+// size bytes at a multiple of alignment, a power of two. The contents are
+// whatever the last user left.
+struct gpu_alloc gpu_arena_alloc(
+    struct gpu_arena* arena, size_t size, size_t alignment);
+
+// Frees every allocation, the GPU must be done with them. Work using the
+// memory again should start with a barrier invalidating
+// ARENA_INVALIDATE_FLAGS, the GPU may have cached what it held before.
+void gpu_arena_reset(struct gpu_arena* arena);
+
+#define ARENA_INVALIDATE_FLAGS                                            \
+    (DkInvalidateFlags_Image | DkInvalidateFlags_Code                    \
+        | DkInvalidateFlags_Pool | DkInvalidateFlags_L2Cache)
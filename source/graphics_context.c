@@ -5,63 +5,150 @@
 
 #include <deko3d.h>
 
+#include "cmd_trace.h"
 #include "graphics_context.h"
 #include "helper.h"
 
-static int blk_flags(int type)
+// Memblocks the arenas start with, enough for most tests
+static size_t const arena_block_sizes[NUM_BLOCK_TYPES] = {
+    [BLOCK_NONE] = 0x40000,
+    [BLOCK_IMAGE] = 0x100000,
+    [BLOCK_CODE] = 0x40000,
+};
+
+void init_context(struct gfx_context* ctx, DkDevice device, DkQueue queue,
+    struct shader_pack const* pack, struct shader_cache* shader_cache)
 {
-    int const generic = DkMemBlockFlags_CpuUncached | DkMemBlockFlags_GpuCached;
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->device = device;
+    ctx->queue = queue;
+    ctx->pack = pack;
+    ctx->shader_cache = shader_cache;
+    for (int i = 0; i < NUM_BLOCK_TYPES; ++i)
+        gpu_arena_init(&ctx->arenas[i], device, i, arena_block_sizes[i]);
+    cmdbuf_ring_init(&ctx->cmdbuf_ring, device);
+}
 
-    switch (type)
-    {
-    case BLOCK_NONE:
-        return generic;
-    case BLOCK_IMAGE:
-        return generic | DkMemBlockFlags_Image;
-    case BLOCK_CODE:
-        return generic | DkMemBlockFlags_Code;
-    default:
-        printf("invalid type %d\n", type);
-        return generic;
-    }
+void destroy_context(struct gfx_context* ctx)
+{
+    cmdbuf_ring_wait(&ctx->cmdbuf_ring);
+    reset_context(ctx);
+    for (int i = 0; i < NUM_BLOCK_TYPES; ++i)
+        gpu_arena_destroy(&ctx->arenas[i]);
+    cmdbuf_ring_destroy(&ctx->cmdbuf_ring);
+    free(ctx->allocs);
+    free(ctx->alloc_infos);
 }
 
 void reset_context(struct gfx_context* ctx)
 {
-    for (size_t i = 0; i < ctx->num_memblocks; ++i)
-        dkMemBlockDestroy(ctx->memblocks[i]);
-    ctx->num_memblocks = 0;
+    for (int i = 0; i < NUM_BLOCK_TYPES; ++i)
+        gpu_arena_reset(&ctx->arenas[i]);
+    ctx->num_allocs = 0;
 
-    for (size_t i = 0; i < ctx->num_cmdbufs; ++i)
-        dkCmdBufDestroy(ctx->cmdbufs[i]);
+    cmdbuf_ring_release(&ctx->cmdbuf_ring);
     ctx->num_cmdbufs = 0;
+
+    ctx->num_shaders = 0;
+}
+
+static void grow_allocs(struct gfx_context* ctx)
+{
+    size_t const capacity =
+        ctx->allocs_capacity ? ctx->allocs_capacity * 2 : 64;
+    struct gpu_alloc* const allocs = checked_malloc(capacity * sizeof(*allocs));
+    struct alloc_info* const infos = checked_malloc(capacity * sizeof(*infos));
+    if (ctx->num_allocs)
+    {
+        memcpy(allocs, ctx->allocs, ctx->num_allocs * sizeof(*allocs));
+        memcpy(infos, ctx->alloc_infos, ctx->num_allocs * sizeof(*infos));
+    }
+    free(ctx->allocs);
+    free(ctx->alloc_infos);
+    ctx->allocs = allocs;
+    ctx->alloc_infos = infos;
+    ctx->allocs_capacity = capacity;
 }
 
-DkMemBlock make_memblock(struct gfx_context* ctx, size_t size, int type)
+// Memory owned by another resource, traced along with it. Allocations keep
+// the size a memblock of their own had, so results hash and traces replay
+// the same.
+static struct gpu_alloc alloc_memory(
+    struct gfx_context* ctx, size_t size, size_t alignment, int type)
 {
-    DkMemBlock memblock = make_memory_block(ctx->device, size, blk_flags(type));
-    size_t real_size = (size_t)dkMemBlockGetSize(memblock);
-    void* data = dkMemBlockGetCpuAddr(memblock);
-    memset(data, 0xcc, real_size);
+    size_t const real_size = (size + DK_MEMBLOCK_ALIGNMENT - 1)
+        & ~(size_t)(DK_MEMBLOCK_ALIGNMENT - 1);
+    struct gpu_alloc const alloc =
+        gpu_arena_alloc(&ctx->arenas[type], real_size, alignment);
+    memset(alloc.cpu_addr, 0xcc, real_size);
 
-    ctx->memblocks[ctx->num_memblocks++] = memblock;
-    return memblock;
+    if (ctx->num_allocs == ctx->allocs_capacity)
+        grow_allocs(ctx);
+    ctx->allocs[ctx->num_allocs] = alloc;
+    ctx->alloc_infos[ctx->num_allocs++] = (struct alloc_info){.size = size};
+    return alloc;
 }
 
-DkCmdBuf make_cmdbuf(struct gfx_context* ctx, size_t size)
+struct gpu_alloc make_memory(struct gfx_context* ctx, size_t size, int type)
 {
-    DkCmdBufMaker cmdbuf_mk;
-    dkCmdBufMakerDefaults(&cmdbuf_mk, ctx->device);
-    DkCmdBuf const cmdbuf = dkCmdBufCreate(&cmdbuf_mk);
-    dkCmdBufAddMemory(cmdbuf, make_memblock(ctx, size, BLOCK_NONE), 0, size);
+    struct gpu_alloc const alloc =
+        alloc_memory(ctx, size, DK_MEMBLOCK_ALIGNMENT, type);
+    cmd_trace_memblock(ctx, size, type);
+    return alloc;
+}
+
+struct alloc_info alloc_info(
+    struct gfx_context const* ctx, struct gpu_alloc const* alloc)
+{
+    for (size_t i = 0; i < ctx->num_allocs; ++i)
+    {
+        if (ctx->allocs[i].gpu_addr == alloc->gpu_addr)
+            return ctx->alloc_infos[i];
+    }
+    return (struct alloc_info){.size = alloc->size};
+}
+
+DkCmdBuf make_cmdbuf(struct gfx_context* ctx)
+{
+    DkCmdBuf const cmdbuf = cmdbuf_ring_acquire(&ctx->cmdbuf_ring);
+    // The arenas hand out memory earlier tests used, the GPU may still have
+    // it cached
+    dkCmdBufBarrier(cmdbuf, DkBarrier_None, ARENA_INVALIDATE_FLAGS);
+    gpu_timer_begin(ctx->timer, cmdbuf, ctx->test_index);
 
     ctx->cmdbufs[ctx->num_cmdbufs++] = cmdbuf;
+    cmd_trace_cmdbuf(ctx);
     return cmdbuf;
 }
 
+void submit_commands(struct gfx_context* ctx, DkCmdBuf cmdbuf)
+{
+    cmd_trace_submit(ctx, cmdbuf);
+    gpu_timer_end(ctx->timer, cmdbuf, ctx->test_index);
+    DkCmdList const list = dkCmdBufFinishList(cmdbuf);
+    timing_lap(ctx->timing, PHASE_RECORD, &ctx->clock);
+
+    dkQueueSubmitCommands(ctx->queue, list);
+    cmdbuf_ring_signal(&ctx->cmdbuf_ring, ctx->queue, cmdbuf);
+    timing_lap(ctx->timing, PHASE_SUBMIT, &ctx->clock);
+}
+
+void wait_commands(struct gfx_context* ctx)
+{
+    cmdbuf_ring_wait(&ctx->cmdbuf_ring);
+    timing_lap(ctx->timing, PHASE_WAIT, &ctx->clock);
+
+    if (ctx->timer)
+    {
+        ctx->timing->phase_ns[PHASE_GPU] =
+            gpu_timer_elapsed_ns(ctx->timer, ctx->test_index);
+        ctx->timing->has_gpu_time = true;
+    }
+}
+
 static void make_image(
     struct gfx_context* ctx, DkImageFormat format, int width, int height,
-    DkImage* image, DkMemBlock* memblock, int flags)
+    DkImage* image, struct gpu_alloc* memory, int flags)
 {
     DkImageLayoutMaker layout_mk;
     dkImageLayoutMakerDefaults(&layout_mk, ctx->device);
@@ -74,24 +161,30 @@ static void make_image(
     DkImageLayout layout;
     dkImageLayoutInitialize(&layout, &layout_mk);
 
-    *memblock = make_memblock(ctx, dkImageLayoutGetSize(&layout), BLOCK_IMAGE);
+    *memory = alloc_memory(ctx, dkImageLayoutGetSize(&layout),
+        dkImageLayoutGetAlignment(&layout), BLOCK_IMAGE);
+    struct alloc_info* const info = &ctx->alloc_infos[ctx->num_allocs - 1];
+    info->image_width = width;
+    info->image_height = height;
+    info->image_format = format;
 
-    dkImageInitialize(image, &layout, *memblock, 0);
+    dkImageInitialize(image, &layout, memory->memblock, memory->offset);
+    cmd_trace_image(ctx, image, format, width, height, flags);
 }
 
 void make_image2d(
     struct gfx_context* ctx, DkImageFormat format, int width, int height,
-    DkImage* image, DkMemBlock* memblock)
+    DkImage* image, struct gpu_alloc* memory)
 {
-    make_image(ctx, format, width, height, image, memblock, 0);
+    make_image(ctx, format, width, height, image, memory, 0);
 }
 
 void make_render_target(
     struct gfx_context* ctx, DkImageFormat format, int width, int height,
-    DkImage* image, DkMemBlock* memblock)
+    DkImage* image, struct gpu_alloc* memory)
 {
     make_image(
-        ctx, format, width, height, image, memblock, DkImageFlags_UsageRender);
+        ctx, format, width, height, image, memory, DkImageFlags_UsageRender);
 }
 
 DkImageView make_image_view(DkImage const* image)
@@ -101,51 +194,97 @@ DkImageView make_image_view(DkImage const* image)
     return image_view;
 }
 
-DkShader make_shader(struct gfx_context* ctx, char const* glsl_name)
+static DkShader const* use_shader(
+    struct gfx_context* ctx, struct shader_cache_entry const* entry)
 {
-    char path[64];
-    snprintf(path, sizeof(path) - 1, "romfs:/%s.dksh", glsl_name);
-    FILE* const file = fopen(path, "rb");
-    if (!file)
+    if (ctx->num_shaders == MAX_TEST_SHADERS)
     {
-        printf("Failed to open shader \"%s\"! Aborting...\n", path);
+        printf("Too many shaders in a test! Aborting...\n");
         exit(EXIT_FAILURE);
     }
-    fseek(file, 0, SEEK_END);
-    size_t const dksh_size = (size_t)ftell(file);
-    rewind(file);
+    ctx->shaders[ctx->num_shaders++] = &entry->shader;
+    return &entry->shader;
+}
 
-    DkMemBlock const dksh_blk = make_memblock(ctx, dksh_size, BLOCK_CODE);
-    uint8_t* const dksh = dkMemBlockGetCpuAddr(dksh_blk);
-    if (fread(dksh, 1, dksh_size, file) != dksh_size)
+DkShader const* make_shader(struct gfx_context* ctx, char const* glsl_name)
+{
+    timing_lap(ctx->timing, PHASE_RECORD, &ctx->clock);
+
+    char name[64];
+    snprintf(name, sizeof(name) - 1, "%s.dksh", glsl_name);
+    struct shader_cache_entry const* entry =
+        shader_cache_find(ctx->shader_cache, name);
+    if (!entry)
     {
-        printf("Failed to read DKSH shader! Aborting...\n");
-        fclose(file);
-        exit(EXIT_FAILURE);
+        size_t dksh_size;
+        void const* const data =
+            shader_pack_find(ctx->pack, name, &dksh_size);
+        if (!data)
+        {
+            printf("Failed to find shader \"%s\"! Aborting...\n", name);
+            exit(EXIT_FAILURE);
+        }
+        timing_lap(ctx->timing, PHASE_LOAD, &ctx->clock);
+        entry = shader_cache_add(ctx->shader_cache, name, data, dksh_size);
+        timing_lap(ctx->timing, PHASE_BUILD, &ctx->clock);
     }
-    fclose(file);
 
-    DkShader shader;
-    DkShaderMaker shader_mk;
-    dkShaderMakerDefaults(&shader_mk, dksh_blk, 0);
-    dkShaderInitialize(&shader, &shader_mk);
-    return shader;
+    cmd_trace_shader(ctx, name, entry->code.cpu_addr, entry->dksh_size);
+    return use_shader(ctx, entry);
+}
+
+DkShader const* make_shader_from_dksh(struct gfx_context* ctx,
+    char const* name, void const* dksh, size_t dksh_size)
+{
+    struct shader_cache_entry const* entry =
+        shader_cache_find(ctx->shader_cache, name);
+    if (!entry)
+    {
+        timing_lap(ctx->timing, PHASE_LOAD, &ctx->clock);
+        entry = shader_cache_add(ctx->shader_cache, name, dksh, dksh_size);
+        timing_lap(ctx->timing, PHASE_BUILD, &ctx->clock);
+    }
+    return use_shader(ctx, entry);
 }
 
 DkGpuAddr bind_tic_pool(struct gfx_context* ctx, DkCmdBuf cmdbuf, uint32_t num)
 {
     size_t const size = num * sizeof(DkImageDescriptor);
-    DkMemBlock const memblock = make_memblock(ctx, size, BLOCK_NONE);
-    DkGpuAddr const addr = dkMemBlockGetGpuAddr(memblock);
-    dkCmdBufBindImageDescriptorSet(cmdbuf, addr, num);
-    return addr;
+    struct gpu_alloc const pool =
+        alloc_memory(ctx, size, DK_IMAGE_DESCRIPTOR_ALIGNMENT, BLOCK_NONE);
+    dkCmdBufBindImageDescriptorSet(cmdbuf, pool.gpu_addr, num);
+    cmd_trace_tic_pool(ctx, cmdbuf, num);
+    return pool.gpu_addr;
 }
 
 DkGpuAddr bind_tsc_pool(struct gfx_context* ctx, DkCmdBuf cmdbuf, uint32_t num)
 {
     size_t const size = num * sizeof(DkSamplerDescriptor);
-    DkMemBlock const memblock = make_memblock(ctx, size, BLOCK_NONE);
-    DkGpuAddr const addr = dkMemBlockGetGpuAddr(memblock);
-    dkCmdBufBindSamplerDescriptorSet(cmdbuf, addr, num);
-    return addr;
+    struct gpu_alloc const pool =
+        alloc_memory(ctx, size, DK_SAMPLER_DESCRIPTOR_ALIGNMENT, BLOCK_NONE);
+    dkCmdBufBindSamplerDescriptorSet(cmdbuf, pool.gpu_addr, num);
+    cmd_trace_tsc_pool(ctx, cmdbuf, num);
+    return pool.gpu_addr;
+}
+
+void bind_texture(
+    struct gfx_context* ctx, DkCmdBuf cmdbuf, DkGpuAddr tic_addr,
+    DkGpuAddr tsc_addr, DkImageView const* view, DkSampler const* sampler,
+    DkStage stage, uint32_t index)
+{
+    cmd_trace_texture(
+        ctx, cmdbuf, tic_addr, tsc_addr, view, sampler, stage, index);
+
+    DkImageDescriptor image_desc;
+    dkImageDescriptorInitialize(&image_desc, view, false, false);
+    DkSamplerDescriptor sampler_desc;
+    dkSamplerDescriptorInitialize(&sampler_desc, sampler);
+
+    DkResHandle const handle = dkMakeTextureHandle(index, index);
+    tic_addr += index * sizeof(image_desc);
+    tsc_addr += index * sizeof(sampler_desc);
+
+    dkCmdBufPushData(cmdbuf, tic_addr, &image_desc, sizeof(image_desc));
+    dkCmdBufPushData(cmdbuf, tsc_addr, &sampler_desc, sizeof(sampler_desc));
+    dkCmdBufBindTexture(cmdbuf, stage, index, handle);
 }
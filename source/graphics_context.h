@@ -2,40 +2,111 @@
 
 #include <deko3d.h>
 
-#define BLOCK_NONE 0
-#define BLOCK_IMAGE 1
-#define BLOCK_CODE 2
+#include "cmdbuf_ring.h"
+#include "gpu_arena.h"
+#include "shader_cache.h"
+#include "shader_pack.h"
+#include "timing.h"
+
+struct cmd_trace;
+
+// Shaders a test can make, and bind in one call
+#define MAX_TEST_SHADERS 16
+
+struct alloc_info
+{
+	// Size asked for, an image's layout size before alignment
+	size_t size;
+	// 0 unless it holds an image
+	uint32_t image_width;
+	uint32_t image_height;
+	DkImageFormat image_format;
+};
 
 struct gfx_context
 {
 	DkDevice device;
 	DkQueue queue;
-	size_t num_memblocks;
+	struct shader_pack const* pack;
+	// Memory is carved out of the arenas, which reset_context empties
+	struct gpu_arena arenas[NUM_BLOCK_TYPES];
+	// What the current test allocated, in order
+	struct gpu_alloc* allocs;
+	struct alloc_info* alloc_infos;
+	size_t num_allocs;
+	size_t allocs_capacity;
+	// Shared by the contexts of a run
+	struct shader_cache* shader_cache;
+	struct cmdbuf_ring cmdbuf_ring;
 	size_t num_cmdbufs;
 	size_t num_shaders;
-	DkMemBlock memblocks[128];
-	DkCmdBuf cmdbufs[4];
-	DkShader shaders[16];
+	// Command buffers the current test took from the ring
+	DkCmdBuf cmdbufs[CMDBUF_RING_SIZE];
+	// Shaders the current test made, in the cache
+	DkShader const* shaders[MAX_TEST_SHADERS];
+	// Timing of the current test, phases are lapped from clock. No GPU time
+	// is taken without a timer.
+	struct gpu_timer const* timer;
+	struct test_timing* timing;
+	size_t test_index;
+	uint64_t clock;
+	// Records what the test does when set
+	struct cmd_trace* trace;
 };
 
+void init_context(struct gfx_context* ctx, DkDevice device, DkQueue queue,
+	struct shader_pack const* pack, struct shader_cache* shader_cache);
+void destroy_context(struct gfx_context* ctx);
+
+// Frees what the test made, wait_commands must have returned since its last
+// submission
 void reset_context(struct gfx_context* ctx);
 
-DkMemBlock make_memblock(struct gfx_context* ctx, size_t size, int type);
+// Sizes are rounded up to DK_MEMBLOCK_ALIGNMENT, the memory is filled with
+// 0xcc
+struct gpu_alloc make_memory(struct gfx_context* ctx, size_t size, int type);
 
-DkCmdBuf make_cmdbuf(struct gfx_context* ctx, size_t size);
+// What an allocation of the context was made for
+struct alloc_info alloc_info(
+	struct gfx_context const* ctx, struct gpu_alloc const* alloc);
+
+// Command buffers come from the context's ring and grow as the test records.
+// The GPU time of a test runs from its command buffer's creation to
+// submit_commands.
+DkCmdBuf make_cmdbuf(struct gfx_context* ctx);
+
+// Returns once the commands are queued, the GPU may still be running them
+void submit_commands(struct gfx_context* ctx, DkCmdBuf cmdbuf);
+
+// Waits on the fences of what the context submitted and takes the test's GPU
+// time
+void wait_commands(struct gfx_context* ctx);
 
 void make_image2d(
 	struct gfx_context* ctx, DkImageFormat format, int width, int height,
-	DkImage* image, DkMemBlock* memblock);
+	DkImage* image, struct gpu_alloc* memory);
 
 void make_render_target(
 	struct gfx_context* ctx, DkImageFormat format, int width, int height,
-	DkImage* image, DkMemBlock* memblock);
+	DkImage* image, struct gpu_alloc* memory);
 
 DkImageView make_image_view(DkImage const* image);
 
-DkShader make_shader(struct gfx_context* ctx, char const* glsl_name);
+// Shaders are loaded from the pack the first time a test makes them and stay
+// until the context is destroyed
+DkShader const* make_shader(struct gfx_context* ctx, char const* glsl_name);
+
+// The cached shader of that name, made from the DKSH when there is none
+DkShader const* make_shader_from_dksh(struct gfx_context* ctx,
+	char const* name, void const* dksh, size_t dksh_size);
 
 DkGpuAddr bind_tic_pool(struct gfx_context* ctx, DkCmdBuf cmdbuf, uint32_t num);
 
 DkGpuAddr bind_tsc_pool(struct gfx_context* ctx, DkCmdBuf cmdbuf, uint32_t num);
+
+// Writes the descriptors of the view and sampler at index in the pools and
+// binds them as a texture
+void bind_texture(
+	struct gfx_context* ctx, DkCmdBuf cmdbuf, DkGpuAddr tic_addr,
+	DkGpuAddr tsc_addr, DkImageView const* view, DkSampler const* sampler,
+	DkStage stage, uint32_t index);
@@ -1,70 +1,63 @@
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 
 #include <deko3d.h>
 
+#include "capture.h"
+#include "cmd_trace.h"
 #include "graphics_tests.h"
 #include "graphics_context.h"
 #include "helper.h"
 #include "hash.h"
+#include "swizzle.h"
+#include "test_filter.h"
+#include "test_log.h"
+#include "tile_hash.h"
+#include "timing.h"
+#include "verify_pool.h"
 
 #define TEST(name, expected) { name_##name, name, expected }
 
 #define DEFINE_TEST(name) \
     static char name_##name[] = #name; \
-    static DkMemBlock name(struct gfx_context* ctx)
+    static struct gpu_alloc name(struct gfx_context* ctx)
 
 struct gfx_test_descriptor
 {
     char* name;
-    DkMemBlock (*func)(struct gfx_context*);
+    struct gpu_alloc (*func)(struct gfx_context*);
     u64 expected;
 };
 
-static void bind_texture(
-    DkCmdBuf cmdbuf, DkGpuAddr tic_addr, DkGpuAddr tsc_addr,
-    DkImageDescriptor image_desc, DkSamplerDescriptor sampler_desc,
-    DkStage stage, uint32_t index)
-{
-    DkResHandle const handle = dkMakeTextureHandle(index, index);
-    tic_addr += index * sizeof(image_desc);
-    tsc_addr += index * sizeof(sampler_desc);
-
-    dkCmdBufPushData(cmdbuf, tic_addr, &image_desc, sizeof(image_desc)); 
-    dkCmdBufPushData(cmdbuf, tsc_addr, &sampler_desc, sizeof(sampler_desc));
-    dkCmdBufBindTexture(cmdbuf, stage, index, handle);
-}
-
 #define BASIC_INIT(format, is_color)                                   \
     DkImage render_target;                                             \
-    DkMemBlock render_target_memblock;                                 \
+    struct gpu_alloc render_target_memory;                             \
     make_render_target(                                                \
         ctx, DkImageFormat_##format, 64, 64, &render_target,           \
-        &render_target_memblock);                                      \
+        &render_target_memory);                                        \
     DkImageView render_target_view = make_image_view(&render_target);  \
-    DkCmdBuf const cmdbuf = make_cmdbuf(ctx, 1024);                    \
+    DkCmdBuf const cmdbuf = make_cmdbuf(ctx);                          \
     DkImageView const* const color_rt_view[] = {&render_target_view};  \
     DkImageView* zeta_rt_view = is_color ? NULL : &render_target_view; \
-    dkCmdBufBindRenderTargets(                                         \
-        cmdbuf, color_rt_view, is_color ? 1 : 0, zeta_rt_view);        \
+    rec_bind_render_targets(                                           \
+        ctx, cmdbuf, color_rt_view, is_color ? 1 : 0, zeta_rt_view);   \
     {                                                                  \
         DkViewport viewport = {0, 0, 64, 64, 0, 1};                    \
-        dkCmdBufSetViewports(cmdbuf, 0, &viewport, 1);                 \
+        rec_set_viewports(ctx, cmdbuf, 0, &viewport, 1);               \
     }
 
 #define BIND_SHADER(type, name) \
-    do {                                                              \
-        DkShader const shader = make_shader(ctx, name);               \
-        DkShader const* const shaders = &shader;                      \
-        dkCmdBufBindShaders(cmdbuf, DkStageFlag_##type, &shaders, 1); \
+    do {                                                                   \
+        DkShader const* const shader = make_shader(ctx, name);             \
+        rec_bind_shaders(ctx, cmdbuf, DkStageFlag_##type, &shader, 1);     \
     } while (0);
 
-#define BASIC_END                                                  \
-    dkQueueSubmitCommands(ctx->queue, dkCmdBufFinishList(cmdbuf)); \
-    dkQueueWaitIdle(ctx->queue);                                   \
-    return render_target_memblock;
+#define BASIC_END                \
+    submit_commands(ctx, cmdbuf); \
+    return render_target_memory;
 
 #define BIND_TEXTURE_POOLS \
     DkGpuAddr const tic_addr = bind_tic_pool(ctx, cmdbuf, 32); \
@@ -73,7 +66,7 @@ static void bind_texture(
 #define MAKE_IMAGE2D(name, format, width, height)                            \
     DkImage name;                                                            \
     DkImageView name ## _view;                                               \
-    DkMemBlock name ## _blk;                                                 \
+    struct gpu_alloc name ## _blk;                                           \
     make_image2d(                                                            \
         ctx, DkImageFormat_ ## format, width, height, &name, &name ## _blk); \
     dkImageViewDefaults(&name##_view, &name);
@@ -82,17 +75,9 @@ static void bind_texture(
     DkSampler name;           \
     dkSamplerDefaults(&name);
 
-#define REGISTER_IMAGE(name)                                                 \
-    DkImageDescriptor name ## _desc;                                         \
-    dkImageDescriptorInitialize(&name ## _desc, &name##_view, false, false);
-
-#define REGISTER_SAMPLER(name)                            \
-    DkSamplerDescriptor name ## _desc;                    \
-    dkSamplerDescriptorInitialize(&name ## _desc, &name);
-
-#define BIND_TEXTURE(image, sampler, stage, index)                \
-    bind_texture(                                                 \
-        cmdbuf, tic_addr, tsc_addr, image##_desc, sampler##_desc, \
+#define BIND_TEXTURE(image, sampler, stage, index)              \
+    bind_texture(                                               \
+        ctx, cmdbuf, tic_addr, tsc_addr, &image##_view, &sampler, \
         DkStage_##stage, index);
 
 DEFINE_TEST(clear)
@@ -100,7 +85,7 @@ DEFINE_TEST(clear)
     BASIC_INIT(RGBA8_Unorm, true)
 
     static float const clear_color[4] = {1.0f, 0.8f, 0.25f, 0.125f};
-    dkCmdBufClearColor(cmdbuf, 0, DkColorMask_RGBA, clear_color);
+    rec_clear_color(ctx, cmdbuf, 0, DkColorMask_RGBA, clear_color);
 
     BASIC_END
 }
@@ -113,10 +98,10 @@ DEFINE_TEST(clear_scissor)
     static float const scissor_color[4] = {102.4f, 0.0f, -43.2f, 8.13f};
     static DkScissor const scissor = {13, 17, 23, 45};
     static DkScissor const default_scissor = {0, 0, 65535, 65535};
-    dkCmdBufClearColor(cmdbuf, 0, DkColorMask_RGBA, background_color);
-    dkCmdBufSetScissors(cmdbuf, 0, &scissor, 1);
-    dkCmdBufClearColor(cmdbuf, 0, DkColorMask_RGBA, scissor_color);
-    dkCmdBufSetScissors(cmdbuf, 0, &default_scissor, 1);
+    rec_clear_color(ctx, cmdbuf, 0, DkColorMask_RGBA, background_color);
+    rec_set_scissors(ctx, cmdbuf, 0, &scissor, 1);
+    rec_clear_color(ctx, cmdbuf, 0, DkColorMask_RGBA, scissor_color);
+    rec_set_scissors(ctx, cmdbuf, 0, &default_scissor, 1);
 
     BASIC_END
 }
@@ -129,10 +114,10 @@ DEFINE_TEST(clear_scissor_masked)
     static float const scissor_color[4] = {102.4f, 0.0f, -43.2f, 8.13f};
     static DkScissor const scissor = {13, 17, 23, 45};
     static DkScissor const default_scissor = {0, 0, 65535, 65535};
-    dkCmdBufClearColor(cmdbuf, 0, DkColorMask_RGBA, background_color);
-    dkCmdBufSetScissors(cmdbuf, 0, &scissor, 1);
-    dkCmdBufClearColor(cmdbuf, 0, DkColorMask_RGB, scissor_color);
-    dkCmdBufSetScissors(cmdbuf, 0, &default_scissor, 1);
+    rec_clear_color(ctx, cmdbuf, 0, DkColorMask_RGBA, background_color);
+    rec_set_scissors(ctx, cmdbuf, 0, &scissor, 1);
+    rec_clear_color(ctx, cmdbuf, 0, DkColorMask_RGB, scissor_color);
+    rec_set_scissors(ctx, cmdbuf, 0, &default_scissor, 1);
 
     BASIC_END
 }
@@ -140,22 +125,22 @@ DEFINE_TEST(clear_scissor_masked)
 DEFINE_TEST(clear_depth)
 {
     DkImage render_target;
-    DkMemBlock render_target_memblock;
+    struct gpu_alloc render_target_memory;
     make_render_target(
-        ctx, DkImageFormat_ZF32, 64, 64, &render_target, &render_target_memblock);
+        ctx, DkImageFormat_ZF32, 64, 64, &render_target, &render_target_memory);
     DkImageView render_target_view = make_image_view(&render_target);
 
-    DkCmdBuf cmdbuf = make_cmdbuf(ctx, 1024);
+    DkCmdBuf cmdbuf = make_cmdbuf(ctx);
 
     DkDepthStencilState ds;
     dkDepthStencilStateDefaults(&ds);
     ds.depthTestEnable = 0;
     ds.depthWriteEnable = 0;
-    dkCmdBufBindDepthStencilState(cmdbuf, &ds);
+    rec_bind_depth_stencil_state(ctx, cmdbuf, &ds);
 
-    dkCmdBufBindRenderTargets(cmdbuf, NULL, 0, &render_target_view);
+    rec_bind_render_targets(ctx, cmdbuf, NULL, 0, &render_target_view);
 
-    dkCmdBufClearDepthStencil(cmdbuf, true, 32.15f, 0, 0);
+    rec_clear_depth_stencil(ctx, cmdbuf, true, 32.15f, 0, 0);
 
     BASIC_END
 }
@@ -167,11 +152,101 @@ DEFINE_TEST(basic_draw)
     BIND_SHADER(Vertex, "full_screen_tri.vert")
     BIND_SHADER(Fragment, "red.frag")
 
-    dkCmdBufDraw(cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
+    rec_draw(ctx, cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
 
     BASIC_END
 }
 
+// Bytes taken by an element of the format and its size in pixels, the
+// blocks of compressed formats being 4x4
+static uint32_t format_element(
+    DkImageFormat format, uint32_t* width, uint32_t* height)
+{
+    *width = 1;
+    *height = 1;
+    switch (format)
+    {
+    case DkImageFormat_R8_Unorm: case DkImageFormat_R8_Snorm:
+    case DkImageFormat_R8_Uint: case DkImageFormat_R8_Sint:
+        return 1;
+    case DkImageFormat_R16_Float: case DkImageFormat_R16_Unorm:
+    case DkImageFormat_R16_Snorm: case DkImageFormat_R16_Uint:
+    case DkImageFormat_R16_Sint: case DkImageFormat_RG8_Unorm:
+    case DkImageFormat_RG8_Snorm: case DkImageFormat_RG8_Uint:
+    case DkImageFormat_RG8_Sint: case DkImageFormat_RGBA4_Unorm:
+    case DkImageFormat_RGB5_Unorm: case DkImageFormat_RGB5A1_Unorm:
+    case DkImageFormat_RGB565_Unorm: case DkImageFormat_BGR565_Unorm:
+    case DkImageFormat_BGR5_Unorm: case DkImageFormat_BGR5A1_Unorm:
+    case DkImageFormat_A5BGR5_Unorm:
+        return 2;
+    case DkImageFormat_RG32_Float: case DkImageFormat_RG32_Uint:
+    case DkImageFormat_RG32_Sint: case DkImageFormat_RGBA16_Float:
+    case DkImageFormat_RGBA16_Unorm: case DkImageFormat_RGBA16_Snorm:
+    case DkImageFormat_RGBA16_Uint: case DkImageFormat_RGBA16_Sint:
+    case DkImageFormat_RGBX16_Float: case DkImageFormat_RGBX16_Unorm:
+    case DkImageFormat_RGBX16_Snorm: case DkImageFormat_RGBX16_Uint:
+    case DkImageFormat_RGBX16_Sint:
+        return 8;
+    case DkImageFormat_RGB32_Float: case DkImageFormat_RGB32_Uint:
+    case DkImageFormat_RGB32_Sint:
+        return 12;
+    case DkImageFormat_RGBA32_Float: case DkImageFormat_RGBA32_Uint:
+    case DkImageFormat_RGBA32_Sint: case DkImageFormat_RGBX32_Float:
+    case DkImageFormat_RGBX32_Uint: case DkImageFormat_RGBX32_Sint:
+        return 16;
+    case DkImageFormat_RGB_BC1: case DkImageFormat_RGBA_BC1:
+    case DkImageFormat_RGB_BC1_sRGB: case DkImageFormat_RGBA_BC1_sRGB:
+    case DkImageFormat_R_BC4_Unorm: case DkImageFormat_R_BC4_Snorm:
+    case DkImageFormat_R_ETC2_Unorm: case DkImageFormat_R_ETC2_Snorm:
+    case DkImageFormat_RGB_ETC2: case DkImageFormat_RGB_PTA_ETC2:
+    case DkImageFormat_RGB_ETC2_sRGB: case DkImageFormat_RGB_PTA_ETC2_sRGB:
+        *width = 4;
+        *height = 4;
+        return 8;
+    case DkImageFormat_RGBA_BC2: case DkImageFormat_RGBA_BC3:
+    case DkImageFormat_RGBA_BC2_sRGB: case DkImageFormat_RGBA_BC3_sRGB:
+    case DkImageFormat_RG_BC5_Unorm: case DkImageFormat_RG_BC5_Snorm:
+    case DkImageFormat_RGBA_BC7_Unorm: case DkImageFormat_RGBA_BC7_Unorm_sRGB:
+    case DkImageFormat_RGBA_BC6H_SF16_Float:
+    case DkImageFormat_RGBA_BC6H_UF16_Float:
+    case DkImageFormat_RG_ETC2_Unorm: case DkImageFormat_RG_ETC2_Snorm:
+    case DkImageFormat_RGBA_ETC2: case DkImageFormat_RGBA_ETC2_sRGB:
+        *width = 4;
+        *height = 4;
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+// Fills a linear image with the 32-bit pattern and swizzles it into the
+// image's memory, laid out the way deko3d picks for it
+static void fill_image2d(struct gpu_alloc const* memory,
+    DkImageFormat format, uint32_t width, uint32_t height, uint32_t pattern)
+{
+    uint32_t element_width, element_height;
+    uint32_t const bytes =
+        format_element(format, &element_width, &element_height);
+    struct swizzle_layout layout;
+    swizzle_layout_init(&layout, width, height, 1, bytes, element_width,
+        element_height);
+    if (swizzle_size(&layout) > memory->size)
+    {
+        printf("Image layout doesn't fit its memory! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t const pitch = (size_t)layout.width * bytes;
+    size_t const size = pitch * layout.height;
+    uint8_t* const linear = checked_malloc(size);
+    for (size_t i = 0; i < size; ++i)
+        linear[i] = (uint8_t)(pattern >> (i % sizeof(pattern) * 8));
+
+    memset(memory->cpu_addr, 0, memory->size);
+    swizzle(&layout, memory->cpu_addr, linear, pitch);
+    free(linear);
+}
+
 DEFINE_TEST(sample_depth)
 {
     BASIC_INIT(RGBA32_Float, true)
@@ -185,14 +260,11 @@ DEFINE_TEST(sample_depth)
     MAKE_IMAGE2D(image, Z24S8, 32, 32)
     image_view.dsSource = DkDsSource_Depth;
 
-    memset(dkMemBlockGetCpuAddr(image_blk), 0xaa, dkMemBlockGetSize(image_blk));
-
-    REGISTER_IMAGE(image)
-    REGISTER_SAMPLER(sampler)
+    fill_image2d(&image_blk, DkImageFormat_Z24S8, 32, 32, 0xaaaaaaaa);
 
     BIND_TEXTURE(image, sampler, Fragment, 0)
 
-    dkCmdBufDraw(cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
+    rec_draw(ctx, cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
 
     BASIC_END
 }
@@ -210,19 +282,16 @@ DEFINE_TEST(sample_stencil)
     MAKE_IMAGE2D(image, Z24S8, 32, 32)
     image_view.dsSource = DkDsSource_Stencil;
 
-    memset(dkMemBlockGetCpuAddr(image_blk), 0xaa, dkMemBlockGetSize(image_blk));
-
-    REGISTER_IMAGE(image)
-    REGISTER_SAMPLER(sampler)
+    fill_image2d(&image_blk, DkImageFormat_Z24S8, 32, 32, 0xaaaaaaaa);
 
     BIND_TEXTURE(image, sampler, Fragment, 0)
 
-    dkCmdBufDraw(cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
+    rec_draw(ctx, cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
 
     BASIC_END
 }
 
-static DkMemBlock sampler_template(struct gfx_context* ctx, DkSampler sampler)
+static struct gpu_alloc sampler_template(struct gfx_context* ctx, DkSampler sampler)
 {
     BASIC_INIT(RGBA8_Unorm, true)
 
@@ -236,8 +305,8 @@ static DkMemBlock sampler_template(struct gfx_context* ctx, DkSampler sampler)
     sampler.minFilter = DkFilter_Linear;
     sampler.magFilter = DkFilter_Linear;
 
-    uint8_t* data = dkMemBlockGetCpuAddr(image_blk);
-    size_t size = dkMemBlockGetSize(image_blk);
+    uint8_t* data = image_blk.cpu_addr;
+    size_t size = image_blk.size;
     memset(data, 0, size);
 
     uint32_t const values[] = {0xdeadbeef, 0xcafecafe, 0xdedede00, 0xacdc0000};
@@ -247,12 +316,9 @@ static DkMemBlock sampler_template(struct gfx_context* ctx, DkSampler sampler)
         memcpy(&data[i], &value, sizeof(uint32_t));
     }
 
-    REGISTER_IMAGE(image)
-    REGISTER_SAMPLER(sampler)
-
     BIND_TEXTURE(image, sampler, Fragment, 0)
 
-    dkCmdBufDraw(cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
+    rec_draw(ctx, cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
 
     BASIC_END
 }
@@ -368,21 +434,21 @@ DEFINE_TEST(robust_vertex_buffer)
         { .stride = 4 * sizeof(float), },
     };
 
-    DkMemBlock positions_blk = make_memblock(ctx, sizeof(positions), BLOCK_NONE);
-    DkMemBlock colors_blk = make_memblock(ctx, sizeof(colors), BLOCK_NONE);
+    struct gpu_alloc positions_blk = make_memory(ctx, sizeof(positions), BLOCK_NONE);
+    struct gpu_alloc colors_blk = make_memory(ctx, sizeof(colors), BLOCK_NONE);
 
-    memcpy(dkMemBlockGetCpuAddr(positions_blk), positions, sizeof(positions));
-    memcpy(dkMemBlockGetCpuAddr(colors_blk), colors, sizeof(colors));
+    memcpy(positions_blk.cpu_addr, positions, sizeof(positions));
+    memcpy(colors_blk.cpu_addr, colors, sizeof(colors));
 
     DkBufExtents const buffer_extents[] = {
-        { .addr = dkMemBlockGetGpuAddr(colors_blk),    .size = sizeof(float) * 4 * 2, },
-        { .addr = dkMemBlockGetGpuAddr(positions_blk), .size = sizeof(float) * 4 * 4, },
+        { .addr = colors_blk.gpu_addr,    .size = sizeof(float) * 4 * 2, },
+        { .addr = positions_blk.gpu_addr, .size = sizeof(float) * 4 * 4, },
     };
 
-    dkCmdBufBindVtxAttribState(cmdbuf, vtx_attrib_state, 2);
-    dkCmdBufBindVtxBufferState(cmdbuf, vtx_buffer_state, 2);
-    dkCmdBufBindVtxBuffers(cmdbuf, 0, buffer_extents, 2);
-    dkCmdBufDraw(cmdbuf, DkPrimitive_Quads, 4, 1, 0, 0);
+    rec_bind_vtx_attrib_state(ctx, cmdbuf, vtx_attrib_state, 2);
+    rec_bind_vtx_buffer_state(ctx, cmdbuf, vtx_buffer_state, 2);
+    rec_bind_vtx_buffers(ctx, cmdbuf, 0, buffer_extents, 2);
+    rec_draw(ctx, cmdbuf, DkPrimitive_Quads, 4, 1, 0, 0);
 
     BASIC_END
 }
@@ -392,7 +458,7 @@ static void rendertarget_test_template(struct gfx_context* ctx, DkCmdBuf cmdbuf)
     BIND_SHADER(Vertex, "full_screen_tri.vert")
     BIND_SHADER(Fragment, "fuzz_color.frag")
 
-    dkCmdBufDraw(cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
+    rec_draw(ctx, cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
 }
 
 #define DEFINE_RT_FORMAT_TEST(format)            \
@@ -448,7 +514,7 @@ DEFINE_RT_FORMAT_TEST(RG11B10_Float)
 DEFINE_RT_FORMAT_TEST(BGR565_Unorm)
 DEFINE_RT_FORMAT_TEST(BGR5A1_Unorm)
 
-static DkMemBlock attrib_format_test_template(
+static struct gpu_alloc attrib_format_test_template(
     struct gfx_context* ctx, DkVtxAttribSize size, DkVtxAttribType type,
     int bgra)
 {
@@ -460,10 +526,10 @@ static DkMemBlock attrib_format_test_template(
     BIND_SHADER(Vertex, "colored_full_screen_tri.vert");
     BIND_SHADER(Fragment, "color.frag");
 
-    DkMemBlock color_blk = make_memblock(ctx, sizeof(data), BLOCK_NONE);
-    memcpy(dkMemBlockGetCpuAddr(color_blk), data, sizeof(data));
+    struct gpu_alloc color_blk = make_memory(ctx, sizeof(data), BLOCK_NONE);
+    memcpy(color_blk.cpu_addr, data, sizeof(data));
     DkBufExtents const extent = {
-        .addr = dkMemBlockGetGpuAddr(color_blk),
+        .addr = color_blk.gpu_addr,
         .size = sizeof(data),
     };
     DkVtxAttribState state = {
@@ -472,10 +538,10 @@ static DkMemBlock attrib_format_test_template(
         .isBgra = bgra,
     };
 
-    dkCmdBufBindVtxAttribState(cmdbuf, &state, 1);
-    dkCmdBufBindVtxBufferState(cmdbuf, &buffer_state, 1);
-    dkCmdBufBindVtxBuffers(cmdbuf, 0, &extent, 1);
-    dkCmdBufDraw(cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
+    rec_bind_vtx_attrib_state(ctx, cmdbuf, &state, 1);
+    rec_bind_vtx_buffer_state(ctx, cmdbuf, &buffer_state, 1);
+    rec_bind_vtx_buffers(ctx, cmdbuf, 0, &extent, 1);
+    rec_draw(ctx, cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
 
     BASIC_END
 }
@@ -585,7 +651,7 @@ DEFINE_ATTRIB_FORMAT_TEST(RG11B10, Sscaled, _11_11_10)
 DEFINE_ATTRIB_FORMAT_TEST(RG11B10, Uscaled, _11_11_10)
 DEFINE_ATTRIB_FORMAT_TEST(RG11B10, Float,   _11_11_10)
 
-static DkMemBlock sample_color_template(
+static struct gpu_alloc sample_color_template(
     struct gfx_context* ctx, DkImageFormat format)
 {
     BASIC_INIT(RGBA16_Float, true)
@@ -599,25 +665,16 @@ static DkMemBlock sample_color_template(
 
     DkImage image;
     DkImageView image_view;
-    DkMemBlock image_blk;
+    struct gpu_alloc image_blk;
     make_image2d(ctx, format, 32, 32, &image, &image_blk);
 
     dkImageViewDefaults(&image_view, &image);
 
-    uint8_t* data = dkMemBlockGetCpuAddr(image_blk);
-    size_t size = dkMemBlockGetSize(image_blk);
-    memset(data, 0, size);
-    for (size_t i = 0; i < size; i += sizeof(uint32_t)) {
-        uint32_t value = 0xa82c2c11;
-        memcpy(&data[i], &value, sizeof(uint32_t));
-    }
-
-    REGISTER_IMAGE(image)
-    REGISTER_SAMPLER(sampler)
+    fill_image2d(&image_blk, format, 32, 32, 0xa82c2c11);
 
     BIND_TEXTURE(image, sampler, Fragment, 0)
 
-    dkCmdBufDraw(cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
+    rec_draw(ctx, cmdbuf, DkPrimitive_Triangles, 3, 1, 0, 0);
 
     BASIC_END
 }
@@ -1069,49 +1126,344 @@ static struct gfx_test_descriptor test_descriptors[] =
 };
 #define NUM_TESTS (sizeof(test_descriptors) / sizeof(test_descriptors[0]))
 
-void run_graphics_tests(DkDevice device, DkQueue queue, bool automatic_mode)
+static void capture_result(struct capture* capture, char const* name,
+    struct gpu_alloc const* result, struct alloc_info info, u64 hash,
+    u64 expected,
+    bool pass, struct test_log* log)
+{
+    uint32_t const rows = (info.image_height + GOB_HEIGHT - 1) / GOB_HEIGHT;
+    struct capture_record const record = {
+        .format = info.image_format,
+        .width = info.image_width,
+        .height = info.image_height,
+        .block_height = swizzle_block_height(rows),
+        .size = info.size,
+        .flags = pass ? CAPTURE_PASSED : 0,
+        .hash = hash,
+        .expected = expected,
+    };
+    if (!capture_image(capture, name, &record, result->cpu_addr)
+        && !pass)
+    {
+        test_log_printf(log, "not captured ");
+    }
+}
+
+// Differing tiles named on a failure, the count covers the rest
+#define MAX_REPORTED_TILES 4
+
+// Tile hashes as they go in a golden, free() them
+static char* format_tiles(uint32_t const* hashes, size_t count)
+{
+    size_t const size = count * TILE_HASH_DIGITS + 1;
+    char* const text = checked_malloc(size);
+    tile_hash_format(hashes, count, text, size);
+    return text;
+}
+
+// Names the tiles that differ from the golden's, in tiles of 64 bytes by 8
+// rows from the top left, and whether the whole image changed
+static void report_tiles(struct test_log* log, uint32_t const* hashes,
+    struct alloc_info info, char const* golden_tiles)
+{
+    size_t const count = tile_count(info.size);
+    uint32_t* const expected = checked_malloc(count * sizeof(*expected));
+    if (!tile_hash_parse(golden_tiles, expected, count))
+    {
+        test_log_printf(log, "tiles don't match the image ");
+        test_log_note(log, "tiles-mismatch");
+        free(expected);
+        return;
+    }
+
+    struct tile_grid grid;
+    tile_grid_init(&grid, info.size, info.image_height);
+    size_t num_differing = 0;
+    for (size_t i = 0; i < count; ++i)
+        num_differing += hashes[i] != expected[i];
+
+    test_log_printf(log, "%zu/%zu tiles ", num_differing, count);
+    test_log_note(log, "%s %zu/%zu",
+        num_differing == count ? "full" : "partial", num_differing, count);
+    size_t num_reported = 0;
+    for (size_t i = 0; i < count && num_reported < MAX_REPORTED_TILES; ++i)
+    {
+        if (hashes[i] == expected[i])
+            continue;
+        uint32_t x, y;
+        tile_position(&grid, i, &x, &y);
+        test_log_printf(log, "(%u,%u) ", x, y);
+        test_log_note(log, " (%u,%u)", x, y);
+        ++num_reported;
+    }
+    free(expected);
+}
+
+// What a worker works out about a result, the report is made from it in test
+// order
+struct verification
 {
-    struct gfx_context ctx = {0};
-    ctx.device = device;
-    ctx.queue = queue;
+    struct verify_job job;
+    struct gpu_alloc result;
+    struct alloc_info info;
+    // The golden's value, or the built-in one which is a legacy hash
+    bool has_golden;
+    u64 expected;
+    char const* golden_tiles;
+    bool is_updating;
+    // A golden, capture or trace wants hash_alloc's hash
+    bool needs_hash;
+
+    u64 hash;
+    u64 got;
+    bool pass;
+    // Set when updating the goldens or on a failure to report, free() them
+    uint32_t* tiles;
+};
+
+static void verify_result(struct verify_job* job)
+{
+    struct verification* const v = (struct verification*)job;
+    v->hash = v->needs_hash ? hash_alloc(&v->result, v->info.size) : 0;
+    v->got = v->has_golden ? v->hash : hash_alloc_legacy(&v->result);
+    v->pass = v->expected == v->got;
+    // Tiles are only hashed to find what changed or for a new golden
+    if (v->is_updating || (!v->pass && v->golden_tiles))
+    {
+        v->tiles = checked_malloc(
+            tile_count(v->info.size) * sizeof(*v->tiles));
+        tile_hash(v->result.cpu_addr, v->info.size, v->tiles);
+    }
+}
+
+enum slot_state
+{
+    SLOT_IDLE,
+    SLOT_RUNNING,
+    SLOT_VERIFYING,
+};
+
+// A test recorded on one of the pipeline's contexts, verified once its fences
+// signal. The context keeps the test's resources until it is reported.
+struct pipeline_slot
+{
+    struct gfx_context ctx;
+    struct test_timing timing;
+    struct verification verification;
+    // Position among the selected tests
+    size_t num;
+    enum slot_state state;
+};
+
+// Where finished tests are reported
+struct gfx_run
+{
+    size_t num_selected;
+    struct goldens* goldens;
+    struct test_log* log;
+    FILE* timing_log;
+    struct capture* capture;
+    struct verify_pool* pool;
+    size_t failures;
+    size_t num_run;
+};
+
+static void start_test(struct pipeline_slot* slot, size_t test, size_t num)
+{
+    struct gfx_context* const ctx = &slot->ctx;
+    memset(&slot->timing, 0, sizeof(slot->timing));
+    ctx->timing = &slot->timing;
+    ctx->test_index = test;
+    ctx->clock = timing_now_ns();
+
+    cmd_trace_begin_test(ctx, test_descriptors[test].name);
+    slot->verification.result = test_descriptors[test].func(ctx);
+    timing_lap(&slot->timing, PHASE_RECORD, &ctx->clock);
+    slot->num = num;
+    slot->state = SLOT_RUNNING;
+}
+
+// Waits for the GPU to be done with the slot's test and hands the result to
+// the workers
+static void verify_test(struct pipeline_slot* slot, struct gfx_run* run)
+{
+    if (slot->state != SLOT_RUNNING)
+        return;
+    struct gfx_context* const ctx = &slot->ctx;
+    struct gfx_test_descriptor const* const test =
+        &test_descriptors[ctx->test_index];
+
+    // Other tests ran since the submission, only the wait counts
+    ctx->clock = timing_now_ns();
+    wait_commands(ctx);
+
+    struct verification* const v = &slot->verification;
+    v->info = alloc_info(ctx, &v->result);
+    struct golden_entry const* const golden =
+        goldens_find(run->goldens, "graphics", test->name);
+    v->has_golden = golden != NULL;
+    v->expected = golden ? golden->value : test->expected;
+    v->golden_tiles = golden ? golden->tiles : NULL;
+    v->is_updating = run->goldens && run->goldens->is_updating;
+    v->needs_hash = v->has_golden || v->is_updating || run->capture
+        || ctx->trace;
+    v->tiles = NULL;
+    v->job.run = verify_result;
+    verify_pool_submit(run->pool, &v->job);
+    slot->state = SLOT_VERIFYING;
+}
 
-    printf("Running graphics tests...\n\n");
+// Reports the slot's test, if it has one. False once the failure budget is
+// exceeded.
+static bool finish_test(struct pipeline_slot* slot, struct gfx_run* run)
+{
+    if (slot->state == SLOT_IDLE)
+        return true;
+    verify_test(slot, run);
+    struct gfx_context* const ctx = &slot->ctx;
+    struct gfx_test_descriptor const* const test =
+        &test_descriptors[ctx->test_index];
+    struct verification* const v = &slot->verification;
+    struct test_log* const log = run->log;
+
+    // The workers' hashing overlaps other tests, the verify time is what
+    // this thread spends on the verdict
+    ctx->clock = timing_now_ns();
+    verify_pool_wait(run->pool, &v->job);
+
+    test_log_begin_test(log, slot->num, run->num_selected, test->name, 45);
+    if (!v->pass)
+    {
+        test_log_printf(log, "got 0x%016"PRIx64" ", v->got);
+        if (v->golden_tiles)
+            report_tiles(log, v->tiles, v->info, v->golden_tiles);
+        ++run->failures;
+    }
+    if (capture_wants(run->capture, v->pass))
+    {
+        capture_result(run->capture, test->name, &v->result, v->info,
+            v->hash, v->expected, v->pass, log);
+    }
+    if (v->is_updating)
+    {
+        char* const tiles =
+            format_tiles(v->tiles, tile_count(v->info.size));
+        goldens_record(run->goldens, "graphics", test->name, v->hash, tiles);
+        free(tiles);
+    }
+    free(v->tiles);
+    v->tiles = NULL;
+    timing_lap(&slot->timing, PHASE_VERIFY, &ctx->clock);
+    cmd_trace_end_test(ctx, &v->result, v->hash);
+    reset_context(ctx);
+    slot->state = SLOT_IDLE;
+    ++run->num_run;
+
+    test_log_end_test(log, v->pass);
+    timing_write(run->timing_log, "graphics", test->name, v->pass,
+        &slot->timing);
+    if (test_log_budget_exceeded(log))
+    {
+        test_log_printf(log, "\nStopping, %zu tests failed\n",
+            log->num_failed);
+        return false;
+    }
+    return true;
+}
 
-    size_t failures = 0;
+void run_graphics_tests(DkDevice device, DkQueue queue,
+    struct shader_pack const* pack, struct test_filter const* filter,
+    struct goldens* goldens, struct test_log* log, FILE* timing_log,
+    struct cmd_trace* trace, struct capture* capture, size_t pipeline_depth,
+    size_t verify_threads)
+{
+    bool selected[NUM_TESTS];
+    size_t num_selected = 0;
     for (size_t i = 0; i < NUM_TESTS; ++i)
     {
-        struct gfx_test_descriptor* const test = &test_descriptors[i];
-        int written_chars =
-            printf("%3zd/%3zd Test: %s", i + 1, NUM_TESTS, test->name);
-        for (int i = 0; i < 45 - written_chars; ++i)
-            putc('.', stdout);
-        putc(' ', stdout);
-
-        consoleUpdate(NULL);
-
-        u64 const hash = hash_memblock(test->func(&ctx));
-        reset_context(&ctx);
-
-        if (test->expected == hash)
-        {
-            puts("Passed");
-        }
-        else
-        {
-            printf("Failed (0x%016"PRIx64")\n", hash);
-            ++failures;
-        }
-
-        consoleUpdate(NULL);
-
-        if (!automatic_mode && i != 0 && i % 43 == 0)
-        {
-            printf("Press A to continue...");
-            wait_for_input();
-        }
+        selected[i] =
+            test_filter_selects(filter, test_descriptors[i].name, NULL);
+        num_selected += selected[i];
     }
+    if (num_selected == 0)
+    {
+        test_log_printf(log, "No graphics tests selected\n\n");
+        test_log_flush(log);
+        return;
+    }
+
+    // A trace holds one whole test after the other
+    size_t const depth = trace ? 1 : pipeline_depth;
 
-    printf("\n%3d%% tests passed, %zd tests failed out of %zd\n\n",
-        (int)((NUM_TESTS - failures) * 100 / (float)NUM_TESTS), failures,
-        NUM_TESTS);
+    // Timestamps are only taken for the timing log
+    struct gpu_timer timer;
+    struct gpu_timer* const gpu_timer = timing_log ? &timer : NULL;
+    if (gpu_timer)
+        gpu_timer_create(gpu_timer, device, queue, NUM_TESTS);
+
+    struct shader_cache shader_cache;
+    shader_cache_init(&shader_cache, device);
+    struct pipeline_slot slots[MAX_PIPELINE_DEPTH];
+    for (size_t i = 0; i < depth; ++i)
+    {
+        init_context(&slots[i].ctx, device, queue, pack, &shader_cache);
+        slots[i].ctx.timer = gpu_timer;
+        slots[i].ctx.trace = trace;
+        slots[i].verification.tiles = NULL;
+        slots[i].state = SLOT_IDLE;
+    }
+    struct verify_pool pool;
+    verify_pool_init(&pool, verify_threads);
+
+    test_log_begin_suite(log, "graphics");
+    test_log_printf(log, "Running graphics tests...\n\n");
+    test_log_flush(log);
+
+    // Tests take the slots in turn. Once a test is recorded the one before
+    // it, which the GPU had meanwhile, goes to the workers. A slot's test is
+    // reported right before the slot records the next one.
+    struct gfx_run run = {
+        .num_selected = num_selected,
+        .goldens = goldens,
+        .log = log,
+        .timing_log = timing_log,
+        .capture = capture,
+        .pool = &pool,
+    };
+    size_t num_started = 0;
+    bool is_running = true;
+    for (size_t i = 0; i < NUM_TESTS && is_running; ++i)
+    {
+        if (!selected[i])
+            continue;
+        struct pipeline_slot* const slot = &slots[num_started % depth];
+        is_running = finish_test(slot, &run);
+        if (!is_running)
+            break;
+        start_test(slot, i, num_started++);
+        if (num_started >= 2)
+            verify_test(&slots[(num_started - 2) % depth], &run);
+    }
+    // Oldest first
+    for (size_t i = 0; i < depth && is_running; ++i)
+        verify_test(&slots[(num_started + i) % depth], &run);
+    for (size_t i = 0; i < depth && is_running; ++i)
+        is_running = finish_test(&slots[(num_started + i) % depth], &run);
+
+    test_log_printf(log,
+        "\n%3d%% tests passed, %zd tests failed out of %zd\n\n",
+        (int)((run.num_run - run.failures) * 100 / (float)run.num_run),
+        run.failures, run.num_run);
+    test_log_flush(log);
+
+    // Tests still in flight after a stop are waited for, not reported
+    verify_pool_destroy(&pool);
+    for (size_t i = 0; i < depth; ++i)
+    {
+        free(slots[i].verification.tiles);
+        destroy_context(&slots[i].ctx);
+    }
+    shader_cache_destroy(&shader_cache);
+    if (gpu_timer)
+        gpu_timer_destroy(gpu_timer);
 }
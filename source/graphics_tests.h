@@ -1,7 +1,25 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdio.h>
 
 #include <deko3d.h>
 
-void run_graphics_tests(DkDevice device, DkQueue queue, bool automatic_mode);
\ No newline at end of file
+#include "capture.h"
+#include "cmd_trace.h"
+#include "goldens.h"
+#include "shader_pack.h"
+#include "test_filter.h"
+#include "test_log.h"
+
+// Tests in flight at once. At 2 the GPU runs a test while the one before is
+// verified and the next recorded, 1 runs them one at a time. Deeper
+// pipelines give the verification threads several results at once.
+#define MAX_PIPELINE_DEPTH 8
+#define DEFAULT_PIPELINE_DEPTH 4
+
+void run_graphics_tests(DkDevice device, DkQueue queue,
+	struct shader_pack const* pack, struct test_filter const* filter,
+	struct goldens* goldens, struct test_log* log, FILE* timing_log,
+	struct cmd_trace* trace, struct capture* capture, size_t pipeline_depth,
+	size_t verify_threads);
\ No newline at end of file
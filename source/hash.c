@@ -2,13 +2,16 @@
 #include <deko3d.h>
 
 #include "hash.h"
+#include "xxhash.h"
 
-u64 hash_memblock(DkMemBlock memblock)
+u64 hash_alloc(struct gpu_alloc const* alloc, size_t size)
 {
-    size_t size = (size_t)dkMemBlockGetSize(memblock);
-    uint64_t* data = dkMemBlockGetCpuAddr(memblock);
+    return xxh64(alloc->cpu_addr, size, 0);
+}
 
+u64 hash_alloc_legacy(struct gpu_alloc const* alloc)
+{
     u64 sha256[4];
-    sha256CalculateHash(&sha256, data, size);
+    sha256CalculateHash(&sha256, alloc->cpu_addr, alloc->size);
     return sha256[0] ^ sha256[1] ^ sha256[2] ^ sha256[3];
 }
@@ -3,4 +3,12 @@
 #include <switch.h>
 #include <deko3d.h>
 
-u64 hash_memblock(DkMemBlock memblock);
+#include "gpu_arena.h"
+
+// Hash of a test's result, covering only the first size bytes of the
+// allocation so the padding up to its alignment is left out
+u64 hash_alloc(struct gpu_alloc const* alloc, size_t size);
+
+// SHA-256 of the whole allocation folded to 64 bits, as the hashes built into
+// the graphics test table were made
+u64 hash_alloc_legacy(struct gpu_alloc const* alloc);
@@ -1,5 +1,6 @@
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 
@@ -33,3 +34,14 @@ DkMemBlock make_memory_block(DkDevice device, size_t size, uint32_t flags)
     maker.flags = flags;
     return dkMemBlockCreate(&maker);
 }
+
+void* checked_malloc(size_t size)
+{
+    void* const data = malloc(size);
+    if (!data)
+    {
+        printf("Out of memory! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+    return data;
+}
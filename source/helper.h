@@ -7,15 +7,20 @@
 
 #include <deko3d.h>
 
-#define DEFINE_ETEST(id)    \
-    void execute_test_##id( \
-        DkDevice device, DkQueue queue, DkCmdBuf cmdbuf, uint32_t* results)
+#include "compute_checks.h"
+#include "gpu_arena.h"
 
-#define DEFINE_MTEST(id) bool test_##id(uint32_t* results)
+// Memory comes from arenas, indexed by BLOCK_*, which are reset after the
+// test
+#define DEFINE_ETEST(id)                                                \
+    void execute_test_##id(DkDevice device, DkQueue queue,              \
+        DkCmdBuf cmdbuf, struct gpu_arena* arenas, uint32_t* results)
 
 #define DECLARE_ETEST(id) DEFINE_ETEST(id);
-#define DECLARE_MTEST(id) DEFINE_MTEST(id);
 
 void wait_for_input();
 
 DkMemBlock make_memory_block(DkDevice device, size_t size, uint32_t flags);
+
+// malloc that aborts when out of memory
+void* checked_malloc(size_t size);
@@ -1,5 +1,8 @@
+#include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <switch.h>
@@ -7,18 +10,32 @@
 
 #include <unistd.h>
 
+#include "capture.h"
+#include "cmd_trace.h"
 #include "compute_tests.h"
+#include "goldens.h"
 #include "graphics_tests.h"
 #include "helper.h"
+#include "shader_pack.h"
+#include "test_filter.h"
+#include "test_log.h"
+#include "verify_pool.h"
+
+// Exit codes of a headless run
+#define EXIT_ALL_PASSED 0
+#define EXIT_ABORTED 1 // EXIT_FAILURE, as used by aborts
+#define EXIT_TESTS_FAILED 2 // plus the number of failures, up to 255
+#define MAX_EXIT_CODE 255
+
+#define DEFAULT_RESULTS_PATH "sdmc:/gpu_test_results.txt"
 
 static int nxlink_socket = -1;
+static bool console_initialized = false;
 
 void userAppInit()
 {
     (void)nxlink_socket;
 
-    consoleInit(NULL);
-
     /*
     if (R_FAILED(socketInitializeDefault()))
         return;
@@ -31,7 +48,8 @@ void userAppInit()
 
 void userAppExit()
 {
-    consoleExit(NULL);
+    if (console_initialized)
+        consoleExit(NULL);
 
     /*
     if (nxlink_socket < 0)
@@ -43,19 +61,192 @@ void userAppExit()
     */
 }
 
+// Headless runs never wait on input
+static void wait_unless_headless(bool is_headless, char const* prompt)
+{
+    if (is_headless)
+        return;
+    printf("%s", prompt);
+    wait_for_input();
+}
+
+static FILE* open_output(char const* path, char const* what)
+{
+    if (!path)
+        return NULL;
+    FILE* const file = fopen(path, "w");
+    if (!file)
+        printf("Failed to open \"%s\", %s are not saved\n", path, what);
+    return file;
+}
+
+// Decimal number in [min, max], false when the argument is anything else
+static bool parse_number(
+    char const* arg, uint64_t min, uint64_t max, uint64_t* value)
+{
+    if (*arg < '0' || *arg > '9')
+        return false;
+    char* end;
+    errno = 0;
+    unsigned long long const number = strtoull(arg, &end, 10);
+    if (*end || errno == ERANGE || number < min || number > max)
+        return false;
+    *value = number;
+    return true;
+}
+
 int main(int argc, char **argv)
 {
-    // Init romfs before doing anything
+    bool is_automatic = false;
+    bool is_headless = false;
+    bool is_batched = true;
+    char const* timing_path = NULL;
+    char const* results_path = NULL;
+    char const* record_path = NULL;
+    char const* replay_path = NULL;
+    uint32_t replay_count = 1;
+    char const* goldens_path = NULL;
+    char const* update_goldens_path = NULL;
+    char const* invalid_arg = NULL;
+    uint32_t redraw_interval_ms = 500;
+    size_t max_failures = 0;
+    char const* capture_path = NULL;
+    bool is_capturing_all = false;
+    uint64_t capture_limit = CAPTURE_DEFAULT_LIMIT;
+    size_t pipeline_depth = DEFAULT_PIPELINE_DEPTH;
+    size_t verify_threads = verify_pool_default_workers();
+    struct test_filter filter;
+    test_filter_init(&filter);
+    for (int i = 1; i < argc; ++i)
+    {
+        enum test_filter_arg const filter_arg =
+            test_filter_parse_arg(&filter, argv[i]);
+        if (filter_arg == TEST_FILTER_ARG_INVALID && !invalid_arg)
+            invalid_arg = argv[i];
+        if (filter_arg != TEST_FILTER_ARG_UNKNOWN)
+            continue;
+
+        bool is_valid = true;
+        uint64_t number = 0;
+        if (0 == strcmp(argv[i], "--automatic"))
+            is_automatic = true;
+        else if (0 == strcmp(argv[i], "--headless"))
+            is_headless = true;
+        else if (0 == strcmp(argv[i], "--no-batch"))
+            is_batched = false;
+        else if (0 == strcmp(argv[i], "--timing") && i + 1 < argc)
+            timing_path = argv[++i];
+        else if (0 == strcmp(argv[i], "--results") && i + 1 < argc)
+            results_path = argv[++i];
+        else if (0 == strcmp(argv[i], "--redraw-interval") && i + 1 < argc)
+        {
+            is_valid = parse_number(argv[++i], 0, UINT32_MAX, &number);
+            redraw_interval_ms = number;
+        }
+        else if (0 == strcmp(argv[i], "--record") && i + 1 < argc)
+            record_path = argv[++i];
+        else if (0 == strcmp(argv[i], "--replay") && i + 1 < argc)
+            replay_path = argv[++i];
+        else if (0 == strcmp(argv[i], "--replay-count") && i + 1 < argc)
+        {
+            is_valid = parse_number(argv[++i], 1, UINT32_MAX, &number);
+            replay_count = number;
+        }
+        else if (0 == strcmp(argv[i], "--max-failures") && i + 1 < argc)
+        {
+            is_valid = parse_number(argv[++i], 1, SIZE_MAX, &number);
+            max_failures = number;
+        }
+        else if (0 == strcmp(argv[i], "--pipeline-depth") && i + 1 < argc)
+        {
+            is_valid =
+                parse_number(argv[++i], 1, MAX_PIPELINE_DEPTH, &number);
+            pipeline_depth = number;
+        }
+        else if (0 == strcmp(argv[i], "--verify-threads") && i + 1 < argc)
+        {
+            // 0 verifies on the main thread
+            is_valid =
+                parse_number(argv[++i], 0, MAX_VERIFY_WORKERS, &number);
+            verify_threads = number;
+        }
+        else if (0 == strcmp(argv[i], "--capture") && i + 1 < argc)
+            capture_path = argv[++i];
+        else if (0 == strcmp(argv[i], "--capture-all"))
+            is_capturing_all = true;
+        else if (0 == strcmp(argv[i], "--capture-limit") && i + 1 < argc)
+        {
+            // In MiB
+            is_valid = parse_number(argv[++i], 0, UINT64_MAX >> 20, &number);
+            capture_limit = number << 20;
+        }
+        else if (0 == strcmp(argv[i], "--goldens") && i + 1 < argc)
+            goldens_path = argv[++i];
+        else if (0 == strcmp(argv[i], "--update-goldens") && i + 1 < argc)
+            update_goldens_path = argv[++i];
+
+        if (!is_valid && !invalid_arg)
+            invalid_arg = argv[i];
+    }
+    if (is_headless && !results_path)
+        results_path = DEFAULT_RESULTS_PATH;
+
+    if (!is_headless)
+    {
+        consoleInit(NULL);
+        console_initialized = true;
+    }
+
+    if (invalid_arg)
+    {
+        printf("Invalid option \"%s\"! Aborting...\n", invalid_arg);
+        wait_unless_headless(is_headless, "");
+        return EXIT_ABORTED;
+    }
+
     Result rc = romfsInit();
     if (R_FAILED(rc))
         printf("romfsInit: %08X\n", rc);
 
-    // TODO: Do proper parsing
-    bool is_automatic = false;
-    if (argc > 1)
+    // Per-test timings as JSON lines
+    FILE* const timing_log = open_output(timing_path, "timings");
+    // Failed tests and the totals
+    FILE* const results = open_output(results_path, "results");
+    // What the graphics tests send, for --replay
+    struct cmd_trace trace;
+    struct cmd_trace* recording = NULL;
+    if (record_path && cmd_trace_open(&trace, record_path))
+        recording = &trace;
+    else if (record_path)
+        printf("Failed to open \"%s\", commands are not recorded\n",
+            record_path);
+
+    // Expected values overriding the built-in ones
+    struct goldens goldens;
+    goldens_init(&goldens, update_goldens_path != NULL);
+    if (goldens_path && !goldens_load(&goldens, goldens_path))
     {
-        if (0 == strcmp(argv[1], "--automatic"))
-            is_automatic = true;
+        printf("Failed to load goldens! Aborting...\n");
+        wait_unless_headless(is_headless, "");
+        return EXIT_ABORTED;
+    }
+
+    // Render targets of failed tests, or all with --capture-all
+    struct capture capture;
+    struct capture* capturing = NULL;
+    if (capture_path && capture_open(&capture, capture_path, capture_limit,
+            is_capturing_all))
+        capturing = &capture;
+    else if (capture_path)
+        printf("Failed to open \"%s\", images are not captured\n",
+            capture_path);
+
+    struct shader_pack pack;
+    if (!shader_pack_load(&pack, "romfs:/shaders.pack"))
+    {
+        printf("Failed to load shaders! Aborting...\n");
+        wait_unless_headless(is_headless, "");
+        return EXIT_ABORTED;
     }
 
     DkDeviceMaker device_mk;
@@ -67,19 +258,73 @@ int main(int argc, char **argv)
     queue_mk.perWarpScratchMemorySize = 8 * DK_PER_WARP_SCRATCH_MEM_ALIGNMENT;
     DkQueue queue = dkQueueCreate(&queue_mk);
 
-    run_graphics_tests(device, queue, is_automatic);
+    enum test_log_mode const log_mode = is_headless ? TEST_LOG_HEADLESS
+        : is_automatic ? TEST_LOG_AUTOMATIC : TEST_LOG_INTERACTIVE;
+    struct test_log log;
+    test_log_init(&log, log_mode, redraw_interval_ms, results);
+    log.max_failures = max_failures;
 
-    if (!is_automatic)
+    bool const run_graphics = !replay_path
+        && test_filter_has_suite(&filter, TEST_SUITE_GRAPHICS);
+    bool const run_compute = !replay_path
+        && test_filter_has_suite(&filter, TEST_SUITE_COMPUTE);
+    bool replay_failed = false;
+    if (replay_path)
     {
-        printf("Press A to continue...");
-        wait_for_input();
+        replay_failed = !replay_trace(device, queue, replay_path,
+            replay_count, &filter, &log, timing_log);
     }
 
-    run_compute_tests(device, queue, is_automatic);
+    if (run_graphics)
+    {
+        run_graphics_tests(device, queue, &pack, &filter, &goldens, &log,
+            timing_log, recording, capturing, pipeline_depth,
+            verify_threads);
+    }
 
-    printf("\nPress A to exit...");
-    wait_for_input();
+    // Past the failure budget the remaining suites don't run
+    bool const continue_compute =
+        run_compute && !test_log_budget_exceeded(&log);
+    if (run_graphics && continue_compute && !is_automatic)
+        wait_unless_headless(is_headless, "Press A to continue...");
+
+    if (continue_compute)
+    {
+        run_compute_tests(device, queue, &pack, &filter, &goldens, &log,
+            is_batched, timing_log);
+    }
+
+    test_log_write_totals(&log);
+    size_t const num_failed = log.num_failed;
+    test_log_free(&log);
+    if (results)
+        fclose(results);
+    if (timing_log)
+        fclose(timing_log);
+    if (recording)
+        cmd_trace_close(recording);
+    if (capturing && capturing->num_skipped)
+    {
+        printf("%zu images were not captured, the capture is full\n",
+            capturing->num_skipped);
+    }
+    if (capturing)
+        capture_close(capturing);
+    if (update_goldens_path)
+        goldens_write(&goldens, update_goldens_path);
+    goldens_free(&goldens);
+
+    wait_unless_headless(is_headless, "\nPress A to exit...");
 
     dkQueueDestroy(queue);
     dkDeviceDestroy(device);
-}
\ No newline at end of file
+
+    shader_pack_free(&pack);
+
+    if (replay_failed)
+        return EXIT_ABORTED;
+    if (num_failed == 0)
+        return EXIT_ALL_PASSED;
+    return num_failed > MAX_EXIT_CODE - EXIT_TESTS_FAILED
+        ? MAX_EXIT_CODE : EXIT_TESTS_FAILED + (int)num_failed;
+}
@@ -0,0 +1,116 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "name_table.h"
+
+#define FNV_PRIME 0x100000001b3ull
+
+uint64_t name_hash_append(uint64_t hash, char const* string)
+{
+    for (; *string; ++string)
+    {
+        hash ^= (uint8_t)*string;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t name_hash(char const* string)
+{
+    return name_hash_append(NAME_HASH_INIT, string);
+}
+
+void name_table_init(struct name_table* table)
+{
+    memset(table, 0, sizeof(*table));
+}
+
+void name_table_free(struct name_table* table)
+{
+    free(table->slots);
+    memset(table, 0, sizeof(*table));
+}
+
+static void* allocate(size_t size)
+{
+    void* const memory = malloc(size);
+    if (!memory)
+    {
+        printf("Out of memory! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+    return memory;
+}
+
+static void insert(struct name_table* table, uint64_t hash, size_t index)
+{
+    size_t const mask = table->num_slots - 1;
+    size_t slot = hash & mask;
+    while (table->slots[slot].index)
+        slot = (slot + 1) & mask;
+    table->slots[slot].hash = hash;
+    table->slots[slot].index = (uint32_t)(index + 1);
+}
+
+// Keeps the table at most half full. Entries go back in index order, so
+// probes still meet them in the order they were added.
+static void grow(struct name_table* table)
+{
+    struct name_table_slot* const old_slots = table->slots;
+    size_t const old_num_slots = table->num_slots;
+    uint64_t* const hashes =
+        allocate((table->num_entries + 1) * sizeof(*hashes));
+    for (size_t i = 0; i < old_num_slots; ++i)
+    {
+        if (old_slots[i].index)
+            hashes[old_slots[i].index - 1] = old_slots[i].hash;
+    }
+
+    table->num_slots = old_num_slots ? old_num_slots * 2 : 16;
+    size_t const size = table->num_slots * sizeof(*table->slots);
+    table->slots = allocate(size);
+    memset(table->slots, 0, size);
+    for (size_t i = 0; i < table->num_entries; ++i)
+        insert(table, hashes[i], i);
+    free(hashes);
+    free(old_slots);
+}
+
+size_t name_table_add(struct name_table* table, uint64_t hash)
+{
+    if ((table->num_entries + 1) * 2 > table->num_slots)
+        grow(table);
+    size_t const index = table->num_entries++;
+    insert(table, hash, index);
+    return index;
+}
+
+struct name_probe name_table_probe(
+    struct name_table const* table, uint64_t hash)
+{
+    size_t const mask = table->num_slots ? table->num_slots - 1 : 0;
+    return (struct name_probe){.hash = hash, .slot = hash & mask};
+}
+
+bool name_table_next(
+    struct name_table const* table, struct name_probe* probe, size_t* index)
+{
+    if (table->num_slots == 0)
+        return false;
+    size_t const mask = table->num_slots - 1;
+    for (; table->slots[probe->slot].index;
+         probe->slot = (probe->slot + 1) & mask)
+    {
+        struct name_table_slot const* const slot = &table->slots[probe->slot];
+        if (slot->hash != probe->hash)
+            continue;
+        *index = slot->index - 1;
+        probe->slot = (probe->slot + 1) & mask;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NAME_HASH_INIT 0xcbf29ce484222325ull
+
+// 64-bit FNV-1a of the string, continuing from hash. Shader packs, test
+// shards and the golden tables depend on its values, they must not change.
+uint64_t name_hash_append(uint64_t hash, char const* string);
+
+// name_hash_append from NAME_HASH_INIT
+uint64_t name_hash(char const* string);
+
+struct name_table_slot
+{
+    uint64_t hash;
+    // Index + 1, 0 when the slot is empty
+    uint32_t index;
+};
+
+// Open addressing with linear probing from hashes to the indices of the
+// owner's entries, numbered from 0 in the order they were added. The owner
+// compares the entries of a hash itself, they are probed in that order.
+struct name_table
+{
+    struct name_table_slot* slots;
+    size_t num_slots;
+    size_t num_entries;
+};
+
+struct name_probe
+{
+    uint64_t hash;
+    size_t slot;
+};
+
+void name_table_init(struct name_table* table);
+void name_table_free(struct name_table* table);
+
+// Returns the index of the new entry
+size_t name_table_add(struct name_table* table, uint64_t hash);
+
+// Starts a walk of the entries added with the hash
+struct name_probe name_table_probe(
+    struct name_table const* table, uint64_t hash);
+
+// The next entry of the walk, false when there are no more
+bool name_table_next(
+    struct name_table const* table, struct name_probe* probe, size_t* index);
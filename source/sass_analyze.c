@@ -0,0 +1,653 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sass_analyze.h"
+#include "sass_decode.h"
+
+#define MAX_READS 4
+
+struct reg_range
+{
+    int first;
+    int count;
+};
+
+// Registers read and written by one instruction, ranges starting at RZ are
+// ignored
+struct reg_usage
+{
+    struct reg_range write;
+    struct reg_range reads[MAX_READS];
+    int num_reads;
+};
+
+// Registers holding a value known at this point of straight-line code
+struct constants
+{
+    bool known[SASS_REG_RZ];
+    uint32_t values[SASS_REG_RZ];
+};
+
+struct memory_extent
+{
+    uint64_t size;
+    bool dynamic;
+};
+
+static uint64_t read_insn(uint8_t const* code, size_t index)
+{
+    uint64_t insn;
+    memcpy(&insn, code + index * sizeof(insn), sizeof(insn));
+    return insn;
+}
+
+static int access_words(int size)
+{
+    static int const words[] = {1, 1, 1, 1, 1, 2, 4, 4};
+    return words[size & 7];
+}
+
+static uint32_t access_bytes(int size)
+{
+    static uint32_t const bytes[] = {1, 1, 2, 2, 4, 8, 16, 16};
+    return bytes[size & 7];
+}
+
+// ATOM and RED sizes U64 and S64
+static int atom_words(int size)
+{
+    return size == 2 || size == 5 ? 2 : 1;
+}
+
+static void add_read(struct reg_usage* use, int first, int count)
+{
+    use->reads[use->num_reads++] = (struct reg_range){first, count};
+}
+
+static void get_registers(
+    enum sass_opcode op, uint64_t insn, struct reg_usage* use)
+{
+    int const d = sass_dest(insn);
+    int const a = sass_src_a(insn);
+    int const b = sass_src_b(insn);
+    int const c = sass_src_c(insn);
+
+    use->write = (struct reg_range){d, 1};
+    use->num_reads = 0;
+
+    switch (op)
+    {
+    case SASS_OP_BRA:
+    case SASS_OP_BRK:
+    case SASS_OP_CAL:
+    case SASS_OP_CONT:
+    case SASS_OP_DEPBAR:
+    case SASS_OP_EXIT:
+    case SASS_OP_MEMBAR:
+    case SASS_OP_NOP:
+    case SASS_OP_PBK:
+    case SASS_OP_PSETP:
+    case SASS_OP_RET:
+    case SASS_OP_SSY:
+    case SASS_OP_SYNC:
+        use->write.count = 0;
+        break;
+
+    case SASS_OP_BRX:
+        use->write.count = 0;
+        add_read(use, a, 1);
+        break;
+
+    case SASS_OP_BAR:
+        use->write.count = 0;
+        if (!sass_bits(insn, 43, 1))
+            add_read(use, a, 1);
+        if (!sass_bits(insn, 44, 1))
+            add_read(use, b, 1);
+        break;
+
+    case SASS_OP_MOV32I:
+    case SASS_OP_S2R:
+    case SASS_OP_MOV_CBUF:
+    case SASS_OP_MOV_IMM:
+    case SASS_OP_I2I_CBUF:
+    case SASS_OP_I2I_IMM:
+    case SASS_OP_I2F_CBUF:
+    case SASS_OP_I2F_IMM:
+    case SASS_OP_F2I_CBUF:
+    case SASS_OP_F2I_IMM:
+    case SASS_OP_F2F_CBUF:
+    case SASS_OP_F2F_IMM:
+    case SASS_OP_FLO_CBUF:
+    case SASS_OP_FLO_IMM:
+    case SASS_OP_POPC_CBUF:
+    case SASS_OP_POPC_IMM:
+        break;
+
+    case SASS_OP_MOV_REG:
+    case SASS_OP_I2I_REG:
+    case SASS_OP_I2F_REG:
+    case SASS_OP_F2I_REG:
+    case SASS_OP_F2F_REG:
+    case SASS_OP_FLO_REG:
+    case SASS_OP_POPC_REG:
+        add_read(use, b, 1);
+        break;
+
+    case SASS_OP_IADD32I:
+    case SASS_OP_IADD_CBUF:
+    case SASS_OP_IADD_IMM:
+    case SASS_OP_ISCADD_CBUF:
+    case SASS_OP_ISCADD_IMM:
+    case SASS_OP_SHL_IMM:
+    case SASS_OP_SHR_CBUF:
+    case SASS_OP_SHR_IMM:
+    case SASS_OP_BFE_CBUF:
+    case SASS_OP_BFE_IMM:
+    case SASS_OP_FADD_CBUF:
+    case SASS_OP_FADD_IMM:
+    case SASS_OP_P2R_IMM:
+        add_read(use, a, 1);
+        break;
+
+    case SASS_OP_IADD_REG:
+    case SASS_OP_ISCADD_REG:
+    case SASS_OP_LEA_LO_REG:
+    case SASS_OP_SHL_REG:
+    case SASS_OP_SHR_REG:
+    case SASS_OP_BFE_REG:
+    case SASS_OP_FADD_REG:
+    case SASS_OP_FMUL_REG:
+    case SASS_OP_LOP_REG:
+    case SASS_OP_HADD2_REG:
+    case SASS_OP_HMUL2_REG:
+    case SASS_OP_HSET2_REG:
+    case SASS_OP_P2R_REG:
+        add_read(use, a, 1);
+        add_read(use, b, 1);
+        break;
+
+    case SASS_OP_FFMA_REG:
+    case SASS_OP_LOP3_REG:
+    case SASS_OP_BFI_REG:
+    case SASS_OP_FCMP_REG:
+    case SASS_OP_LEA_HI_REG:
+    case SASS_OP_XMAD_REG:
+    case SASS_OP_SHF_L_REG:
+    case SASS_OP_SHF_R_REG:
+    case SASS_OP_HFMA2_REG:
+        add_read(use, a, 1);
+        add_read(use, b, 1);
+        add_read(use, c, 1);
+        break;
+
+    case SASS_OP_SHF_L_IMM:
+    case SASS_OP_SHF_R_IMM:
+    case SASS_OP_XMAD_IMM:
+        add_read(use, a, 1);
+        add_read(use, c, 1);
+        break;
+
+    case SASS_OP_FSETP_REG:
+    case SASS_OP_HSETP2_REG:
+    case SASS_OP_R2P_REG:
+        use->write.count = 0;
+        add_read(use, a, 1);
+        add_read(use, b, 1);
+        break;
+
+    case SASS_OP_FSETP_CBUF:
+    case SASS_OP_FSETP_IMM:
+    case SASS_OP_R2P_IMM:
+        use->write.count = 0;
+        add_read(use, a, 1);
+        break;
+
+    case SASS_OP_VMNMX:
+        add_read(use, a, 1);
+        add_read(use, c, 1);
+        if (sass_bits(insn, 50, 1))
+            add_read(use, b, 1);
+        break;
+
+    case SASS_OP_SHFL:
+        add_read(use, a, 1);
+        if (!sass_bits(insn, 28, 1))
+            add_read(use, b, 1);
+        if (!sass_bits(insn, 29, 1))
+            add_read(use, c, 1);
+        break;
+
+    case SASS_OP_LDC:
+        add_read(use, a, 1);
+        use->write.count = access_words((int)sass_bits(insn, 48, 3));
+        break;
+
+    case SASS_OP_LDG:
+    case SASS_OP_STG:
+        add_read(use, a, sass_bits(insn, 45, 1) ? 2 : 1);
+        use->write.count = access_words((int)sass_bits(insn, 48, 3));
+        if (op == SASS_OP_STG)
+        {
+            add_read(use, d, use->write.count);
+            use->write.count = 0;
+        }
+        break;
+
+    case SASS_OP_LDL:
+    case SASS_OP_LDS:
+    case SASS_OP_STL:
+    case SASS_OP_STS:
+        add_read(use, a, 1);
+        use->write.count = access_words((int)sass_bits(insn, 48, 3));
+        if (op == SASS_OP_STL || op == SASS_OP_STS)
+        {
+            add_read(use, d, use->write.count);
+            use->write.count = 0;
+        }
+        break;
+
+    case SASS_OP_ATOMS:
+        add_read(use, a, 1);
+        add_read(use, b, 1);
+        break;
+
+    case SASS_OP_ATOM:
+        add_read(use, a, sass_bits(insn, 48, 1) ? 2 : 1);
+        use->write.count = atom_words((int)sass_bits(insn, 49, 3));
+        add_read(use, b, use->write.count);
+        break;
+
+    case SASS_OP_RED:
+        use->write.count = 0;
+        add_read(use, a, sass_bits(insn, 48, 1) ? 2 : 1);
+        add_read(use, d, atom_words((int)sass_bits(insn, 20, 3)));
+        break;
+
+    // Compare and swap sizes are not decoded, assume the 64-bit forms
+    case SASS_OP_ATOM_CAS:
+    case SASS_OP_ATOMS_CAS:
+        add_read(use, a, 2);
+        add_read(use, b, 4);
+        use->write.count = 2;
+        break;
+
+    // Surface formats and dimensions are not decoded, assume four components
+    // and three coordinates. The handle is a register unless bit 52 is set.
+    case SASS_OP_SULD:
+    case SASS_OP_SUST:
+        add_read(use, a, 3);
+        if (!sass_bits(insn, 52, 1))
+            add_read(use, c, 1);
+        use->write.count = 4;
+        if (op == SASS_OP_SUST)
+        {
+            add_read(use, d, 4);
+            use->write.count = 0;
+        }
+        break;
+
+    // Unknown instructions might use every register field
+    default:
+        add_read(use, a, 1);
+        add_read(use, b, 1);
+        add_read(use, c, 1);
+        break;
+    }
+}
+
+static int highest_register(struct reg_range range)
+{
+    if (range.count == 0 || range.first == SASS_REG_RZ)
+        return -1;
+    int const last = range.first + range.count - 1;
+    return last < SASS_MAX_GPRS ? last : SASS_MAX_GPRS - 1;
+}
+
+static bool constant_value(
+    struct constants const* constants, int reg, uint32_t* value)
+{
+    if (reg == SASS_REG_RZ)
+    {
+        *value = 0;
+        return true;
+    }
+    *value = constants->values[reg];
+    return constants->known[reg];
+}
+
+static void forget_constants(struct constants* constants)
+{
+    memset(constants->known, 0, sizeof(constants->known));
+}
+
+// Follows the few ways tests materialize addresses: moves of immediates and
+// additions of an immediate to a known register
+static void update_constants(struct constants* constants,
+    enum sass_opcode op, uint64_t insn, struct reg_usage const* use)
+{
+    uint32_t value = 0;
+    bool known = false;
+    switch (op)
+    {
+    case SASS_OP_MOV32I:
+        value = sass_imm32(insn);
+        known = true;
+        break;
+
+    case SASS_OP_MOV_IMM:
+        value = sass_imm20(insn);
+        known = true;
+        break;
+
+    case SASS_OP_MOV_REG:
+        known = constant_value(constants, sass_src_b(insn), &value);
+        break;
+
+    case SASS_OP_IADD32I:
+        // No negation, carry, saturation or condition codes
+        if (sass_bits(insn, 52, 5) == 0)
+        {
+            known = constant_value(constants, sass_src_a(insn), &value);
+            value += sass_imm32(insn);
+        }
+        break;
+
+    case SASS_OP_IADD_IMM:
+        if (!sass_bits(insn, 43, 1) && !sass_bits(insn, 48, 3))
+        {
+            known = constant_value(constants, sass_src_a(insn), &value);
+            value += sass_imm20(insn);
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    struct reg_range const write = use->write;
+    for (int i = 0; i < write.count && write.first != SASS_REG_RZ; ++i)
+    {
+        if (write.first + i < SASS_REG_RZ)
+            constants->known[write.first + i] = false;
+    }
+
+    bool const unconditional =
+        sass_guard(insn) == SASS_PRED_PT && !sass_guard_negated(insn);
+    if (known && unconditional && write.count == 1
+        && write.first != SASS_REG_RZ)
+    {
+        constants->known[write.first] = true;
+        constants->values[write.first] = value;
+    }
+}
+
+static void add_access(struct memory_extent* extent,
+    struct constants const* constants, int reg, int64_t offset,
+    uint32_t bytes)
+{
+    uint32_t base;
+    if (!constant_value(constants, reg, &base))
+    {
+        extent->dynamic = true;
+        return;
+    }
+    uint64_t const end = (uint64_t)(uint32_t)(base + (uint32_t)offset) + bytes;
+    if (end > extent->size)
+        extent->size = end;
+}
+
+static uint32_t memory_size(
+    struct memory_extent const* extent, uint32_t declared_size)
+{
+    uint64_t size = extent->size;
+    if (extent->dynamic && declared_size > size)
+        size = declared_size;
+    return size > UINT32_MAX ? UINT32_MAX : (uint32_t)size;
+}
+
+static bool is_branch(enum sass_opcode op)
+{
+    return op == SASS_OP_BRA || op == SASS_OP_SSY || op == SASS_OP_PBK
+        || op == SASS_OP_CAL;
+}
+
+// Returns the qword index a branch lands on, or num_insns if it is invalid
+static size_t branch_index(uint64_t insn, size_t index, size_t num_insns)
+{
+    int64_t const offset = sass_branch_target(insn, index);
+    if (offset < 0 || offset % 8 != 0 || (size_t)offset / 8 >= num_insns
+        || sass_is_sched((size_t)offset / 8))
+    {
+        return num_insns;
+    }
+    return (size_t)offset / 8;
+}
+
+static bool is_conditional(uint64_t insn)
+{
+    return sass_guard(insn) != SASS_PRED_PT || sass_guard_negated(insn)
+        || sass_bits(insn, 0, 5) != SASS_FLOW_T;
+}
+
+struct crs_walk
+{
+    size_t num_insns;
+    int* depths;
+    bool* queued;
+    size_t* pending;
+    size_t num_pending;
+    int max_depth;
+};
+
+static void visit(struct crs_walk* walk, size_t index, int depth)
+{
+    if (index >= walk->num_insns)
+        return;
+    if (depth > SASS_MAX_CRS_DEPTH)
+        depth = SASS_MAX_CRS_DEPTH;
+    if (depth > walk->max_depth)
+        walk->max_depth = depth;
+    // Whatever is reachable from here is reached deeper from a deeper entry
+    if (depth <= walk->depths[index])
+        return;
+    walk->depths[index] = depth;
+    if (!walk->queued[index])
+    {
+        walk->queued[index] = true;
+        walk->pending[walk->num_pending++] = index;
+    }
+}
+
+// Walks the control flow graph tracking how many tokens are on the
+// reconvergence stack. A token's continuation runs with the stack as it was
+// when the token was pushed, so paths end at SYNC, BRK, RET and EXIT.
+static bool measure_crs_depth(
+    uint8_t const* code, size_t num_insns, int* crs_depth)
+{
+    struct crs_walk walk = {.num_insns = num_insns};
+    walk.depths = malloc(num_insns * sizeof(int) + 1);
+    walk.queued = calloc(num_insns + 1, sizeof(bool));
+    walk.pending = malloc(num_insns * sizeof(size_t) + 1);
+    if (!walk.depths || !walk.queued || !walk.pending)
+    {
+        free(walk.pending);
+        free(walk.queued);
+        free(walk.depths);
+        return false;
+    }
+    for (size_t i = 0; i < num_insns; ++i)
+        walk.depths[i] = -1;
+
+    visit(&walk, 1, 0);
+    while (walk.num_pending > 0)
+    {
+        size_t const index = walk.pending[--walk.num_pending];
+        int const depth = walk.depths[index];
+        walk.queued[index] = false;
+
+        if (sass_is_sched(index))
+        {
+            visit(&walk, index + 1, depth);
+            continue;
+        }
+
+        uint64_t const insn = read_insn(code, index);
+        enum sass_opcode const op = sass_decode(insn);
+        size_t const target =
+            is_branch(op) ? branch_index(insn, index, num_insns) : num_insns;
+        switch (op)
+        {
+        case SASS_OP_SSY:
+        case SASS_OP_PBK:
+            visit(&walk, target, depth);
+            visit(&walk, index + 1, depth + 1);
+            break;
+
+        case SASS_OP_CAL:
+            visit(&walk, target, depth + 1);
+            visit(&walk, index + 1, depth);
+            break;
+
+        case SASS_OP_BRA:
+            // Diverging lanes wait in a token while the others run ahead
+            if (is_conditional(insn))
+            {
+                visit(&walk, target, depth);
+                visit(&walk, index + 1, depth + 1);
+            }
+            else
+            {
+                visit(&walk, target, depth);
+            }
+            break;
+
+        case SASS_OP_SYNC:
+        case SASS_OP_BRK:
+        case SASS_OP_RET:
+        case SASS_OP_EXIT:
+        case SASS_OP_CONT:
+            if (is_conditional(insn))
+                visit(&walk, index + 1, depth);
+            break;
+
+        // Indirect branches may land anywhere
+        case SASS_OP_BRX:
+            walk.max_depth = SASS_MAX_CRS_DEPTH;
+            break;
+
+        default:
+            visit(&walk, index + 1, depth);
+            break;
+        }
+    }
+
+    *crs_depth = walk.max_depth;
+    free(walk.pending);
+    free(walk.queued);
+    free(walk.depths);
+    return true;
+}
+
+bool sass_analyze(uint8_t const* code, size_t code_size,
+    uint32_t declared_local_mem_size, uint32_t declared_shared_mem_size,
+    struct sass_resources* resources)
+{
+    size_t const num_insns = code_size / sizeof(uint64_t);
+    bool* const is_target = calloc(num_insns + 1, sizeof(bool));
+    if (!is_target)
+        return false;
+
+    for (size_t i = 0; i < num_insns; ++i)
+    {
+        if (sass_is_sched(i))
+            continue;
+        uint64_t const insn = read_insn(code, i);
+        enum sass_opcode const op = sass_decode(insn);
+        if (is_branch(op))
+            is_target[branch_index(insn, i, num_insns)] = true;
+        // Returning calls see whatever the callee left in registers
+        if (op == SASS_OP_CAL)
+            is_target[i + 1] = true;
+    }
+
+    struct constants constants;
+    struct memory_extent local = {0};
+    struct memory_extent shared = {0};
+    int highest = -1;
+    int num_barriers = 0;
+
+    forget_constants(&constants);
+    for (size_t i = 0; i < num_insns; ++i)
+    {
+        if (sass_is_sched(i))
+            continue;
+        if (is_target[i])
+            forget_constants(&constants);
+
+        uint64_t const insn = read_insn(code, i);
+        enum sass_opcode const op = sass_decode(insn);
+        struct reg_usage use;
+        get_registers(op, insn, &use);
+
+        if (highest_register(use.write) > highest)
+            highest = highest_register(use.write);
+        for (int j = 0; j < use.num_reads; ++j)
+        {
+            if (highest_register(use.reads[j]) > highest)
+                highest = highest_register(use.reads[j]);
+        }
+
+        switch (op)
+        {
+        case SASS_OP_LDL:
+        case SASS_OP_STL:
+            add_access(&local, &constants, sass_src_a(insn),
+                sass_sbits(insn, 20, 24),
+                access_bytes((int)sass_bits(insn, 48, 3)));
+            break;
+
+        case SASS_OP_LDS:
+        case SASS_OP_STS:
+            add_access(&shared, &constants, sass_src_a(insn),
+                sass_sbits(insn, 20, 24),
+                access_bytes((int)sass_bits(insn, 48, 3)));
+            break;
+
+        case SASS_OP_ATOMS:
+            add_access(&shared, &constants, sass_src_a(insn),
+                sass_sbits(insn, 30, 22) * 4,
+                sass_bits(insn, 29, 1) ? 8 : 4);
+            break;
+
+        case SASS_OP_ATOMS_CAS:
+            shared.dynamic = true;
+            break;
+
+        case SASS_OP_BAR:
+            if (!sass_bits(insn, 43, 1))
+                num_barriers = SASS_MAX_BARRIERS;
+            else if ((int)sass_bits(insn, 8, 8) + 1 > num_barriers)
+                num_barriers = (int)sass_bits(insn, 8, 8) + 1;
+            break;
+
+        default:
+            break;
+        }
+
+        update_constants(&constants, op, insn, &use);
+    }
+    free(is_target);
+
+    resources->num_gprs = highest + 1 < SASS_MIN_GPRS ? SASS_MIN_GPRS
+                                                      : highest + 1;
+    resources->local_mem_size = memory_size(&local, declared_local_mem_size);
+    resources->shared_mem_size =
+        memory_size(&shared, declared_shared_mem_size);
+    resources->num_barriers =
+        num_barriers > SASS_MAX_BARRIERS ? SASS_MAX_BARRIERS : num_barriers;
+    return measure_crs_depth(code, num_insns, &resources->crs_depth);
+}
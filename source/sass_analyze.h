@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Register allocations are never smaller than this
+#define SASS_MIN_GPRS 4
+#define SASS_MAX_GPRS 255
+#define SASS_MAX_BARRIERS 16
+// Deepest reconvergence stack the analysis follows, deeper programs are
+// reported at this depth
+#define SASS_MAX_CRS_DEPTH 32
+
+// Resources a compute program needs to run
+struct sass_resources
+{
+    int num_gprs;
+    uint32_t local_mem_size;
+    uint32_t shared_mem_size;
+    int num_barriers;
+    // Deepest nesting of SSY, PBK, CAL and divergent branch tokens
+    int crs_depth;
+};
+
+// Scans a program for its register high-water mark, memory extents, barriers
+// and reconvergence stack depth. Local and shared memory accessed through a
+// register whose value is not known statically is bounded by the declared
+// sizes instead. Returns false if out of memory.
+bool sass_analyze(uint8_t const* code, size_t code_size,
+    uint32_t declared_local_mem_size, uint32_t declared_shared_mem_size,
+    struct sass_resources* resources);
@@ -0,0 +1,93 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sass_decode.h"
+
+struct opcode_entry
+{
+    char const* name;
+    char const* pattern;
+};
+
+static struct opcode_entry const opcode_table[] =
+{
+    { "INVALID", NULL },
+#define SASS_OPCODE_ENTRY(id, name, pattern) { name, pattern },
+    SASS_OPCODES(SASS_OPCODE_ENTRY)
+#undef SASS_OPCODE_ENTRY
+};
+
+static int match_pattern(char const* pattern, uint16_t top)
+{
+    int fixed_bits = 0;
+    int bit = 15;
+    for (char const* c = pattern; *c; ++c)
+    {
+        if (*c == ' ')
+            continue;
+        if (*c != '-')
+        {
+            if (((top >> bit) & 1) != (uint16_t)(*c - '0'))
+                return -1;
+            ++fixed_bits;
+        }
+        --bit;
+    }
+    return fixed_bits;
+}
+
+enum sass_opcode sass_decode(uint64_t insn)
+{
+    uint16_t const top = (uint16_t)(insn >> 48);
+
+    // Patterns overlap, the most specific match wins
+    enum sass_opcode best = SASS_OP_INVALID;
+    int best_fixed_bits = -1;
+    for (int op = 1; op < SASS_NUM_OPCODES; ++op)
+    {
+        int const fixed_bits = match_pattern(opcode_table[op].pattern, top);
+        if (fixed_bits > best_fixed_bits)
+        {
+            best = (enum sass_opcode)op;
+            best_fixed_bits = fixed_bits;
+        }
+    }
+    return best;
+}
+
+char const* sass_opcode_name(enum sass_opcode op)
+{
+    if ((int)op < 0 || op >= SASS_NUM_OPCODES)
+        return opcode_table[0].name;
+    return opcode_table[op].name;
+}
+
+bool sass_apply_patches(uint8_t* code, size_t code_size,
+    struct sass_patch const* patches, size_t num_patches)
+{
+    for (size_t i = 0; i < num_patches; ++i)
+    {
+        struct sass_patch const* patch = &patches[i];
+        if (patch->count == 0)
+            continue;
+
+        size_t const offset =
+            sass_insn_position(patch->insn) * sizeof(uint64_t);
+        if (offset + sizeof(uint64_t) > code_size || patch->count > 32
+            || patch->offset + patch->count > 64
+            || (patch->count < 32 && patch->value >> patch->count))
+        {
+            return false;
+        }
+
+        uint64_t const mask =
+            ((UINT64_C(1) << patch->count) - 1) << patch->offset;
+        uint64_t insn;
+        memcpy(&insn, code + offset, sizeof(insn));
+        insn = (insn & ~mask) | ((uint64_t)patch->value << patch->offset);
+        memcpy(code + offset, &insn, sizeof(insn));
+    }
+    return true;
+}
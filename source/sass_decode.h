@@ -0,0 +1,247 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Maxwell code is laid out in bundles of four qwords: one scheduling control
+// word followed by three instructions.
+#define SASS_BUNDLE_SIZE 4
+
+#define SASS_REG_RZ 255
+#define SASS_PRED_PT 7
+
+// Replaces count bits at offset of one instruction, insn counting instructions
+// only.
+struct sass_patch
+{
+    uint16_t insn;
+    uint8_t offset;
+    uint8_t count;
+    uint32_t value;
+};
+
+// Opcode encodings, matched against the 16 most significant bits of an
+// instruction. '-' bits are ignored.
+#define SASS_OPCODES(X)                                                        \
+    X(ATOM_CAS,    "ATOM.CAS",    "1110 1110 1111 ----")                       \
+    X(ATOM,        "ATOM",        "1110 1101 ---- ----")                       \
+    X(ATOMS_CAS,   "ATOMS.CAS",   "1110 1110 ---- ----")                       \
+    X(ATOMS,       "ATOMS",       "1110 1100 ---- ----")                       \
+    X(BAR,         "BAR",         "1111 0000 1010 1---")                       \
+    X(BFE_REG,     "BFE",         "0101 1100 0000 0---")                       \
+    X(BFE_CBUF,    "BFE",         "0100 1100 0000 0---")                       \
+    X(BFE_IMM,     "BFE",         "0011 100- 0000 0---")                       \
+    X(BFI_REG,     "BFI",         "0101 1011 1111 0---")                       \
+    X(BRA,         "BRA",         "1110 0010 0100 ----")                       \
+    X(BRK,         "BRK",         "1110 0011 0100 ----")                       \
+    X(BRX,         "BRX",         "1110 0010 0101 ----")                       \
+    X(CAL,         "CAL",         "1110 0010 0110 ----")                       \
+    X(CONT,        "CONT",        "1110 0011 0101 ----")                       \
+    X(DEPBAR,      "DEPBAR",      "1111 0000 1111 0---")                       \
+    X(EXIT,        "EXIT",        "1110 0011 0000 ----")                       \
+    X(F2F_REG,     "F2F",         "0101 1100 1010 1---")                       \
+    X(F2F_CBUF,    "F2F",         "0100 1100 1010 1---")                       \
+    X(F2F_IMM,     "F2F",         "0011 100- 1010 1---")                       \
+    X(F2I_REG,     "F2I",         "0101 1100 1011 0---")                       \
+    X(F2I_CBUF,    "F2I",         "0100 1100 1011 0---")                       \
+    X(F2I_IMM,     "F2I",         "0011 100- 1011 0---")                       \
+    X(FADD_REG,    "FADD",        "0101 1100 0101 1---")                       \
+    X(FADD_CBUF,   "FADD",        "0100 1100 0101 1---")                       \
+    X(FADD_IMM,    "FADD",        "0011 100- 0101 1---")                       \
+    X(FCMP_REG,    "FCMP",        "0101 1011 1010 ----")                       \
+    X(FFMA_REG,    "FFMA",        "0101 1001 1--- ----")                       \
+    X(FLO_REG,     "FLO",         "0101 1100 0011 0---")                       \
+    X(FLO_CBUF,    "FLO",         "0100 1100 0011 0---")                       \
+    X(FLO_IMM,     "FLO",         "0011 100- 0011 0---")                       \
+    X(FMUL_REG,    "FMUL",        "0101 1100 0110 1---")                       \
+    X(FSETP_REG,   "FSETP",       "0101 1011 1011 ----")                       \
+    X(FSETP_CBUF,  "FSETP",       "0100 1011 1011 ----")                       \
+    X(FSETP_IMM,   "FSETP",       "0011 011- 1011 ----")                       \
+    X(HADD2_REG,   "HADD2",       "0101 1101 0001 0---")                       \
+    X(HFMA2_REG,   "HFMA2",       "0101 1101 0000 0---")                       \
+    X(HMUL2_REG,   "HMUL2",       "0101 1101 0000 1---")                       \
+    X(HSET2_REG,   "HSET2",       "0101 1101 0001 1---")                       \
+    X(HSETP2_REG,  "HSETP2",      "0101 1101 0010 0---")                       \
+    X(I2F_REG,     "I2F",         "0101 1100 1011 1---")                       \
+    X(I2F_CBUF,    "I2F",         "0100 1100 1011 1---")                       \
+    X(I2F_IMM,     "I2F",         "0011 100- 1011 1---")                       \
+    X(I2I_REG,     "I2I",         "0101 1100 1110 0---")                       \
+    X(I2I_CBUF,    "I2I",         "0100 1100 1110 0---")                       \
+    X(I2I_IMM,     "I2I",         "0011 100- 1110 0---")                       \
+    X(IADD_REG,    "IADD",        "0101 1100 0001 0---")                       \
+    X(IADD_CBUF,   "IADD",        "0100 1100 0001 0---")                       \
+    X(IADD_IMM,    "IADD",        "0011 100- 0001 0---")                       \
+    X(IADD32I,     "IADD32I",     "0001 110- ---- ----")                       \
+    X(ISCADD_REG,  "ISCADD",      "0101 1100 0001 1---")                       \
+    X(ISCADD_CBUF, "ISCADD",      "0100 1100 0001 1---")                       \
+    X(ISCADD_IMM,  "ISCADD",      "0011 100- 0001 1---")                       \
+    X(LDC,         "LDC",         "1110 1111 1001 0---")                       \
+    X(LDG,         "LDG",         "1110 1110 1101 0---")                       \
+    X(LDL,         "LDL",         "1110 1111 0100 0---")                       \
+    X(LDS,         "LDS",         "1110 1111 0100 1---")                       \
+    X(LEA_HI_REG,  "LEA.HI",      "0101 1011 1101 1---")                       \
+    X(LEA_LO_REG,  "LEA",         "0101 1011 1101 0---")                       \
+    X(LOP_REG,     "LOP",         "0101 1100 0100 0---")                       \
+    X(LOP3_REG,    "LOP3",        "0101 1011 1110 0---")                       \
+    X(MEMBAR,      "MEMBAR",      "1110 1111 1001 1---")                       \
+    X(MOV_REG,     "MOV",         "0101 1100 1001 1---")                       \
+    X(MOV_CBUF,    "MOV",         "0100 1100 1001 1---")                       \
+    X(MOV_IMM,     "MOV",         "0011 100- 1001 1---")                       \
+    X(MOV32I,      "MOV32I",      "0000 0001 0000 ----")                       \
+    X(NOP,         "NOP",         "0101 0000 1011 0---")                       \
+    X(P2R_REG,     "P2R",         "0101 1100 1110 1---")                       \
+    X(P2R_IMM,     "P2R",         "0011 1000 1110 1---")                       \
+    X(PBK,         "PBK",         "1110 0010 1010 ----")                       \
+    X(POPC_REG,    "POPC",        "0101 1100 0000 1---")                       \
+    X(POPC_CBUF,   "POPC",        "0100 1100 0000 1---")                       \
+    X(POPC_IMM,    "POPC",        "0011 100- 0000 1---")                       \
+    X(PSETP,       "PSETP",       "0101 0000 1001 0---")                       \
+    X(R2P_REG,     "R2P",         "0101 1100 1111 0---")                       \
+    X(R2P_IMM,     "R2P",         "0011 100- 1111 0---")                       \
+    X(RED,         "RED",         "1110 1011 1111 1---")                       \
+    X(RET,         "RET",         "1110 0011 0010 ----")                       \
+    X(S2R,         "S2R",         "1111 0000 1100 1---")                       \
+    X(SHF_L_REG,   "SHF.L",       "0101 1011 1111 1---")                       \
+    X(SHF_L_IMM,   "SHF.L",       "0011 011- 1111 1---")                       \
+    X(SHF_R_REG,   "SHF.R",       "0101 1100 1111 1---")                       \
+    X(SHF_R_IMM,   "SHF.R",       "0011 100- 1111 1---")                       \
+    X(SHFL,        "SHFL",        "1110 1111 0001 0---")                       \
+    X(SHL_REG,     "SHL",         "0101 1100 0100 1---")                       \
+    X(SHL_IMM,     "SHL",         "0011 100- 0100 1---")                       \
+    X(SHR_REG,     "SHR",         "0101 1100 0010 1---")                       \
+    X(SHR_CBUF,    "SHR",         "0100 1100 0010 1---")                       \
+    X(SHR_IMM,     "SHR",         "0011 100- 0010 1---")                       \
+    X(SSY,         "SSY",         "1110 0010 1001 ----")                       \
+    X(STG,         "STG",         "1110 1110 1101 1---")                       \
+    X(STL,         "STL",         "1110 1111 0101 0---")                       \
+    X(STS,         "STS",         "1110 1111 0101 1---")                       \
+    X(SULD,        "SULD",        "1110 1011 000- ----")                       \
+    X(SUST,        "SUST",        "1110 1011 001- ----")                       \
+    X(SYNC,        "SYNC",        "1111 0000 1111 1---")                       \
+    X(VMNMX,       "VMNMX",       "0011 101- ---- ----")                       \
+    X(XMAD_REG,    "XMAD",        "0101 1011 00-- ----")                       \
+    X(XMAD_IMM,    "XMAD",        "0011 011- 00-- ----")
+
+enum sass_opcode
+{
+    SASS_OP_INVALID,
+#define SASS_OPCODE_ENUM(id, name, pattern) SASS_OP_##id,
+    SASS_OPCODES(SASS_OPCODE_ENUM)
+#undef SASS_OPCODE_ENUM
+    SASS_NUM_OPCODES
+};
+
+// Condition codes tested by flow control instructions
+enum sass_flow_test
+{
+    SASS_FLOW_F, SASS_FLOW_LT, SASS_FLOW_EQ, SASS_FLOW_LE, SASS_FLOW_GT,
+    SASS_FLOW_NE, SASS_FLOW_GE, SASS_FLOW_NUM, SASS_FLOW_NAN, SASS_FLOW_LTU,
+    SASS_FLOW_EQU, SASS_FLOW_LEU, SASS_FLOW_GTU, SASS_FLOW_NEU,
+    SASS_FLOW_GEU, SASS_FLOW_T, SASS_FLOW_OFF, SASS_FLOW_LO, SASS_FLOW_SFF,
+    SASS_FLOW_LS, SASS_FLOW_HI, SASS_FLOW_SFT, SASS_FLOW_HS, SASS_FLOW_OFT,
+};
+
+enum sass_opcode sass_decode(uint64_t insn);
+
+char const* sass_opcode_name(enum sass_opcode op);
+
+// Applies patches to code in place. Patches with a zero count are skipped.
+// Returns false, leaving the code partially patched, if a patch falls outside
+// the code or its value does not fit.
+bool sass_apply_patches(uint8_t* code, size_t code_size,
+    struct sass_patch const* patches, size_t num_patches);
+
+static inline bool sass_is_sched(size_t index)
+{
+    return index % SASS_BUNDLE_SIZE == 0;
+}
+
+// Position in qwords of the insn-th instruction, skipping scheduling words
+static inline size_t sass_insn_position(size_t insn)
+{
+    return insn + insn / (SASS_BUNDLE_SIZE - 1) + 1;
+}
+
+static inline uint64_t sass_bits(uint64_t insn, int offset, int count)
+{
+    return (insn >> offset) & ((UINT64_C(1) << count) - 1);
+}
+
+static inline int64_t sass_sbits(uint64_t insn, int offset, int count)
+{
+    uint64_t const value = sass_bits(insn, offset, count);
+    uint64_t const sign = UINT64_C(1) << (count - 1);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+static inline int sass_dest(uint64_t insn)
+{
+    return (int)sass_bits(insn, 0, 8);
+}
+
+static inline int sass_src_a(uint64_t insn)
+{
+    return (int)sass_bits(insn, 8, 8);
+}
+
+static inline int sass_src_b(uint64_t insn)
+{
+    return (int)sass_bits(insn, 20, 8);
+}
+
+static inline int sass_src_c(uint64_t insn)
+{
+    return (int)sass_bits(insn, 39, 8);
+}
+
+static inline int sass_guard(uint64_t insn)
+{
+    return (int)sass_bits(insn, 16, 3);
+}
+
+static inline bool sass_guard_negated(uint64_t insn)
+{
+    return sass_bits(insn, 19, 1);
+}
+
+static inline bool sass_writes_cc(uint64_t insn)
+{
+    return sass_bits(insn, 47, 1);
+}
+
+static inline uint32_t sass_cbuf_offset(uint64_t insn)
+{
+    return (uint32_t)sass_bits(insn, 20, 14) * 4;
+}
+
+static inline int sass_cbuf_index(uint64_t insn)
+{
+    return (int)sass_bits(insn, 34, 5);
+}
+
+// 20-bit immediate with its sign stored in bit 56
+static inline uint32_t sass_imm20(uint64_t insn)
+{
+    uint32_t const value = (uint32_t)sass_bits(insn, 20, 19);
+    return sass_bits(insn, 56, 1) ? value | 0xfff80000 : value;
+}
+
+// 20-bit floating-point immediate holding the top bits of a 32-bit float
+static inline uint32_t sass_fimm20(uint64_t insn)
+{
+    return ((uint32_t)sass_bits(insn, 20, 19) << 12)
+        | ((uint32_t)sass_bits(insn, 56, 1) << 31);
+}
+
+static inline uint32_t sass_imm32(uint64_t insn)
+{
+    return (uint32_t)sass_bits(insn, 20, 32);
+}
+
+// Branch targets are relative to the next instruction, in bytes from the
+// start of the program
+static inline int64_t sass_branch_target(uint64_t insn, size_t index)
+{
+    return (int64_t)(index + 1) * 8 + sass_sbits(insn, 20, 24);
+}
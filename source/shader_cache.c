@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deko3d.h>
+
+#include "helper.h"
+#include "shader_cache.h"
+
+#define SHADER_CODE_BLOCK_SIZE 0x40000
+
+void shader_cache_init(struct shader_cache* cache, DkDevice device)
+{
+    memset(cache, 0, sizeof(*cache));
+    gpu_arena_init(&cache->code, device, BLOCK_CODE, SHADER_CODE_BLOCK_SIZE);
+    name_table_init(&cache->table);
+}
+
+void shader_cache_destroy(struct shader_cache* cache)
+{
+    for (size_t i = 0; i < cache->table.num_entries; ++i)
+        free(cache->entries[i]);
+    free(cache->entries);
+    name_table_free(&cache->table);
+    gpu_arena_destroy(&cache->code);
+    memset(cache, 0, sizeof(*cache));
+}
+
+struct shader_cache_entry const* shader_cache_find(
+    struct shader_cache const* cache, char const* name)
+{
+    uint64_t const hash = name_hash(name);
+    struct name_probe probe = name_table_probe(&cache->table, hash);
+    size_t index;
+    while (name_table_next(&cache->table, &probe, &index))
+    {
+        struct shader_cache_entry const* const entry = cache->entries[index];
+        if (0 == strcmp(entry->name, name))
+            return entry;
+    }
+    return NULL;
+}
+
+struct shader_cache_entry const* shader_cache_add(struct shader_cache* cache,
+    char const* name, void const* dksh, size_t dksh_size)
+{
+    struct shader_cache_entry* const entry = checked_malloc(sizeof(*entry));
+    memset(entry, 0, sizeof(*entry));
+    if (strlen(name) >= sizeof(entry->name))
+    {
+        printf("Shader name \"%s\" is too long! Aborting...\n", name);
+        exit(EXIT_FAILURE);
+    }
+    strcpy(entry->name, name);
+    entry->hash = name_hash(name);
+
+    entry->code = gpu_arena_alloc(&cache->code, dksh_size,
+        DK_SHADER_CODE_ALIGNMENT);
+    entry->dksh_size = dksh_size;
+    memcpy(entry->code.cpu_addr, dksh, dksh_size);
+
+    DkShaderMaker shader_mk;
+    dkShaderMakerDefaults(&shader_mk, entry->code.memblock, entry->code.offset);
+    dkShaderInitialize(&entry->shader, &shader_mk);
+
+    if (cache->table.num_entries == cache->capacity)
+    {
+        cache->capacity = cache->capacity ? cache->capacity * 2 : 64;
+        cache->entries = realloc(cache->entries,
+            cache->capacity * sizeof(*cache->entries));
+        if (!cache->entries)
+        {
+            printf("Out of memory! Aborting...\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    cache->entries[name_table_add(&cache->table, entry->hash)] = entry;
+    return entry;
+}
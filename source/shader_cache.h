@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deko3d.h>
+
+#include "gpu_arena.h"
+#include "name_table.h"
+
+struct shader_cache_entry
+{
+    uint64_t hash;
+    char name[64];
+    DkShader shader;
+    // The DKSH, in code memory
+    struct gpu_alloc code;
+    size_t dksh_size;
+};
+
+// Shaders made once and kept for the whole run, found by name. Their code
+// stays in a code arena of its own, which is never reset.
+struct shader_cache
+{
+    struct gpu_arena code;
+    // Indices into entries. Entries are allocated one by one so the shaders
+    // don't move when the array grows.
+    struct name_table table;
+    struct shader_cache_entry** entries;
+    size_t capacity;
+};
+
+void shader_cache_init(struct shader_cache* cache, DkDevice device);
+void shader_cache_destroy(struct shader_cache* cache);
+
+// NULL when the cache doesn't have it
+struct shader_cache_entry const* shader_cache_find(
+    struct shader_cache const* cache, char const* name);
+
+// Copies the DKSH into code memory and makes its shader. The name must not
+// be in the cache already.
+struct shader_cache_entry const* shader_cache_add(struct shader_cache* cache,
+    char const* name, void const* dksh, size_t dksh_size);
@@ -0,0 +1,143 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "name_table.h"
+#include "shader_pack.h"
+
+static_assert(sizeof(struct shader_pack_header) == 24, "Wrong size");
+static_assert(sizeof(struct shader_pack_entry) == 24, "Wrong size");
+
+static bool validate(struct shader_pack const* pack)
+{
+    struct shader_pack_header header;
+    if (pack->size < sizeof(header))
+        return false;
+    memcpy(&header, pack->data, sizeof(header));
+
+    if (header.magic != SHADER_PACK_MAGIC)
+    {
+        printf("Invalid shader pack magic %08x\n", header.magic);
+        return false;
+    }
+    if (header.version != SHADER_PACK_VERSION)
+    {
+        printf("Unsupported shader pack version %u\n", header.version);
+        return false;
+    }
+
+    size_t const entries_end = sizeof(header)
+        + (size_t)header.num_entries * sizeof(struct shader_pack_entry);
+    if (header.total_size != pack->size || entries_end > pack->size
+        || header.names_offset < entries_end
+        || (size_t)header.names_offset + header.names_size > pack->size)
+    {
+        printf("Truncated shader pack\n");
+        return false;
+    }
+    if (header.names_size == 0
+        || pack->data[header.names_offset + header.names_size - 1] != '\0')
+    {
+        printf("Corrupted shader pack names\n");
+        return false;
+    }
+
+    struct shader_pack_entry const* entries =
+        (struct shader_pack_entry const*)(pack->data + sizeof(header));
+    for (uint32_t i = 0; i < header.num_entries; ++i)
+    {
+        if (entries[i].name_offset >= header.names_size
+            || (size_t)entries[i].offset + entries[i].size > pack->size)
+        {
+            printf("Corrupted shader pack entry %u\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool shader_pack_load(struct shader_pack* pack, char const* path)
+{
+    memset(pack, 0, sizeof(*pack));
+
+    FILE* const file = fopen(path, "rb");
+    if (!file)
+    {
+        printf("Shader pack \"%s\" not found\n", path);
+        return false;
+    }
+    fseek(file, 0, SEEK_END);
+    pack->size = (size_t)ftell(file);
+    rewind(file);
+
+    pack->data = malloc(pack->size);
+    if (!pack->data)
+    {
+        printf("Out of memory loading shader pack\n");
+        fclose(file);
+        return false;
+    }
+    bool const read_ok = fread(pack->data, 1, pack->size, file) == pack->size;
+    fclose(file);
+
+    if (!read_ok || !validate(pack))
+    {
+        printf("Failed loading shader pack \"%s\"\n", path);
+        shader_pack_free(pack);
+        return false;
+    }
+
+    struct shader_pack_header const* header =
+        (struct shader_pack_header const*)pack->data;
+    pack->entries = (struct shader_pack_entry const*)(header + 1);
+    pack->num_entries = header->num_entries;
+    return true;
+}
+
+void shader_pack_free(struct shader_pack* pack)
+{
+    free(pack->data);
+    memset(pack, 0, sizeof(*pack));
+}
+
+void const* shader_pack_find(
+    struct shader_pack const* pack, char const* name, size_t* size)
+{
+    struct shader_pack_header const* header =
+        (struct shader_pack_header const*)pack->data;
+    char const* names = (char const*)pack->data + header->names_offset;
+    uint64_t const hash = name_hash(name);
+
+    // Lower bound on the hash, then walk the (rare) collisions
+    uint32_t first = 0;
+    uint32_t count = pack->num_entries;
+    while (count > 0)
+    {
+        uint32_t const step = count / 2;
+        if (pack->entries[first + step].name_hash < hash)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    for (uint32_t i = first; i < pack->num_entries; ++i)
+    {
+        struct shader_pack_entry const* entry = &pack->entries[i];
+        if (entry->name_hash != hash)
+            break;
+        if (strcmp(names + entry->name_offset, name) == 0)
+        {
+            *size = entry->size;
+            return pack->data + entry->offset;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHADER_PACK_MAGIC 0x4B505358 // XSPK
+#define SHADER_PACK_VERSION 1
+
+// Payloads are aligned for direct use as shader code memory
+#define SHADER_PACK_ALIGNMENT 0x100
+
+// File layout: header, entries sorted by (name_hash, name), the NUL-terminated
+// names and finally the payloads. Offsets are relative to the start of file.
+struct shader_pack_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_entries;
+    uint32_t names_offset;
+    uint32_t names_size;
+    uint32_t total_size;
+};
+
+struct shader_pack_entry
+{
+    uint64_t name_hash;
+    uint32_t name_offset;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t alignment;
+};
+
+struct shader_pack
+{
+    uint8_t* data;
+    size_t size;
+    struct shader_pack_entry const* entries;
+    uint32_t num_entries;
+};
+
+bool shader_pack_load(struct shader_pack* pack, char const* path);
+
+void shader_pack_free(struct shader_pack* pack);
+
+void const* shader_pack_find(
+    struct shader_pack const* pack, char const* name, size_t* size);
@@ -0,0 +1,187 @@
+#include <stdbool.h>
+#include <string.h>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "swizzle.h"
+
+// A GOB is 16 runs of 16 contiguous bytes, two rows of four runs in each
+// 64-byte sector
+#define RUN_SIZE 16
+#define RUNS_PER_ROW (GOB_WIDTH / RUN_SIZE)
+
+uint32_t swizzle_block_height(uint32_t gob_rows)
+{
+    uint32_t block_height = MAX_BLOCK_HEIGHT;
+    while (block_height > 1 && block_height / 2 >= gob_rows)
+        block_height /= 2;
+    return block_height;
+}
+
+uint32_t swizzle_block_depth(uint32_t depth)
+{
+    uint32_t block_depth = MAX_BLOCK_DEPTH;
+    while (block_depth > 1 && block_depth / 2 >= depth)
+        block_depth /= 2;
+    return block_depth;
+}
+
+void swizzle_layout_init(struct swizzle_layout* layout, uint32_t width,
+    uint32_t height, uint32_t depth, uint32_t bytes_per_element,
+    uint32_t element_width, uint32_t element_height)
+{
+    layout->width = (width + element_width - 1) / element_width;
+    layout->height = (height + element_height - 1) / element_height;
+    layout->depth = depth ? depth : 1;
+    layout->bytes_per_element = bytes_per_element;
+    layout->block_height = swizzle_block_height(
+        (layout->height + GOB_HEIGHT - 1) / GOB_HEIGHT);
+    layout->block_depth = swizzle_block_depth(layout->depth);
+}
+
+static uint32_t div_round_up(uint32_t value, uint32_t divisor)
+{
+    return (value + divisor - 1) / divisor;
+}
+
+static uint32_t gobs_per_row(struct swizzle_layout const* layout)
+{
+    return div_round_up(layout->width * layout->bytes_per_element, GOB_WIDTH);
+}
+
+static uint32_t blocks_per_column(struct swizzle_layout const* layout)
+{
+    return div_round_up(layout->height, GOB_HEIGHT * layout->block_height);
+}
+
+static size_t block_size(struct swizzle_layout const* layout)
+{
+    return (size_t)GOB_SIZE * layout->block_height * layout->block_depth;
+}
+
+size_t swizzle_size(struct swizzle_layout const* layout)
+{
+    size_t const blocks = (size_t)gobs_per_row(layout)
+        * blocks_per_column(layout)
+        * div_round_up(layout->depth, layout->block_depth);
+    return blocks * block_size(layout);
+}
+
+// Offset of a byte within its GOB
+static uint32_t gob_offset(uint32_t x, uint32_t y)
+{
+    return (x % 64 / 32) * 256 + (y % 8 / 2) * 64 + (x % 32 / 16) * 32
+        + (y % 2) * 16 + x % 16;
+}
+
+// Offset of the GOB holding byte x of row y in slice z
+static size_t gob_base(
+    struct swizzle_layout const* layout, uint32_t x, uint32_t y, uint32_t z)
+{
+    uint32_t const block_rows = GOB_HEIGHT * layout->block_height;
+    size_t const block = ((size_t)(z / layout->block_depth)
+        * blocks_per_column(layout) + y / block_rows) * gobs_per_row(layout)
+        + x / GOB_WIDTH;
+    return block * block_size(layout)
+        + (size_t)(z % layout->block_depth) * layout->block_height * GOB_SIZE
+        + (y % block_rows / GOB_HEIGHT) * GOB_SIZE;
+}
+
+size_t swizzle_offset(
+    struct swizzle_layout const* layout, uint32_t x, uint32_t y, uint32_t z)
+{
+    return gob_base(layout, x, y, z) + gob_offset(x, y);
+}
+
+static inline void copy_run(uint8_t* dst, uint8_t const* src)
+{
+#if defined(__ARM_NEON)
+    vst1q_u8(dst, vld1q_u8(src));
+#elif defined(__SSE2__)
+    _mm_storeu_si128((__m128i*)dst, _mm_loadu_si128((__m128i const*)src));
+#else
+    memcpy(dst, src, RUN_SIZE);
+#endif
+}
+
+// Whole GOBs move a run at a time, the offset of every run being known
+static void copy_gob(uint8_t* tiled, uint8_t* linear, size_t pitch,
+    bool to_tiled)
+{
+    for (uint32_t y = 0; y < GOB_HEIGHT; ++y)
+    {
+        uint8_t* const row = linear + y * pitch;
+        for (uint32_t x = 0; x < GOB_WIDTH; x += RUN_SIZE)
+        {
+            uint8_t* const run = tiled + gob_offset(x, y);
+            if (to_tiled)
+                copy_run(run, row + x);
+            else
+                copy_run(row + x, run);
+        }
+    }
+}
+
+// GOBs at the right and bottom edges are only partly covered by the image
+static void copy_partial_gob(uint8_t* tiled, uint8_t* linear, size_t pitch,
+    uint32_t width, uint32_t rows, bool to_tiled)
+{
+    for (uint32_t y = 0; y < rows; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            uint8_t* const tiled_byte = tiled + gob_offset(x, y);
+            uint8_t* const linear_byte = linear + y * pitch + x;
+            if (to_tiled)
+                *tiled_byte = *linear_byte;
+            else
+                *linear_byte = *tiled_byte;
+        }
+    }
+}
+
+static void copy_image(struct swizzle_layout const* layout, uint8_t* tiled,
+    uint8_t* linear, size_t pitch, bool to_tiled)
+{
+    uint32_t const row_bytes = layout->width * layout->bytes_per_element;
+    for (uint32_t z = 0; z < layout->depth; ++z)
+    {
+        uint8_t* const slice = linear + (size_t)z * layout->height * pitch;
+        for (uint32_t y = 0; y < layout->height; y += GOB_HEIGHT)
+        {
+            uint32_t const rows = layout->height - y < GOB_HEIGHT
+                ? layout->height - y : GOB_HEIGHT;
+            for (uint32_t x = 0; x < row_bytes; x += GOB_WIDTH)
+            {
+                uint8_t* const gob = tiled + gob_base(layout, x, y, z);
+                uint8_t* const origin = slice + (size_t)y * pitch + x;
+                uint32_t const width =
+                    row_bytes - x < GOB_WIDTH ? row_bytes - x : GOB_WIDTH;
+                if (width == GOB_WIDTH && rows == GOB_HEIGHT)
+                    copy_gob(gob, origin, pitch, to_tiled);
+                else
+                {
+                    copy_partial_gob(
+                        gob, origin, pitch, width, rows, to_tiled);
+                }
+            }
+        }
+    }
+}
+
+void swizzle(struct swizzle_layout const* layout, void* tiled,
+    void const* linear, size_t pitch)
+{
+    // Only read through, the copies share one walk
+    copy_image(layout, tiled, (uint8_t*)linear, pitch, true);
+}
+
+void deswizzle(struct swizzle_layout const* layout, void* linear,
+    size_t pitch, void const* tiled)
+{
+    copy_image(layout, (uint8_t*)tiled, linear, pitch, false);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Tegra X1 block linear layout. An image is made of GOBs, 64 bytes by 8 rows
+// stored in 512 bytes. GOBs are grouped into blocks block_height GOBs tall
+// and block_depth slices deep, and blocks are stored row by row, then slice
+// by slice.
+#define GOB_WIDTH 64
+#define GOB_HEIGHT 8
+#define GOB_SIZE 512
+
+#define MAX_BLOCK_HEIGHT 16
+#define MAX_BLOCK_DEPTH 32
+
+struct swizzle_layout
+{
+    // In elements, pixels or the blocks of compressed formats
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t bytes_per_element;
+    // In GOBs and slices, powers of two
+    uint32_t block_height;
+    uint32_t block_depth;
+};
+
+// The block height deko3d picks for an image that many GOBs tall, the
+// smallest that covers it
+uint32_t swizzle_block_height(uint32_t gob_rows);
+uint32_t swizzle_block_depth(uint32_t depth);
+
+// Layout of an image of width x height x depth pixels, whose elements are
+// element_width x element_height pixels, 1x1 unless compressed. Block sizes
+// are picked the way deko3d does unless set afterwards.
+void swizzle_layout_init(struct swizzle_layout* layout, uint32_t width,
+    uint32_t height, uint32_t depth, uint32_t bytes_per_element,
+    uint32_t element_width, uint32_t element_height);
+
+// Bytes taken by the tiled image
+size_t swizzle_size(struct swizzle_layout const* layout);
+
+// Offset of the byte x of row y in slice z of the tiled image
+size_t swizzle_offset(
+    struct swizzle_layout const* layout, uint32_t x, uint32_t y, uint32_t z);
+
+// Conversions between a linear image, rows pitch bytes apart and slices
+// height rows apart, and the tiled one
+void swizzle(struct swizzle_layout const* layout, void* tiled,
+    void const* linear, size_t pitch);
+void deswizzle(struct swizzle_layout const* layout, void* linear,
+    size_t pitch, void const* tiled);
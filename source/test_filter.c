@@ -0,0 +1,137 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "name_table.h"
+#include "test_filter.h"
+
+void test_filter_init(struct test_filter* filter)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->suites = TEST_SUITE_GRAPHICS | TEST_SUITE_COMPUTE;
+    filter->num_shards = 1;
+}
+
+static bool add_pattern(char const** patterns, size_t* num_patterns,
+    char const* pattern)
+{
+    if (*num_patterns == TEST_FILTER_MAX_PATTERNS || !*pattern)
+        return false;
+    patterns[(*num_patterns)++] = pattern;
+    return true;
+}
+
+static bool parse_shard(struct test_filter* filter, char const* shard)
+{
+    char* end;
+    unsigned long const index = strtoul(shard, &end, 10);
+    if (end == shard || *end != '/')
+        return false;
+    char const* const count = end + 1;
+    unsigned long const num_shards = strtoul(count, &end, 10);
+    if (end == count || *end || num_shards == 0 || index >= num_shards
+        || num_shards > UINT32_MAX)
+        return false;
+
+    filter->shard_index = index;
+    filter->num_shards = num_shards;
+    return true;
+}
+
+static char const* option_value(char const* arg, char const* option)
+{
+    size_t const length = strlen(option);
+    if (strncmp(arg, option, length) || arg[length] != '=')
+        return NULL;
+    return arg + length + 1;
+}
+
+enum test_filter_arg test_filter_parse_arg(
+    struct test_filter* filter, char const* arg)
+{
+    char const* value;
+    bool valid;
+    if ((value = option_value(arg, "--include")))
+        valid = add_pattern(filter->includes, &filter->num_includes, value);
+    else if ((value = option_value(arg, "--exclude")))
+        valid = add_pattern(filter->excludes, &filter->num_excludes, value);
+    else if ((value = option_value(arg, "--shard")))
+        valid = parse_shard(filter, value);
+    else if ((value = option_value(arg, "--suite")))
+    {
+        valid = true;
+        if (0 == strcmp(value, "compute"))
+            filter->suites = TEST_SUITE_COMPUTE;
+        else if (0 == strcmp(value, "graphics"))
+            filter->suites = TEST_SUITE_GRAPHICS;
+        else
+            valid = false;
+    }
+    else
+        return TEST_FILTER_ARG_UNKNOWN;
+
+    return valid ? TEST_FILTER_ARG_PARSED : TEST_FILTER_ARG_INVALID;
+}
+
+bool test_filter_has_suite(struct test_filter const* filter, int suite)
+{
+    return (filter->suites & suite) != 0;
+}
+
+// Backtracks to the last star only, which is enough since a later star can
+// match anything an earlier one would
+bool glob_match(char const* pattern, char const* string)
+{
+    char const* star = NULL;
+    char const* star_string = NULL;
+    while (*string)
+    {
+        if (*pattern == '*')
+        {
+            star = pattern++;
+            star_string = string;
+        }
+        else if (*pattern == '?' || *pattern == *string)
+        {
+            ++pattern;
+            ++string;
+        }
+        else if (star)
+        {
+            pattern = star + 1;
+            string = ++star_string;
+        }
+        else
+            return false;
+    }
+    while (*pattern == '*')
+        ++pattern;
+    return !*pattern;
+}
+
+static bool matches_any(char const* const* patterns, size_t num_patterns,
+    char const* name, char const* program)
+{
+    for (size_t i = 0; i < num_patterns; ++i)
+    {
+        if (glob_match(patterns[i], name)
+            || (program && glob_match(patterns[i], program)))
+            return true;
+    }
+    return false;
+}
+
+bool test_filter_selects(struct test_filter const* filter, char const* name,
+    char const* program)
+{
+    if (filter->num_includes
+        && !matches_any(filter->includes, filter->num_includes, name, program))
+        return false;
+    if (matches_any(filter->excludes, filter->num_excludes, name, program))
+        return false;
+    // The pack's name hash is fixed, so shard assignments hold across builds
+    return name_hash(name) % filter->num_shards
+        == filter->shard_index;
+}
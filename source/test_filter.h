@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TEST_FILTER_MAX_PATTERNS 16
+
+#define TEST_SUITE_GRAPHICS (1 << 0)
+#define TEST_SUITE_COMPUTE  (1 << 1)
+
+// Selects tests from the command line:
+//   --include=GLOB and --exclude=GLOB match the test name or its program,
+//       excludes win and no include selects everything
+//   --suite=compute|graphics
+//   --shard=i/n runs the i-th of n shards, counting from 0. Tests are
+//       assigned by a hash of their name, so adding tests leaves every other
+//       test in its shard.
+struct test_filter
+{
+    char const* includes[TEST_FILTER_MAX_PATTERNS];
+    size_t num_includes;
+    char const* excludes[TEST_FILTER_MAX_PATTERNS];
+    size_t num_excludes;
+    int suites;
+    uint32_t shard_index;
+    uint32_t num_shards;
+};
+
+enum test_filter_arg
+{
+    TEST_FILTER_ARG_UNKNOWN,
+    TEST_FILTER_ARG_PARSED,
+    TEST_FILTER_ARG_INVALID,
+};
+
+void test_filter_init(struct test_filter* filter);
+
+// The argument is kept, not copied
+enum test_filter_arg test_filter_parse_arg(
+    struct test_filter* filter, char const* arg);
+
+bool test_filter_has_suite(struct test_filter const* filter, int suite);
+
+// program may be NULL
+bool test_filter_selects(struct test_filter const* filter, char const* name,
+    char const* program);
+
+// * matches any run of characters, ? any single character
+bool glob_match(char const* pattern, char const* string);
@@ -0,0 +1,185 @@
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <switch.h>
+
+#include "helper.h"
+#include "test_log.h"
+#include "timing.h"
+
+#define RESULTS_PER_PAGE 43
+
+// The log flushed when exiting, aborts included
+static struct test_log* exit_log;
+
+static void flush_on_exit(void)
+{
+    if (exit_log)
+        test_log_flush(exit_log);
+}
+
+void test_log_init(struct test_log* log, enum test_log_mode mode,
+    uint32_t redraw_interval_ms, FILE* results)
+{
+    memset(log, 0, sizeof(*log));
+    log->mode = mode;
+    log->results = results;
+    log->redraw_interval_ns = (uint64_t)redraw_interval_ms * 1000000;
+    log->last_redraw_ns = timing_now_ns();
+
+    if (!exit_log)
+        atexit(flush_on_exit);
+    exit_log = log;
+}
+
+void test_log_free(struct test_log* log)
+{
+    test_log_flush(log);
+    if (exit_log == log)
+        exit_log = NULL;
+    free(log->text);
+}
+
+static void reserve(struct test_log* log, size_t size)
+{
+    if (log->size + size <= log->capacity)
+        return;
+    size_t capacity = log->capacity ? log->capacity : 0x4000;
+    while (capacity < log->size + size)
+        capacity *= 2;
+    char* const text = realloc(log->text, capacity);
+    if (!text)
+    {
+        test_log_flush(log);
+        printf("Out of memory! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+    log->text = text;
+    log->capacity = capacity;
+}
+
+static void append_v(struct test_log* log, char const* format, va_list args)
+{
+    va_list copy;
+    va_copy(copy, args);
+    int const length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if (length <= 0)
+        return;
+
+    // vsnprintf writes a terminator past the text, which is overwritten by
+    // the next append
+    reserve(log, length + 1);
+    vsnprintf(log->text + log->size, length + 1, format, args);
+    log->size += length;
+}
+
+void test_log_printf(struct test_log* log, char const* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    append_v(log, format, args);
+    va_end(args);
+}
+
+void test_log_begin_suite(struct test_log* log, char const* suite)
+{
+    log->suite = suite;
+}
+
+void test_log_begin_test(struct test_log* log, size_t index, size_t count,
+    char const* name, int width)
+{
+    log->test = name;
+    log->note[0] = '\0';
+
+    size_t const line_start = log->size;
+    test_log_printf(log, "%3zd/%3zd Test: %s", index + 1, count, name);
+    int const written_chars = log->size - line_start;
+    if (written_chars < width)
+    {
+        reserve(log, width - written_chars);
+        memset(log->text + log->size, '.', width - written_chars);
+        log->size += width - written_chars;
+    }
+    test_log_printf(log, " ");
+}
+
+void test_log_note(struct test_log* log, char const* format, ...)
+{
+    size_t const length = strlen(log->note);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(log->note + length, sizeof(log->note) - length, format, args);
+    va_end(args);
+}
+
+void test_log_end_test(struct test_log* log, bool pass)
+{
+    test_log_printf(log, "%s\n", pass ? "Passed" : "Failed");
+    ++log->results_on_page;
+
+    if (pass)
+        ++log->num_passed;
+    else
+    {
+        ++log->num_failed;
+        if (log->results && log->note[0])
+        {
+            fprintf(log->results, "FAIL %s %s %s\n", log->suite, log->test,
+                log->note);
+        }
+        else if (log->results)
+            fprintf(log->results, "FAIL %s %s\n", log->suite, log->test);
+    }
+
+    if (log->mode != TEST_LOG_INTERACTIVE)
+        return;
+
+    if (log->results_on_page == RESULTS_PER_PAGE)
+    {
+        log->results_on_page = 0;
+        test_log_printf(log, "Press A to continue...");
+        test_log_flush(log);
+        wait_for_input();
+    }
+    else if (!pass
+        || timing_now_ns() - log->last_redraw_ns >= log->redraw_interval_ns)
+    {
+        test_log_flush(log);
+    }
+}
+
+bool test_log_budget_exceeded(struct test_log const* log)
+{
+    return log->max_failures && log->num_failed >= log->max_failures;
+}
+
+void test_log_flush(struct test_log* log)
+{
+    // The buffer starts over once shown, it only holds a batch
+    if (log->size)
+        fwrite(log->text, 1, log->size, stdout);
+    log->size = 0;
+    if (log->mode != TEST_LOG_HEADLESS)
+        consoleUpdate(NULL);
+    log->last_redraw_ns = timing_now_ns();
+}
+
+void test_log_write_totals(struct test_log const* log)
+{
+    if (log->results)
+    {
+        fprintf(log->results, "passed %zu failed %zu\n", log->num_passed,
+            log->num_failed);
+        if (test_log_budget_exceeded(log))
+        {
+            fprintf(log->results, "stopped after %zu failures\n",
+                log->max_failures);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+enum test_log_mode
+{
+    // Redraws at an interval, on failures and pauses every page of results
+    TEST_LOG_INTERACTIVE,
+    // Only draws when flushed
+    TEST_LOG_AUTOMATIC,
+    // No console at all, text is still written to stdout
+    TEST_LOG_HEADLESS,
+};
+
+// Test output kept in memory and written to the console in batches, so
+// drawing the console stays out of the test loop. Whatever was not shown yet
+// is flushed on exit. Failed tests are also listed in the results file.
+struct test_log
+{
+    // Text not written to the console yet
+    char* text;
+    size_t size;
+    size_t capacity;
+    enum test_log_mode mode;
+    uint64_t redraw_interval_ns;
+    uint64_t last_redraw_ns;
+    size_t results_on_page;
+
+    FILE* results;
+    char const* suite;
+    char const* test;
+    // Detail of the current test's failure for the results file
+    char note[160];
+    size_t num_passed;
+    size_t num_failed;
+    // Tests stop once this many failed, 0 for no limit
+    size_t max_failures;
+};
+
+// results may be NULL
+void test_log_init(struct test_log* log, enum test_log_mode mode,
+    uint32_t redraw_interval_ms, FILE* results);
+void test_log_free(struct test_log* log);
+
+void test_log_printf(struct test_log* log, char const* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+// Names the suite the following tests are listed under in the results file
+void test_log_begin_suite(struct test_log* log, char const* suite);
+
+// Starts a result line, the test name padded with dots to width
+void test_log_begin_test(struct test_log* log, size_t index, size_t count,
+    char const* name, int width);
+// Adds to the failed test's line in the results file
+void test_log_note(struct test_log* log, char const* format, ...)
+    __attribute__((format(printf, 2, 3)));
+// Ends the result line, redrawing or pausing for the next page as needed
+void test_log_end_test(struct test_log* log, bool pass);
+
+// True once max_failures tests failed, suites stop running tests then
+bool test_log_budget_exceeded(struct test_log const* log);
+
+// Writes the text not shown yet and presents the console
+void test_log_flush(struct test_log* log);
+
+// Writes the pass and fail totals to the results file
+void test_log_write_totals(struct test_log const* log);
@@ -0,0 +1,187 @@
+#include <string.h>
+
+#include "tile_codec.h"
+
+#define DELTA_STRIDE 4
+#define MIN_MATCH 4
+#define HASH_BITS 8
+#define NO_POSITION 0xffff
+
+static uint32_t read32(uint8_t const* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Lengths over 14 continue in bytes of 255 and a final byte below it
+static size_t write_length(uint8_t* out, size_t length)
+{
+    size_t written = 0;
+    for (; length >= 255; length -= 255)
+        out[written++] = 255;
+    out[written++] = (uint8_t)length;
+    return written;
+}
+
+static size_t write_sequence(uint8_t* out, uint8_t const* literals,
+    size_t num_literals, size_t offset, size_t match_length)
+{
+    size_t written = 1;
+    size_t const match_code = match_length ? match_length - MIN_MATCH : 0;
+    out[0] = (uint8_t)((num_literals < 15 ? num_literals : 15) << 4
+        | (match_code < 15 ? match_code : 15));
+    if (num_literals >= 15)
+        written += write_length(out + written, num_literals - 15);
+    memcpy(out + written, literals, num_literals);
+    written += num_literals;
+    if (!match_length)
+        return written;
+
+    out[written++] = (uint8_t)offset;
+    out[written++] = (uint8_t)(offset >> 8);
+    if (match_code >= 15)
+        written += write_length(out + written, match_code - 15);
+    return written;
+}
+
+// Greedy, a match is any earlier 4 bytes hashing the same. Gives up once
+// the output is no smaller than the input.
+static size_t compress(uint8_t const* src, size_t size, uint8_t* out)
+{
+    uint16_t table[1 << HASH_BITS];
+    memset(table, 0xff, sizeof(table));
+
+    size_t written = 0;
+    size_t anchor = 0;
+    size_t i = 0;
+    while (i + MIN_MATCH <= size && written < size)
+    {
+        uint32_t const sequence = read32(src + i);
+        uint32_t const hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+        size_t const candidate = table[hash];
+        table[hash] = (uint16_t)i;
+        if (candidate == NO_POSITION || read32(src + candidate) != sequence)
+        {
+            ++i;
+            continue;
+        }
+
+        size_t length = MIN_MATCH;
+        while (i + length < size && src[candidate + length] == src[i + length])
+            ++length;
+        written += write_sequence(out + written, src + anchor, i - anchor,
+            i - candidate, length);
+        i += length;
+        anchor = i;
+    }
+    if (anchor < size && written < size)
+    {
+        written += write_sequence(
+            out + written, src + anchor, size - anchor, 0, 0);
+    }
+    return written;
+}
+
+size_t tile_encode(void const* tile, size_t size, uint8_t* out)
+{
+    uint8_t const* const bytes = tile;
+    uint8_t delta[TILE_BYTES];
+    for (size_t i = 0; i < size; ++i)
+        delta[i] = bytes[i] - (i >= DELTA_STRIDE ? bytes[i - DELTA_STRIDE] : 0);
+
+    // Compression stops past the size, the last sequence may run over by
+    // its literals
+    uint8_t compressed[2 * TILE_BYTES + 16];
+    size_t const compressed_size = compress(delta, size, compressed);
+
+    uint16_t header;
+    if (compressed_size < size)
+    {
+        header = (uint16_t)compressed_size;
+        memcpy(out + 2, compressed, compressed_size);
+    }
+    else
+    {
+        header = TILE_CODEC_RAW | (uint16_t)size;
+        memcpy(out + 2, bytes, size);
+    }
+    out[0] = (uint8_t)header;
+    out[1] = (uint8_t)(header >> 8);
+    return 2 + (header & TILE_CODEC_SIZE_MASK);
+}
+
+static bool read_length(
+    uint8_t const** in, uint8_t const* end, size_t* length)
+{
+    uint8_t byte;
+    do
+    {
+        if (*in == end)
+            return false;
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+static bool decompress(
+    uint8_t const* in, size_t in_size, uint8_t* out, size_t size)
+{
+    uint8_t const* const end = in + in_size;
+    size_t written = 0;
+    while (in < end)
+    {
+        uint8_t const token = *in++;
+        size_t num_literals = token >> 4;
+        if (num_literals == 15 && !read_length(&in, end, &num_literals))
+            return false;
+        if (num_literals > (size_t)(end - in) || num_literals > size - written)
+            return false;
+        memcpy(out + written, in, num_literals);
+        in += num_literals;
+        written += num_literals;
+        if (in == end)
+            break;
+
+        if (end - in < 2)
+            return false;
+        size_t const offset = in[0] | (size_t)in[1] << 8;
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15 && !read_length(&in, end, &length))
+            return false;
+        length += MIN_MATCH;
+        if (offset == 0 || offset > written || length > size - written)
+            return false;
+        // Overlapping matches repeat, so byte by byte
+        for (size_t i = 0; i < length; ++i, ++written)
+            out[written] = out[written - offset];
+    }
+    return written == size;
+}
+
+size_t tile_decode(uint8_t const* in, size_t in_size, void* tile, size_t size)
+{
+    if (in_size < 2 || size > TILE_BYTES)
+        return 0;
+    uint16_t const header = in[0] | in[1] << 8;
+    size_t const encoded_size = header & TILE_CODEC_SIZE_MASK;
+    if (encoded_size > in_size - 2)
+        return 0;
+
+    uint8_t* const bytes = tile;
+    if (header & TILE_CODEC_RAW)
+    {
+        if (encoded_size != size)
+            return 0;
+        memcpy(bytes, in + 2, size);
+        return 2 + encoded_size;
+    }
+
+    if (!decompress(in + 2, encoded_size, bytes, size))
+        return 0;
+    for (size_t i = DELTA_STRIDE; i < size; ++i)
+        bytes[i] += bytes[i - DELTA_STRIDE];
+    return 2 + encoded_size;
+}
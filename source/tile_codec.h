@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tile_hash.h"
+
+// Compression of image tiles, up to TILE_BYTES each. Bytes are stored as the
+// difference to the byte 4 before, which makes flat and smoothly changing
+// pixels of most formats repeat, and the differences are LZ compressed the
+// way LZ4 blocks are. Every tile starts with a 16-bit header, its encoded
+// size and whether it is stored raw because it didn't compress.
+#define TILE_CODEC_RAW 0x8000
+#define TILE_CODEC_SIZE_MASK 0x7fff
+
+// Largest encoded tile, header included
+#define TILE_CODEC_BOUND (2 + TILE_BYTES)
+
+size_t tile_encode(void const* tile, size_t size, uint8_t* out);
+
+// Decodes the tile at the start of in, size bytes of it. Returns the bytes
+// read from in, 0 when they aren't a valid tile.
+size_t tile_decode(uint8_t const* in, size_t in_size, void* tile, size_t size);
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "swizzle.h"
+#include "tile_hash.h"
+#include "xxhash.h"
+
+void tile_hash(void const* data, size_t size, uint32_t* hashes)
+{
+    uint8_t const* const bytes = data;
+    for (size_t offset = 0, i = 0; offset < size; offset += TILE_BYTES, ++i)
+    {
+        size_t const tile_size =
+            size - offset < TILE_BYTES ? size - offset : TILE_BYTES;
+        hashes[i] = (uint32_t)xxh64(bytes + offset, tile_size, 0);
+    }
+}
+
+void tile_grid_init(struct tile_grid* grid, size_t size, uint32_t height)
+{
+    uint32_t const rows = (height + TILE_ROWS - 1) / TILE_ROWS;
+    uint32_t const block_height = swizzle_block_height(rows);
+
+    uint32_t const block_rows = (rows + block_height - 1) / block_height;
+    grid->block_height = block_height;
+    grid->height = rows ? rows : 1;
+    grid->width = tile_count(size) / (block_rows * block_height);
+    if (grid->width == 0)
+        grid->width = 1;
+}
+
+void tile_position(struct tile_grid const* grid, size_t tile, uint32_t* x,
+    uint32_t* y)
+{
+    // Blocks are stored row by row, the GOBs of a block top to bottom
+    size_t const block = tile / grid->block_height;
+    *x = block % grid->width;
+    *y = (block / grid->width) * grid->block_height
+        + tile % grid->block_height;
+}
+
+void tile_hash_format(
+    uint32_t const* hashes, size_t count, char* text, size_t size)
+{
+    size_t written = 0;
+    for (size_t i = 0; i < count && written + TILE_HASH_DIGITS < size; ++i)
+    {
+        snprintf(text + written, size - written, "%08x", hashes[i]);
+        written += TILE_HASH_DIGITS;
+    }
+    if (size)
+        text[written < size ? written : size - 1] = '\0';
+}
+
+bool tile_hash_parse(char const* text, uint32_t* hashes, size_t count)
+{
+    if (strlen(text) != count * TILE_HASH_DIGITS)
+        return false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t hash = 0;
+        for (int j = 0; j < TILE_HASH_DIGITS; ++j)
+        {
+            char const c = text[i * TILE_HASH_DIGITS + j];
+            uint32_t digit;
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            else
+                return false;
+            hash = hash << 4 | digit;
+        }
+        hashes[i] = hash;
+    }
+    return true;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "swizzle.h"
+
+// A block linear image is a grid of GOBs, 64 bytes by 8 rows stored in 512
+// contiguous bytes, so hashing memory in GOB sized tiles hashes rectangles of
+// the image without having to deswizzle it.
+#define TILE_BYTES GOB_SIZE
+#define TILE_ROW_BYTES GOB_WIDTH
+#define TILE_ROWS GOB_HEIGHT
+
+// Digits of a tile hash in a golden
+#define TILE_HASH_DIGITS 8
+
+// Where the GOBs of an image sit, for naming tiles
+struct tile_grid
+{
+    uint32_t width; // in tiles
+    uint32_t height; // in tiles
+    uint32_t block_height; // in tiles, as picked by deko3d
+};
+
+static inline size_t tile_count(size_t size)
+{
+    return (size + TILE_BYTES - 1) / TILE_BYTES;
+}
+
+// One 32-bit hash per tile of the first size bytes of data
+void tile_hash(void const* data, size_t size, uint32_t* hashes);
+
+// The grid of an image of the given height whose layout takes size bytes.
+// deko3d picks the block height from the image's height unless told
+// otherwise.
+void tile_grid_init(struct tile_grid* grid, size_t size, uint32_t height);
+
+// Column and row of a tile, in tiles
+void tile_position(struct tile_grid const* grid, size_t tile, uint32_t* x,
+    uint32_t* y);
+
+// Hashes as hex digits, size must fit TILE_HASH_DIGITS per hash and a NUL
+void tile_hash_format(
+    uint32_t const* hashes, size_t count, char* text, size_t size);
+
+// Reads count hashes, false when text does not hold exactly that many
+bool tile_hash_parse(char const* text, uint32_t* hashes, size_t count);
@@ -0,0 +1,157 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <switch.h>
+#include <deko3d.h>
+
+#include "helper.h"
+#include "timing.h"
+
+// Long semaphore report: 64-bit payload followed by the 64-bit timestamp
+#define REPORT_SIZE 16
+#define REPORT_TIMESTAMP_OFFSET 8
+
+#define CALIBRATION_CMDMEM_SIZE 0x1000
+#define CALIBRATION_SLEEP_NS 20000000
+
+static uint64_t read_timestamp(struct gpu_timer const* timer, size_t slot)
+{
+    uint64_t timestamp;
+    memcpy(&timestamp,
+        timer->reports + slot * REPORT_SIZE + REPORT_TIMESTAMP_OFFSET,
+        sizeof(timestamp));
+    return timestamp;
+}
+
+// Returns the CPU time right after the GPU wrote the timestamp
+static uint64_t report_now(struct gpu_timer const* timer, DkQueue queue,
+    DkCmdBuf cmdbuf, size_t slot)
+{
+    dkCmdBufClear(cmdbuf);
+    dkCmdBufReportCounter(cmdbuf, DkCounter_Timestamp,
+        timer->gpu_addr + slot * REPORT_SIZE);
+    dkQueueSubmitCommands(queue, dkCmdBufFinishList(cmdbuf));
+    dkQueueWaitIdle(queue);
+    return timing_now_ns();
+}
+
+// Two timestamps taken a sleep apart, the submission latency is small next to
+// the sleep
+static void calibrate(struct gpu_timer* timer, DkDevice device, DkQueue queue)
+{
+    DkMemBlock const cmdmem = make_memory_block(device,
+        CALIBRATION_CMDMEM_SIZE,
+        DkMemBlockFlags_CpuUncached | DkMemBlockFlags_GpuCached);
+    DkCmdBufMaker cmd_mk;
+    dkCmdBufMakerDefaults(&cmd_mk, device);
+    DkCmdBuf const cmdbuf = dkCmdBufCreate(&cmd_mk);
+    dkCmdBufAddMemory(cmdbuf, cmdmem, 0, CALIBRATION_CMDMEM_SIZE);
+
+    // The calibration uses the first two slots, before any test writes them
+    uint64_t const cpu_begin = report_now(timer, queue, cmdbuf, 0);
+    svcSleepThread(CALIBRATION_SLEEP_NS);
+    uint64_t const cpu_end = report_now(timer, queue, cmdbuf, 1);
+
+    uint64_t const ticks = read_timestamp(timer, 1) - read_timestamp(timer, 0);
+    timer->ns_per_tick = ticks ? (double)(cpu_end - cpu_begin) / ticks : 1.0;
+
+    dkCmdBufDestroy(cmdbuf);
+    dkMemBlockDestroy(cmdmem);
+}
+
+void gpu_timer_create(struct gpu_timer* timer, DkDevice device, DkQueue queue,
+    size_t num_tests)
+{
+    size_t const num_slots = num_tests * 2 < 2 ? 2 : num_tests * 2;
+    timer->memblock = make_memory_block(device, num_slots * REPORT_SIZE,
+        DkMemBlockFlags_CpuUncached | DkMemBlockFlags_GpuCached);
+    timer->gpu_addr = dkMemBlockGetGpuAddr(timer->memblock);
+    timer->reports = dkMemBlockGetCpuAddr(timer->memblock);
+    timer->num_tests = num_tests;
+    calibrate(timer, device, queue);
+}
+
+void gpu_timer_destroy(struct gpu_timer const* timer)
+{
+    dkMemBlockDestroy(timer->memblock);
+}
+
+void gpu_timer_begin(struct gpu_timer const* timer, DkCmdBuf cmdbuf,
+    size_t test)
+{
+    if (!timer)
+        return;
+    dkCmdBufReportCounter(cmdbuf, DkCounter_Timestamp,
+        timer->gpu_addr + test * 2 * REPORT_SIZE);
+}
+
+void gpu_timer_end(struct gpu_timer const* timer, DkCmdBuf cmdbuf,
+    size_t test)
+{
+    if (!timer)
+        return;
+    dkCmdBufReportCounter(cmdbuf, DkCounter_Timestamp,
+        timer->gpu_addr + (test * 2 + 1) * REPORT_SIZE);
+}
+
+uint64_t gpu_timer_elapsed_ns(struct gpu_timer const* timer, size_t test)
+{
+    uint64_t const ticks = read_timestamp(timer, test * 2 + 1)
+        - read_timestamp(timer, test * 2);
+    return (uint64_t)(ticks * timer->ns_per_tick);
+}
+
+uint64_t timing_now_ns(void)
+{
+    return armTicksToNs(armGetSystemTick());
+}
+
+void timing_lap(struct test_timing* timing, enum test_phase phase,
+    uint64_t* start)
+{
+    uint64_t const now = timing_now_ns();
+    timing->phase_ns[phase] += now - *start;
+    *start = now;
+}
+
+static void write_string(FILE* log, char const* string)
+{
+    putc('"', log);
+    for (; *string; ++string)
+    {
+        if (*string == '"' || *string == '\\')
+            putc('\\', log);
+        putc(*string, log);
+    }
+    putc('"', log);
+}
+
+static char const* const phase_names[NUM_TEST_PHASES] = {
+    "load_ns", "build_ns", "record_ns", "submit_ns", "gpu_ns", "wait_ns",
+    "verify_ns",
+};
+
+void timing_write(FILE* log, char const* suite, char const* test, bool pass,
+    struct test_timing const* timing)
+{
+    if (!log)
+        return;
+
+    fputs("{\"suite\":", log);
+    write_string(log, suite);
+    fputs(",\"test\":", log);
+    write_string(log, test);
+    fprintf(log, ",\"pass\":%s", pass ? "true" : "false");
+    for (int i = 0; i < NUM_TEST_PHASES; ++i)
+    {
+        if (i == PHASE_GPU && !timing->has_gpu_time)
+            fprintf(log, ",\"%s\":null", phase_names[i]);
+        else
+            fprintf(log, ",\"%s\":%llu", phase_names[i],
+                (unsigned long long)timing->phase_ns[i]);
+    }
+    fputs("}\n", log);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <deko3d.h>
+
+enum test_phase
+{
+    PHASE_LOAD,   // finding and copying programs
+    PHASE_BUILD,  // DKSH headers and shader objects
+    PHASE_RECORD, // command recording, custom executors included
+    PHASE_SUBMIT,
+    PHASE_GPU,    // between the timestamps around the test's commands
+    PHASE_WAIT,
+    PHASE_VERIFY, // result comparison or hashing
+    NUM_TEST_PHASES,
+};
+
+struct test_timing
+{
+    uint64_t phase_ns[NUM_TEST_PHASES];
+    bool has_gpu_time;
+};
+
+// Timestamp reports written by the GPU, two slots per test
+struct gpu_timer
+{
+    DkMemBlock memblock;
+    DkGpuAddr gpu_addr;
+    uint8_t const* reports;
+    size_t num_tests;
+    double ns_per_tick;
+};
+
+// Calibrates GPU ticks against the CPU clock, which takes a few milliseconds.
+// Suites only make one for a timing log and pass NULL timers otherwise.
+void gpu_timer_create(struct gpu_timer* timer, DkDevice device, DkQueue queue,
+    size_t num_tests);
+void gpu_timer_destroy(struct gpu_timer const* timer);
+
+// No-ops when timer is NULL
+void gpu_timer_begin(struct gpu_timer const* timer, DkCmdBuf cmdbuf,
+    size_t test);
+void gpu_timer_end(struct gpu_timer const* timer, DkCmdBuf cmdbuf,
+    size_t test);
+
+// Valid once the commands between begin and end have completed
+uint64_t gpu_timer_elapsed_ns(struct gpu_timer const* timer, size_t test);
+
+uint64_t timing_now_ns(void);
+
+// Adds the time since *start to a phase and restarts the clock
+void timing_lap(struct test_timing* timing, enum test_phase phase,
+    uint64_t* start);
+
+// One JSON object per line, log may be NULL
+void timing_write(FILE* log, char const* suite, char const* test, bool pass,
+    struct test_timing const* timing);
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "verify_pool.h"
+
+#ifdef __SWITCH__
+// Applications get cores 0 to 2 and the main thread runs on core 0
+#define FIRST_WORKER_CORE 1
+#define NUM_WORKER_CORES 2
+// The main thread's, libnx's default
+#define WORKER_PRIORITY 0x2c
+#define WORKER_STACK_SIZE 0x20000
+#endif
+
+static bool is_empty(struct verify_pool* pool)
+{
+    return atomic_load_explicit(&pool->head, memory_order_acquire)
+        == atomic_load_explicit(&pool->tail, memory_order_acquire);
+}
+
+// NULL when the queue is empty. Workers race for the head, the one whose
+// compare-exchange moves it owns the job.
+static struct verify_job* take_job(struct verify_pool* pool)
+{
+    size_t head = atomic_load_explicit(&pool->head, memory_order_acquire);
+    for (;;)
+    {
+        size_t const tail =
+            atomic_load_explicit(&pool->tail, memory_order_acquire);
+        if (head == tail)
+            return NULL;
+        struct verify_job* const job = atomic_load_explicit(
+            &pool->jobs[head % VERIFY_QUEUE_SIZE], memory_order_relaxed);
+        if (atomic_compare_exchange_weak_explicit(&pool->head, &head,
+                head + 1, memory_order_acq_rel, memory_order_acquire))
+            return job;
+    }
+}
+
+static void run_job(struct verify_pool* pool, struct verify_job* job)
+{
+    job->run(job);
+    pthread_mutex_lock(&pool->lock);
+    atomic_store_explicit(&job->is_done, true, memory_order_release);
+    pthread_cond_broadcast(&pool->has_done);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void run_worker(struct verify_pool* pool)
+{
+    for (;;)
+    {
+        struct verify_job* const job = take_job(pool);
+        if (job)
+        {
+            run_job(pool, job);
+            continue;
+        }
+
+        // Submitters signal under the lock, so checking under it too
+        // can't miss a job
+        pthread_mutex_lock(&pool->lock);
+        while (is_empty(pool) && !atomic_load(&pool->is_stopping))
+            pthread_cond_wait(&pool->has_jobs, &pool->lock);
+        bool const is_finished = is_empty(pool);
+        pthread_mutex_unlock(&pool->lock);
+        if (is_finished)
+            return;
+    }
+}
+
+#ifdef __SWITCH__
+static void worker_main(void* arg)
+{
+    run_worker(arg);
+}
+
+// Workers beyond the free cores share them
+static bool start_worker(struct verify_pool* pool, size_t index)
+{
+    Thread* const thread = &pool->workers[index];
+    int const core = FIRST_WORKER_CORE + index % NUM_WORKER_CORES;
+    if (R_FAILED(threadCreate(thread, worker_main, pool, NULL,
+            WORKER_STACK_SIZE, WORKER_PRIORITY, core)))
+        return false;
+    if (R_FAILED(threadStart(thread)))
+    {
+        threadClose(thread);
+        return false;
+    }
+    return true;
+}
+
+static void join_worker(struct verify_pool* pool, size_t index)
+{
+    threadWaitForExit(&pool->workers[index]);
+    threadClose(&pool->workers[index]);
+}
+#else
+static void* worker_main(void* arg)
+{
+    run_worker(arg);
+    return NULL;
+}
+
+static bool start_worker(struct verify_pool* pool, size_t index)
+{
+    return 0 == pthread_create(&pool->workers[index], NULL, worker_main, pool);
+}
+
+static void join_worker(struct verify_pool* pool, size_t index)
+{
+    pthread_join(pool->workers[index], NULL);
+}
+#endif
+
+void verify_pool_init(struct verify_pool* pool, size_t num_workers)
+{
+    memset(pool, 0, sizeof(*pool));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->has_jobs, NULL);
+    pthread_cond_init(&pool->has_done, NULL);
+    if (num_workers > MAX_VERIFY_WORKERS)
+        num_workers = MAX_VERIFY_WORKERS;
+
+    for (size_t i = 0; i < num_workers; ++i)
+    {
+        if (!start_worker(pool, i))
+        {
+            printf("Failed to start verification thread %zu\n", i);
+            break;
+        }
+        ++pool->num_workers;
+    }
+}
+
+void verify_pool_destroy(struct verify_pool* pool)
+{
+    pthread_mutex_lock(&pool->lock);
+    atomic_store(&pool->is_stopping, true);
+    pthread_cond_broadcast(&pool->has_jobs);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 0; i < pool->num_workers; ++i)
+        join_worker(pool, i);
+
+    pthread_cond_destroy(&pool->has_done);
+    pthread_cond_destroy(&pool->has_jobs);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+size_t verify_pool_default_workers(void)
+{
+#ifdef __SWITCH__
+    return NUM_WORKER_CORES;
+#else
+    long const cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores <= 1)
+        return 1;
+    return cores - 1 < MAX_VERIFY_WORKERS ? cores - 1 : MAX_VERIFY_WORKERS;
+#endif
+}
+
+void verify_pool_submit(struct verify_pool* pool, struct verify_job* job)
+{
+    atomic_store_explicit(&job->is_done, false, memory_order_relaxed);
+    if (pool->num_workers == 0)
+    {
+        run_job(pool, job);
+        return;
+    }
+
+    size_t const tail =
+        atomic_load_explicit(&pool->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&pool->head, memory_order_acquire)
+        == VERIFY_QUEUE_SIZE)
+    {
+        printf("Too many verifications queued! Aborting...\n");
+        exit(EXIT_FAILURE);
+    }
+    atomic_store_explicit(
+        &pool->jobs[tail % VERIFY_QUEUE_SIZE], job, memory_order_relaxed);
+    atomic_store_explicit(&pool->tail, tail + 1, memory_order_release);
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->has_jobs);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void verify_pool_wait(struct verify_pool* pool, struct verify_job* job)
+{
+    if (atomic_load_explicit(&job->is_done, memory_order_acquire))
+        return;
+    pthread_mutex_lock(&pool->lock);
+    while (!atomic_load_explicit(&job->is_done, memory_order_acquire))
+        pthread_cond_wait(&pool->has_done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __SWITCH__
+#include <switch.h>
+#endif
+
+#define MAX_VERIFY_WORKERS 16
+// Jobs queued and not taken by a worker yet, a power of two
+#define VERIFY_QUEUE_SIZE 16
+
+// Work handed to the pool, the submitter keeps it alive until
+// verify_pool_wait returned
+struct verify_job
+{
+    void (*run)(struct verify_job* job);
+    atomic_bool is_done;
+};
+
+// Worker threads running jobs from the thread that submits them. Jobs are
+// queued in a lock-free ring with a single producer, the lock is only taken
+// to sleep when there is nothing to do and to wake the sleepers. On the
+// Switch the workers are pinned to the cores the main thread leaves free.
+struct verify_pool
+{
+#ifdef __SWITCH__
+    Thread workers[MAX_VERIFY_WORKERS];
+#else
+    pthread_t workers[MAX_VERIFY_WORKERS];
+#endif
+    size_t num_workers;
+
+    _Atomic(struct verify_job*) jobs[VERIFY_QUEUE_SIZE];
+    // Next job to take and next free entry, counting up forever
+    atomic_size_t head;
+    atomic_size_t tail;
+    atomic_bool is_stopping;
+
+    pthread_mutex_t lock;
+    pthread_cond_t has_jobs;
+    pthread_cond_t has_done;
+};
+
+// With no workers, jobs run in verify_pool_submit
+void verify_pool_init(struct verify_pool* pool, size_t num_workers);
+// Runs the queued jobs and joins the workers
+void verify_pool_destroy(struct verify_pool* pool);
+
+// One worker per core the submitting thread leaves free, cores 1 and 2 on
+// the Switch
+size_t verify_pool_default_workers(void);
+
+// Aborts when VERIFY_QUEUE_SIZE jobs are queued already
+void verify_pool_submit(struct verify_pool* pool, struct verify_job* job);
+
+// Returns once the job has run, its results are visible then
+void verify_pool_wait(struct verify_pool* pool, struct verify_job* job);
@@ -0,0 +1,102 @@
+#include <string.h>
+
+#include "xxhash.h"
+
+#define PRIME64_1 0x9e3779b185ebca87ull
+#define PRIME64_2 0xc2b2ae3d27d4eb4full
+#define PRIME64_3 0x165667b19e3779f9ull
+#define PRIME64_4 0x85ebca77c2b2ae63ull
+#define PRIME64_5 0x27d4eb2f165667c5ull
+
+static uint64_t rotl(uint64_t value, int shift)
+{
+    return value << shift | value >> (64 - shift);
+}
+
+// Loads are little endian and unaligned, as on the console
+static uint64_t read64(uint8_t const* p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t read32(uint8_t const* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t round64(uint64_t acc, uint64_t input)
+{
+    acc += input * PRIME64_2;
+    acc = rotl(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static uint64_t merge_round(uint64_t acc, uint64_t value)
+{
+    acc ^= round64(0, value);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t xxh64(void const* data, size_t size, uint64_t seed)
+{
+    uint8_t const* p = data;
+    uint8_t const* const end = p + size;
+    uint64_t hash;
+
+    if (size >= 32)
+    {
+        // Four independent lanes of 8 bytes each
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+        uint8_t const* const limit = end - 32;
+        do
+        {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        hash = merge_round(hash, v1);
+        hash = merge_round(hash, v2);
+        hash = merge_round(hash, v3);
+        hash = merge_round(hash, v4);
+    }
+    else
+    {
+        hash = seed + PRIME64_5;
+    }
+    hash += size;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        hash ^= round64(0, read64(p));
+        hash = rotl(hash, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (p + 4 <= end)
+    {
+        hash ^= read32(p) * PRIME64_1;
+        hash = rotl(hash, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; ++p)
+    {
+        hash ^= *p * PRIME64_5;
+        hash = rotl(hash, 11) * PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
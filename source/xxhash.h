@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// XXH64, the 64-bit xxHash. Not cryptographic, but it runs at memory speed
+// and tells render targets apart just as well.
+uint64_t xxh64(void const* data, size_t size, uint64_t seed);
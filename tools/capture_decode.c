@@ -0,0 +1,556 @@
+// Turns the images of a capture, written by the app with --capture, into
+// PNGs. With a reference capture, for example one made with --capture-all on
+// a known good console, every image that is in both is also written next to
+// the reference and a map of the differing pixels.
+//
+// Usage: capture_decode <capture> <output directory> [reference capture]
+//
+// Writes <test>.png, and <test>.compare.png with the reference, the image
+// and the differences side by side. Formats without a conversion are
+// written deswizzled to <test>.bin.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deko3d.h>
+
+#include "capture.h"
+#include "fp16.h"
+#include "swizzle.h"
+#include "tile_codec.h"
+
+enum channel_type
+{
+    UNORM,
+    SNORM,
+    UINT,
+    SINT,
+    FLOAT,
+    HALF,
+    // Whole element, as a depth value
+    DEPTH24,
+};
+
+struct format_desc
+{
+    DkImageFormat format;
+    uint8_t bytes;
+    uint8_t channels;
+    enum channel_type type;
+    bool is_bgr;
+};
+
+#define FORMAT(name, bytes, channels, type) \
+    {DkImageFormat_##name, bytes, channels, type, false}
+#define FORMAT_BGR(name, bytes, channels, type) \
+    {DkImageFormat_##name, bytes, channels, type, true}
+
+// Formats with channels of 8, 16 or 32 bits, which render targets are
+static struct format_desc const formats[] = {
+    FORMAT(R8_Unorm, 1, 1, UNORM), FORMAT(R8_Snorm, 1, 1, SNORM),
+    FORMAT(R8_Uint, 1, 1, UINT), FORMAT(R8_Sint, 1, 1, SINT),
+    FORMAT(R16_Float, 2, 1, HALF), FORMAT(R16_Unorm, 2, 1, UNORM),
+    FORMAT(R16_Snorm, 2, 1, SNORM), FORMAT(R16_Uint, 2, 1, UINT),
+    FORMAT(R16_Sint, 2, 1, SINT), FORMAT(R32_Float, 4, 1, FLOAT),
+    FORMAT(R32_Uint, 4, 1, UINT), FORMAT(R32_Sint, 4, 1, SINT),
+    FORMAT(RG8_Unorm, 2, 2, UNORM), FORMAT(RG8_Snorm, 2, 2, SNORM),
+    FORMAT(RG8_Uint, 2, 2, UINT), FORMAT(RG8_Sint, 2, 2, SINT),
+    FORMAT(RG16_Float, 4, 2, HALF), FORMAT(RG16_Unorm, 4, 2, UNORM),
+    FORMAT(RG16_Snorm, 4, 2, SNORM), FORMAT(RG16_Uint, 4, 2, UINT),
+    FORMAT(RG16_Sint, 4, 2, SINT), FORMAT(RG32_Float, 8, 2, FLOAT),
+    FORMAT(RG32_Uint, 8, 2, UINT), FORMAT(RG32_Sint, 8, 2, SINT),
+    FORMAT(RGBA8_Unorm, 4, 4, UNORM), FORMAT(RGBA8_Snorm, 4, 4, SNORM),
+    FORMAT(RGBA8_Uint, 4, 4, UINT), FORMAT(RGBA8_Sint, 4, 4, SINT),
+    FORMAT(RGBA16_Float, 8, 4, HALF), FORMAT(RGBA16_Unorm, 8, 4, UNORM),
+    FORMAT(RGBA16_Snorm, 8, 4, SNORM), FORMAT(RGBA16_Uint, 8, 4, UINT),
+    FORMAT(RGBA16_Sint, 8, 4, SINT), FORMAT(RGBA32_Float, 16, 4, FLOAT),
+    FORMAT(RGBA32_Uint, 16, 4, UINT), FORMAT(RGBA32_Sint, 16, 4, SINT),
+    FORMAT(RGBX8_Unorm, 4, 3, UNORM), FORMAT(RGBX16_Float, 8, 3, HALF),
+    FORMAT(RGBX32_Float, 16, 3, FLOAT), FORMAT(RGBA8_Unorm_sRGB, 4, 4, UNORM),
+    FORMAT_BGR(BGRA8_Unorm, 4, 4, UNORM), FORMAT_BGR(BGRX8_Unorm, 4, 3, UNORM),
+    FORMAT_BGR(BGRA8_Unorm_sRGB, 4, 4, UNORM),
+    FORMAT(S8, 1, 1, UNORM), FORMAT(Z16, 2, 1, UNORM),
+    FORMAT(ZF32, 4, 1, FLOAT), FORMAT(Z24X8, 4, 1, DEPTH24),
+    FORMAT(Z24S8, 4, 1, DEPTH24),
+};
+
+struct image
+{
+    char* name;
+    struct capture_record record;
+    struct format_desc const* desc;
+    // Deswizzled, rows of width elements
+    uint8_t* linear;
+    size_t linear_size;
+    // Converted, NULL without a conversion
+    uint8_t* rgba;
+};
+
+struct image_list
+{
+    struct image* images;
+    size_t count;
+};
+
+static void* checked_malloc(size_t size)
+{
+    void* const data = malloc(size ? size : 1);
+    if (!data)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return data;
+}
+
+static struct format_desc const* find_format(uint32_t format)
+{
+    for (size_t i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i)
+    {
+        if (formats[i].format == format)
+            return &formats[i];
+    }
+    return NULL;
+}
+
+// A channel of 1, 2 or 4 bytes to 8 bits
+static uint8_t channel_to_u8(uint8_t const* p, int size, enum channel_type type)
+{
+    uint32_t value = 0;
+    memcpy(&value, p, size);
+    int const shift = size * 8 - 8;
+    switch (type)
+    {
+    case UNORM:
+        return value >> shift;
+    case SNORM:
+    case SINT:
+        // Zero to mid grey
+        return (value >> shift) ^ 0x80;
+    case UINT:
+        return value > 255 ? 255 : value;
+    case FLOAT:
+    case HALF:
+    {
+        float f;
+        if (type == HALF)
+            f = fp16_to_float((uint16_t)value);
+        else
+            memcpy(&f, &value, sizeof(f));
+        if (!(f > 0.0f))
+            return 0;
+        return f >= 1.0f ? 255 : (uint8_t)(f * 255.0f + 0.5f);
+    }
+    case DEPTH24:
+        return (value & 0xffffff) >> 16;
+    }
+    return 0;
+}
+
+static void convert(struct image* image)
+{
+    struct format_desc const* const desc = image->desc;
+    size_t const num_pixels =
+        (size_t)image->record.width * image->record.height;
+    int const channel_size = desc->bytes / desc->channels;
+    image->rgba = checked_malloc(num_pixels * 4);
+    for (size_t i = 0; i < num_pixels; ++i)
+    {
+        uint8_t const* const element = image->linear + i * desc->bytes;
+        uint8_t* const out = image->rgba + i * 4;
+        out[0] = out[1] = out[2] = 0;
+        out[3] = 255;
+        for (int c = 0; c < desc->channels && c < 4; ++c)
+        {
+            out[c] = channel_to_u8(
+                element + c * channel_size, channel_size, desc->type);
+        }
+        if (desc->is_bgr)
+        {
+            uint8_t const blue = out[0];
+            out[0] = out[2];
+            out[2] = blue;
+        }
+        // One channel images read best as grey
+        if (desc->channels == 1)
+            out[1] = out[2] = out[0];
+    }
+}
+
+// Reads the next image, false at the end. Errors are printed and end the
+// capture.
+static bool read_image(FILE* file, char const* path, struct image* image)
+{
+    memset(image, 0, sizeof(*image));
+    if (1 != fread(&image->record, sizeof(image->record), 1, file))
+        return false;
+    struct capture_record const* const record = &image->record;
+    if (record->name_size > 256 || record->payload_size > (1u << 30)
+        || record->size > (1u << 30))
+    {
+        fprintf(stderr, "%s: corrupt record\n", path);
+        return false;
+    }
+
+    image->name = checked_malloc(record->name_size + 1);
+    uint8_t* const payload = checked_malloc(record->payload_size);
+    uint8_t* const tiled = checked_malloc(record->size);
+    bool ok = record->name_size
+        == fread(image->name, 1, record->name_size, file);
+    image->name[record->name_size] = '\0';
+    ok = ok && record->payload_size
+        == fread(payload, 1, record->payload_size, file);
+
+    size_t offset = 0;
+    for (size_t tile = 0; ok && tile < record->size; tile += TILE_BYTES)
+    {
+        size_t const size = record->size - tile < TILE_BYTES
+            ? record->size - tile : TILE_BYTES;
+        size_t const read = tile_decode(payload + offset,
+            record->payload_size - offset, tiled + tile, size);
+        ok = read != 0;
+        offset += read;
+    }
+    free(payload);
+    if (!ok)
+    {
+        fprintf(stderr, "%s: %s is truncated or corrupt\n", path,
+            image->name);
+        free(tiled);
+        free(image->name);
+        image->name = NULL;
+        return false;
+    }
+
+    // Unknown formats deswizzle as bytes, rows as wide as the layout's
+    image->desc = find_format(record->format);
+    struct swizzle_layout layout;
+    swizzle_layout_init(&layout, record->width, record->height, 1,
+        image->desc ? image->desc->bytes : 1, 1, 1);
+    layout.block_height = record->block_height;
+    if (!image->desc)
+    {
+        size_t const row_blocks = (size_t)layout.block_height * GOB_SIZE
+            * ((record->height + GOB_HEIGHT * layout.block_height - 1)
+                / (GOB_HEIGHT * layout.block_height));
+        layout.width = record->size / row_blocks * GOB_WIDTH;
+    }
+    if (swizzle_size(&layout) > record->size)
+    {
+        fprintf(stderr, "%s: %s is smaller than its layout\n", path,
+            image->name);
+        free(tiled);
+        return true;
+    }
+    size_t const pitch = (size_t)layout.width * layout.bytes_per_element;
+    image->linear_size = pitch * layout.height;
+    image->linear = checked_malloc(image->linear_size);
+    deswizzle(&layout, image->linear, pitch, tiled);
+    free(tiled);
+    if (image->desc)
+        convert(image);
+    return true;
+}
+
+static bool read_capture(char const* path, struct image_list* list)
+{
+    memset(list, 0, sizeof(*list));
+    FILE* const file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+    struct capture_header header;
+    if (1 != fread(&header, sizeof(header), 1, file)
+        || header.magic != CAPTURE_MAGIC
+        || header.version != CAPTURE_VERSION)
+    {
+        fprintf(stderr, "%s is not a version %d capture\n", path,
+            CAPTURE_VERSION);
+        fclose(file);
+        return false;
+    }
+
+    size_t capacity = 0;
+    struct image image;
+    while (read_image(file, path, &image))
+    {
+        if (list->count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 64;
+            struct image* const images =
+                checked_malloc(capacity * sizeof(*images));
+            if (list->count)
+                memcpy(images, list->images, list->count * sizeof(*images));
+            free(list->images);
+            list->images = images;
+        }
+        list->images[list->count++] = image;
+    }
+    fclose(file);
+    return true;
+}
+
+static void free_capture(struct image_list* list)
+{
+    for (size_t i = 0; i < list->count; ++i)
+    {
+        free(list->images[i].name);
+        free(list->images[i].linear);
+        free(list->images[i].rgba);
+    }
+    free(list->images);
+}
+
+// PNG, RGBA8 with the image data in stored deflate blocks
+
+static uint32_t crc_table[256];
+
+static void init_crc_table(void)
+{
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+            c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+        crc_table[i] = c;
+    }
+}
+
+static uint32_t crc32_update(uint32_t crc, uint8_t const* data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+        crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+static void put_u32_be(uint8_t* p, uint32_t value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+static void write_chunk(
+    FILE* file, char const* type, uint8_t const* data, size_t size)
+{
+    uint8_t head[8];
+    put_u32_be(head, size);
+    memcpy(head + 4, type, 4);
+    fwrite(head, 1, 8, file);
+    fwrite(data, 1, size, file);
+    uint32_t crc = crc32_update(0xffffffff, head + 4, 4);
+    crc = crc32_update(crc, data, size) ^ 0xffffffff;
+    uint8_t tail[4];
+    put_u32_be(tail, crc);
+    fwrite(tail, 1, 4, file);
+}
+
+static bool write_png(
+    char const* path, uint8_t const* rgba, uint32_t width, uint32_t height)
+{
+    FILE* const file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+
+    // Every row starts with filter type 0
+    size_t const row_size = (size_t)width * 4 + 1;
+    size_t const raw_size = row_size * height;
+    uint8_t* const raw = checked_malloc(raw_size);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        raw[y * row_size] = 0;
+        memcpy(raw + y * row_size + 1, rgba + (size_t)y * width * 4,
+            (size_t)width * 4);
+    }
+
+    size_t const num_blocks = raw_size / 65535 + 1;
+    uint8_t* const zlib = checked_malloc(2 + raw_size + num_blocks * 5 + 4);
+    size_t size = 0;
+    zlib[size++] = 0x78;
+    zlib[size++] = 0x01;
+    uint32_t a = 1, b = 0;
+    for (size_t offset = 0, i = 0; i < num_blocks; ++i)
+    {
+        size_t const block = raw_size - offset < 65535
+            ? raw_size - offset : 65535;
+        zlib[size++] = i + 1 == num_blocks;
+        zlib[size++] = block & 0xff;
+        zlib[size++] = block >> 8;
+        zlib[size++] = ~block & 0xff;
+        zlib[size++] = (~block >> 8) & 0xff;
+        memcpy(zlib + size, raw + offset, block);
+        for (size_t j = 0; j < block; ++j)
+        {
+            a = (a + raw[offset + j]) % 65521;
+            b = (b + a) % 65521;
+        }
+        size += block;
+        offset += block;
+    }
+    put_u32_be(zlib + size, b << 16 | a);
+    size += 4;
+
+    static uint8_t const signature[8] = {137, 'P', 'N', 'G', 13, 10, 26, 10};
+    fwrite(signature, 1, sizeof(signature), file);
+    uint8_t ihdr[13] = {0};
+    put_u32_be(ihdr, width);
+    put_u32_be(ihdr + 4, height);
+    ihdr[8] = 8; // bits per channel
+    ihdr[9] = 6; // RGBA
+    write_chunk(file, "IHDR", ihdr, sizeof(ihdr));
+    write_chunk(file, "IDAT", zlib, size);
+    write_chunk(file, "IEND", NULL, 0);
+
+    free(zlib);
+    free(raw);
+    bool const ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
+
+static bool write_bin(char const* path, struct image const* image)
+{
+    FILE* const file = fopen(path, "wb");
+    if (!file)
+        return false;
+    fwrite(image->linear, 1, image->linear_size, file);
+    bool const ok = !ferror(file);
+    return fclose(file) == 0 && ok;
+}
+
+static struct image const* find_image(
+    struct image_list const* list, char const* name)
+{
+    for (size_t i = 0; i < list->count; ++i)
+    {
+        if (0 == strcmp(list->images[i].name, name))
+            return &list->images[i];
+    }
+    return NULL;
+}
+
+// Reference, image and differences in red over a darkened image. Returns the
+// number of differing pixels.
+static size_t write_compare(char const* path, struct image const* reference,
+    struct image const* image)
+{
+    uint32_t const width = image->record.width;
+    uint32_t const height = image->record.height;
+    uint8_t* const out = checked_malloc((size_t)width * 3 * height * 4);
+    size_t num_differing = 0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            size_t const i = ((size_t)y * width + x) * 4;
+            uint8_t* const row = out + (size_t)y * width * 3 * 4;
+            uint8_t const* const ref = reference->rgba + i;
+            uint8_t const* const got = image->rgba + i;
+            memcpy(row + x * 4, ref, 4);
+            memcpy(row + (width + x) * 4, got, 4);
+
+            uint8_t* const diff = row + (2 * width + x) * 4;
+            bool const differs = 0 != memcmp(
+                reference->linear + i / 4 * image->desc->bytes,
+                image->linear + i / 4 * image->desc->bytes,
+                image->desc->bytes);
+            num_differing += differs;
+            diff[0] = differs ? 255 : got[0] / 4;
+            diff[1] = differs ? 0 : got[1] / 4;
+            diff[2] = differs ? 0 : got[2] / 4;
+            diff[3] = 255;
+        }
+    }
+    write_png(path, out, width * 3, height);
+    free(out);
+    return num_differing;
+}
+
+static char* output_path(
+    char const* dir, char const* name, char const* extension)
+{
+    size_t const size = strlen(dir) + strlen(name) + strlen(extension) + 2;
+    char* const path = checked_malloc(size);
+    snprintf(path, size, "%s/%s%s", dir, name, extension);
+    // Names are test names, but keep them inside dir
+    for (char* c = path + strlen(dir) + 1; *c; ++c)
+    {
+        if (*c == '/' || *c == '\\')
+            *c = '_';
+    }
+    return path;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        fprintf(stderr, "Usage: %s <capture> <output directory> "
+            "[reference capture]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    init_crc_table();
+
+    struct image_list images;
+    struct image_list references = {0};
+    if (!read_capture(argv[1], &images)
+        || (argc == 4 && !read_capture(argv[3], &references)))
+        return EXIT_FAILURE;
+
+    bool ok = true;
+    for (size_t i = 0; i < images.count; ++i)
+    {
+        struct image const* const image = &images.images[i];
+        struct capture_record const* const record = &image->record;
+        printf("%-40s %4ux%-4u format %3u %s got 0x%016llx exp 0x%016llx",
+            image->name, record->width, record->height, record->format,
+            record->flags & CAPTURE_PASSED ? "passed" : "failed",
+            (unsigned long long)record->hash,
+            (unsigned long long)record->expected);
+        if (!image->linear)
+        {
+            printf("\n");
+            continue;
+        }
+
+        if (!image->rgba)
+        {
+            char* const path = output_path(argv[2], image->name, ".bin");
+            ok = write_bin(path, image) && ok;
+            printf(" no conversion, raw\n");
+            free(path);
+            continue;
+        }
+        char* const path = output_path(argv[2], image->name, ".png");
+        ok = write_png(path, image->rgba, record->width, record->height)
+            && ok;
+        free(path);
+
+        struct image const* const reference =
+            find_image(&references, image->name);
+        if (reference && reference->rgba
+            && reference->record.format == record->format
+            && reference->record.width == record->width
+            && reference->record.height == record->height)
+        {
+            char* const compare_path =
+                output_path(argv[2], image->name, ".compare.png");
+            printf(" %zu pixels differ",
+                write_compare(compare_path, reference, image));
+            free(compare_path);
+        }
+        printf("\n");
+    }
+
+    free_capture(&images);
+    free_capture(&references);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,508 @@
+// Exhaustive checks of the fp16 library. Every kernel compares the batch
+// functions against the scalar ones, and the scalar ones against a second,
+// libm based implementation, over all 2^16 halves or all 2^32 floats and
+// half pairs. Chunks of the input space are handed out to all threads, and
+// the time spent in the batch and scalar functions is reported as their
+// throughput.
+//
+// Usage: fp16_sweep [-j threads] [-s log2_stride] [kernels...]
+//
+// With -s only one in 2^log2_stride chunks is checked, for a quick run.
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fp16.h"
+
+#define CHUNK_SIZE (1 << 16)
+#define OLD_VALUE 0x5a5aa5a5
+
+struct worker;
+
+struct kernel
+{
+    char const* name;
+    int log2_count;
+    void (*check)(struct kernel const*, struct worker*, uint64_t, size_t);
+    enum fp16_rounding rounding;
+    enum fp16x2_op op;
+    struct fp16x2_mods mods;
+};
+
+struct sweep
+{
+    struct kernel const* kernel;
+    uint64_t num_chunks;
+    uint64_t chunk_stride;
+    atomic_uint_fast64_t next_chunk;
+
+    pthread_mutex_t lock;
+    uint64_t checked;
+    uint64_t mismatches;
+    uint64_t first_index;
+    char first_message[128];
+    uint64_t batch_ns;
+    uint64_t scalar_ns;
+};
+
+struct worker
+{
+    struct sweep* sweep;
+    uint64_t batch_ns;
+    uint64_t scalar_ns;
+    uint32_t a[CHUNK_SIZE], b[CHUNK_SIZE], old[CHUNK_SIZE];
+    uint32_t batch[CHUNK_SIZE], scalar[CHUNK_SIZE];
+    float floats[CHUNK_SIZE], float_batch[CHUNK_SIZE];
+    uint16_t halves[CHUNK_SIZE], half_batch[CHUNK_SIZE];
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t float_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static void mismatch(struct worker* w, uint64_t index, char const* what,
+    uint32_t expected, uint32_t got)
+{
+    struct sweep* const s = w->sweep;
+    pthread_mutex_lock(&s->lock);
+    if (s->mismatches++ == 0 || index < s->first_index)
+    {
+        s->first_index = index;
+        snprintf(s->first_message, sizeof(s->first_message),
+            "input 0x%llx: %s exp %08x got %08x", (unsigned long long)index,
+            what, expected, got);
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+static float ref_half_to_float(uint16_t half)
+{
+    int const exponent = (half >> 10) & 0x1f;
+    int const mantissa = half & 0x3ff;
+    float value;
+    if (exponent == 0)
+        value = ldexpf((float)mantissa, -24);
+    else if (exponent == 0x1f)
+        value = mantissa ? NAN : INFINITY;
+    else
+        value = ldexpf((float)(mantissa | 0x400), exponent - 25);
+    return half & 0x8000 ? -value : value;
+}
+
+// Rounds the magnitude, so the directed modes flip for negative values
+static double ref_round(double magnitude, int rounding, bool negative)
+{
+    switch (rounding)
+    {
+    case FP16_RN:
+        return nearbyint(magnitude);
+    case FP16_RM:
+        return negative ? ceil(magnitude) : floor(magnitude);
+    case FP16_RP:
+        return negative ? floor(magnitude) : ceil(magnitude);
+    default:
+        return trunc(magnitude);
+    }
+}
+
+static uint16_t ref_double_to_half(double value, int rounding)
+{
+    uint16_t const sign = signbit(value) ? 0x8000 : 0;
+    if (isnan(value))
+        return FP16_NAN;
+    double const magnitude = fabs(value);
+    if (isinf(magnitude))
+        return sign | 0x7c00;
+    if (magnitude == 0.0)
+        return sign;
+
+    int exponent;
+    frexp(magnitude, &exponent);
+    int ulp_exponent = exponent - 11;
+    if (ulp_exponent < -24)
+        ulp_exponent = -24;
+
+    double const ulps =
+        ref_round(ldexp(magnitude, -ulp_exponent), rounding, sign != 0);
+    double const rounded = ldexp(ulps, ulp_exponent);
+    if (rounded > 65504.0)
+    {
+        bool const to_infinity = rounding == FP16_RN
+            || (rounding == FP16_RM && sign) || (rounding == FP16_RP && !sign);
+        return sign | (to_infinity ? 0x7c00 : 0x7bff);
+    }
+    if (rounded < ldexp(1.0, -14))
+        return sign | (uint16_t)ldexp(rounded, 24);
+
+    frexp(rounded, &exponent);
+    uint16_t const mantissa =
+        (uint16_t)(ldexp(rounded, 11 - exponent) - 1024.0);
+    return sign | (uint16_t)((exponent + 14) << 10) | mantissa;
+}
+
+static uint32_t ref_half_to_int(uint16_t half, int rounding, int width,
+    bool is_signed)
+{
+    double value = ref_half_to_float(half);
+    if (isnan(value))
+        return 0;
+    switch (rounding)
+    {
+    case FP16_RN:
+        value = nearbyint(value);
+        break;
+    case FP16_RM:
+        value = floor(value);
+        break;
+    case FP16_RP:
+        value = ceil(value);
+        break;
+    default:
+        value = trunc(value);
+        break;
+    }
+    double const min = is_signed ? -ldexp(1.0, width - 1) : 0.0;
+    double const max = is_signed ? ldexp(1.0, width - 1) - 1.0
+                                 : ldexp(1.0, width) - 1.0;
+    return (uint32_t)(int64_t)fmin(fmax(value, min), max);
+}
+
+static float ref_modify(float value, bool abs, bool neg, bool ftz)
+{
+    if (abs)
+        value = fabsf(value);
+    if (neg)
+        value = -value;
+    if (ftz && fabsf(value) < ldexpf(1.0f, -14))
+        value = copysignf(0.0f, value);
+    return value;
+}
+
+static uint16_t ref_fp16x2_half(struct kernel const* k, uint16_t a,
+    uint16_t b)
+{
+    struct fp16x2_mods const* mods = &k->mods;
+    double const va = ref_modify(ref_half_to_float(a), mods->abs_a,
+        mods->neg_a, mods->ftz);
+    double const vb = ref_modify(ref_half_to_float(b), mods->abs_b,
+        mods->neg_b, mods->ftz);
+    double value = k->op == FP16X2_ADD ? va + vb : va * vb;
+    if (mods->sat)
+        value = value > 0.0 ? fmin(value, 1.0) : 0.0;
+    uint16_t half = ref_double_to_half(value, FP16_RN);
+    if (mods->ftz && (half & 0x7c00) == 0)
+        half &= 0x8000;
+    return half;
+}
+
+static void check_to_float(struct kernel const* k, struct worker* w,
+    uint64_t begin, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        w->halves[i] = (uint16_t)(begin + i);
+
+    uint64_t const start = now_ns();
+    fp16_to_float_n(w->float_batch, w->halves, count);
+    uint64_t const mid = now_ns();
+    for (size_t i = 0; i < count; ++i)
+        w->floats[i] = fp16_to_float(w->halves[i]);
+    w->batch_ns += mid - start;
+    w->scalar_ns += now_ns() - mid;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t const scalar = float_bits(w->floats[i]);
+        uint32_t const batch = float_bits(w->float_batch[i]);
+        uint32_t const ref = float_bits(ref_half_to_float(w->halves[i]));
+        if (batch != scalar)
+            mismatch(w, begin + i, "batch", scalar, batch);
+        if (scalar != ref)
+            mismatch(w, begin + i, "scalar", ref, scalar);
+    }
+}
+
+static void check_from_float(struct kernel const* k, struct worker* w,
+    uint64_t begin, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+        w->floats[i] = bits_float((uint32_t)(begin + i));
+
+    uint64_t const start = now_ns();
+    fp16_from_float_n(w->half_batch, w->floats, count, k->rounding);
+    uint64_t const mid = now_ns();
+    for (size_t i = 0; i < count; ++i)
+        w->halves[i] = fp16_from_float(w->floats[i], k->rounding);
+    w->batch_ns += mid - start;
+    w->scalar_ns += now_ns() - mid;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint16_t const ref = ref_double_to_half(w->floats[i], k->rounding);
+        if (w->half_batch[i] != w->halves[i])
+            mismatch(w, begin + i, "batch", w->halves[i], w->half_batch[i]);
+        if (w->halves[i] != ref)
+            mismatch(w, begin + i, "scalar", ref, w->halves[i]);
+    }
+}
+
+// The index selects the half in the low 16 bits, then the rounding and the
+// destination format
+static void check_to_int(struct kernel const* k, struct worker* w,
+    uint64_t begin, size_t count)
+{
+    static int const widths[] = {16, 16, 32, 32};
+    uint64_t const start = now_ns();
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t const index = begin + i;
+        int const format = (int)(index >> 18) & 3;
+        w->scalar[i] = fp16_to_int((uint16_t)index, (int)(index >> 16) & 3,
+            widths[format], !(format & 1));
+    }
+    w->scalar_ns += now_ns() - start;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint64_t const index = begin + i;
+        int const format = (int)(index >> 18) & 3;
+        uint32_t const ref = ref_half_to_int((uint16_t)index,
+            (int)(index >> 16) & 3, widths[format], !(format & 1));
+        if (w->scalar[i] != ref)
+            mismatch(w, index, "scalar", ref, w->scalar[i]);
+    }
+}
+
+// Each register holds two consecutive pairs, with a in the low and b in the
+// high 16 bits of the pair index
+static void check_fp16x2(struct kernel const* k, struct worker* w,
+    uint64_t begin, size_t count)
+{
+    size_t const num_regs = count / 2;
+    for (size_t i = 0; i < num_regs; ++i)
+    {
+        uint32_t const lo = (uint32_t)(begin + i * 2);
+        uint32_t const hi = lo + 1;
+        w->a[i] = (lo & 0xffff) | (hi & 0xffff) << 16;
+        w->b[i] = (lo >> 16) | (hi >> 16) << 16;
+        w->old[i] = OLD_VALUE;
+    }
+
+    uint64_t const start = now_ns();
+    fp16x2_execute_n(k->op, &k->mods, w->batch, w->a, w->b, NULL, w->old,
+        num_regs);
+    uint64_t const mid = now_ns();
+    for (size_t i = 0; i < num_regs; ++i)
+    {
+        w->scalar[i] =
+            fp16x2_execute(k->op, &k->mods, w->a[i], w->b[i], 0, w->old[i]);
+    }
+    w->batch_ns += mid - start;
+    w->scalar_ns += now_ns() - mid;
+
+    for (size_t i = 0; i < num_regs; ++i)
+    {
+        uint32_t ref = ref_fp16x2_half(k, w->a[i] & 0xffff, w->b[i] & 0xffff)
+            | (uint32_t)ref_fp16x2_half(k, w->a[i] >> 16, w->b[i] >> 16)
+                << 16;
+        if (k->mods.merge == FP16_MERGE_MRG_H0)
+            ref = (OLD_VALUE & 0xffff0000) | (ref & 0xffff);
+        else if (k->mods.merge == FP16_MERGE_MRG_H1)
+            ref = (OLD_VALUE & 0xffff) | (ref & 0xffff0000);
+
+        if (w->batch[i] != w->scalar[i])
+            mismatch(w, begin + i * 2, "batch", w->scalar[i], w->batch[i]);
+        if (w->scalar[i] != ref)
+            mismatch(w, begin + i * 2, "scalar", ref, w->scalar[i]);
+    }
+}
+
+static struct kernel const kernels[] =
+{
+    {"to_float", 16, check_to_float},
+    {"from_float.rn", 32, check_from_float, FP16_RN},
+    {"from_float.rm", 32, check_from_float, FP16_RM},
+    {"from_float.rp", 32, check_from_float, FP16_RP},
+    {"from_float.rz", 32, check_from_float, FP16_RZ},
+    {"to_int", 20, check_to_int},
+    {"hadd2", 32, check_fp16x2, .op = FP16X2_ADD},
+    {"hadd2.sat.ftz", 32, check_fp16x2, .op = FP16X2_ADD,
+        .mods = {.sat = true, .ftz = true}},
+    {"hmul2", 32, check_fp16x2, .op = FP16X2_MUL},
+    {"hmul2.sat.ftz", 32, check_fp16x2, .op = FP16X2_MUL,
+        .mods = {.sat = true, .ftz = true}},
+    {"hadd2.neg_a.abs_b.mrg_h0", 32, check_fp16x2, .op = FP16X2_ADD,
+        .mods = {.neg_a = true, .abs_b = true, .merge = FP16_MERGE_MRG_H0}},
+    {"hmul2.abs_a.neg_b.mrg_h1", 32, check_fp16x2, .op = FP16X2_MUL,
+        .mods = {.abs_a = true, .neg_b = true, .merge = FP16_MERGE_MRG_H1}},
+};
+
+#define NUM_KERNELS (sizeof(kernels) / sizeof(kernels[0]))
+
+static void* worker_main(void* arg)
+{
+    struct worker* const w = arg;
+    struct sweep* const s = w->sweep;
+    struct kernel const* const k = s->kernel;
+    uint64_t checked = 0;
+    for (;;)
+    {
+        uint64_t const chunk =
+            atomic_fetch_add(&s->next_chunk, 1) * s->chunk_stride;
+        if (chunk >= s->num_chunks)
+            break;
+        uint64_t const total = UINT64_C(1) << k->log2_count;
+        uint64_t const begin = chunk * CHUNK_SIZE;
+        size_t const count =
+            total - begin < CHUNK_SIZE ? (size_t)(total - begin) : CHUNK_SIZE;
+        k->check(k, w, begin, count);
+        checked += count;
+    }
+
+    pthread_mutex_lock(&s->lock);
+    s->checked += checked;
+    s->batch_ns += w->batch_ns;
+    s->scalar_ns += w->scalar_ns;
+    pthread_mutex_unlock(&s->lock);
+    return NULL;
+}
+
+static void print_rate(uint64_t count, uint64_t ns)
+{
+    if (ns)
+        printf("  %9.1f M/s", count * 1e3 / ns);
+    else
+        printf("  %13s", "-");
+}
+
+static bool run_kernel(struct kernel const* k, int num_threads,
+    int log2_stride)
+{
+    uint64_t const total = UINT64_C(1) << k->log2_count;
+    struct sweep s = {
+        .kernel = k,
+        .num_chunks = (total + CHUNK_SIZE - 1) / CHUNK_SIZE,
+        .chunk_stride = UINT64_C(1) << log2_stride,
+    };
+    atomic_init(&s.next_chunk, 0);
+    pthread_mutex_init(&s.lock, NULL);
+
+    struct worker* const workers = calloc(num_threads, sizeof(*workers));
+    pthread_t* const threads = calloc(num_threads, sizeof(*threads));
+    if (!workers || !threads)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t const start = now_ns();
+    for (int i = 0; i < num_threads; ++i)
+    {
+        workers[i].sweep = &s;
+        if (pthread_create(&threads[i], NULL, worker_main, &workers[i]))
+        {
+            fprintf(stderr, "failed to start worker thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < num_threads; ++i)
+        pthread_join(threads[i], NULL);
+    double const seconds = (now_ns() - start) * 1e-9;
+
+    // Rates are per thread, the wall time covers the reference checks too
+    printf("%-26s %11llu", k->name, (unsigned long long)s.checked);
+    print_rate(s.checked, s.batch_ns);
+    print_rate(s.checked, s.scalar_ns);
+    printf("  %7.1fs  %s\n", seconds, s.mismatches ? "FAILED" : "ok");
+    if (s.mismatches)
+    {
+        printf("    %llu mismatches, first at %s\n",
+            (unsigned long long)s.mismatches, s.first_message);
+    }
+
+    pthread_mutex_destroy(&s.lock);
+    free(threads);
+    free(workers);
+    return s.mismatches == 0;
+}
+
+static bool is_selected(char const* name, int argc, char** argv)
+{
+    if (argc == 0)
+        return true;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(name, argv[i]) == 0)
+            return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int log2_stride = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "j:s:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'j':
+            num_threads = atoi(optarg);
+            break;
+        case 's':
+            log2_stride = atoi(optarg);
+            break;
+        default:
+            fprintf(stderr,
+                "usage: %s [-j threads] [-s log2_stride] [kernels...]\n",
+                argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (num_threads < 1)
+        num_threads = 1;
+    if (log2_stride < 0 || log2_stride > 16)
+    {
+        fprintf(stderr, "stride must be between 0 and 16\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("%s kernels, %d threads\n", fp16_simd_name(), num_threads);
+    printf("%-26s %11s  %13s  %13s\n", "kernel", "inputs", "batch/thread",
+        "scalar/thread");
+
+    size_t failures = 0;
+    for (size_t i = 0; i < NUM_KERNELS; ++i)
+    {
+        if (!is_selected(kernels[i].name, argc - optind, argv + optind))
+            continue;
+        if (!run_kernel(&kernels[i], num_threads, log2_stride))
+            ++failures;
+    }
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
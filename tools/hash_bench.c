@@ -0,0 +1,115 @@
+// Throughput of the graphics tests' result hash against the SHA-256 it
+// replaced. The legacy path hashes the whole memblock, padding included, the
+// new one only the image's extent. The SHA-256 here is the portable one of
+// the host mock, on the console libnx uses the crypto extensions and the gap
+// is smaller.
+//
+// Usage: hash_bench [iterations]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <switch.h>
+
+#include "xxhash.h"
+
+#define MEMBLOCK_ALIGNMENT 0x1000
+#define NUM_GRAPHICS_TESTS 270
+
+struct extent
+{
+    char const* name;
+    size_t size;
+};
+
+// 64x64 render targets of each pixel size the tests use, and a large one
+static struct extent const extents[] = {
+    {"64x64 R8", 64 * 64},
+    {"64x64 RGBA8", 64 * 64 * 4},
+    {"64x64 RGBA16", 64 * 64 * 8},
+    {"64x64 RGBA32", 64 * 64 * 16},
+    {"1920x1080 RGBA8", 1920 * 1080 * 4},
+};
+
+static uint64_t now_ns(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+static size_t align_up(size_t size)
+{
+    return (size + MEMBLOCK_ALIGNMENT - 1) & ~(size_t)(MEMBLOCK_ALIGNMENT - 1);
+}
+
+// Keeps the results alive so the loops aren't optimized out
+static volatile uint64_t sink;
+
+static double bench_sha256(uint8_t const* data, size_t size, int iterations)
+{
+    uint64_t const start = now_ns();
+    for (int i = 0; i < iterations; ++i)
+    {
+        uint64_t sha256[4];
+        sha256CalculateHash(sha256, data, size);
+        sink ^= sha256[0] ^ sha256[1] ^ sha256[2] ^ sha256[3];
+    }
+    return (double)(now_ns() - start) / iterations;
+}
+
+static double bench_xxh64(uint8_t const* data, size_t size, int iterations)
+{
+    uint64_t const start = now_ns();
+    for (int i = 0; i < iterations; ++i)
+        sink ^= xxh64(data, size, 0);
+    return (double)(now_ns() - start) / iterations;
+}
+
+int main(int argc, char** argv)
+{
+    int const iterations = argc > 1 ? atoi(argv[1]) : 200;
+    if (iterations <= 0)
+    {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t const max_size =
+        align_up(extents[sizeof(extents) / sizeof(extents[0]) - 1].size);
+    uint8_t* const data = malloc(max_size);
+    if (!data)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < max_size; ++i)
+        data[i] = (uint8_t)(i * 2654435761u >> 24);
+
+    printf("%-16s %10s %12s %12s %12s %8s\n", "extent", "bytes",
+        "sha256 us", "xxh64 us", "xxh64 MB/s", "speedup");
+    for (size_t i = 0; i < sizeof(extents) / sizeof(extents[0]); ++i)
+    {
+        struct extent const* const extent = &extents[i];
+        int const count = extent->size > (1 << 20)
+            ? (iterations + 49) / 50 : iterations;
+        double const sha256_ns =
+            bench_sha256(data, align_up(extent->size), count);
+        double const xxh64_ns = bench_xxh64(data, extent->size, count * 10);
+        printf("%-16s %10zu %12.2f %12.2f %12.0f %7.1fx\n", extent->name,
+            extent->size, sha256_ns / 1000, xxh64_ns / 1000,
+            extent->size / xxh64_ns * 1000, sha256_ns / xxh64_ns);
+        if (i == 1)
+        {
+            printf("%-16s %10s %12.2f %12.2f   (%d tests)\n", "  whole suite",
+                "", sha256_ns * NUM_GRAPHICS_TESTS / 1000,
+                xxh64_ns * NUM_GRAPHICS_TESTS / 1000, NUM_GRAPHICS_TESTS);
+        }
+    }
+
+    free(data);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,1112 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/mman.h>
+
+#include <deko3d.h>
+
+#include "mock.h"
+
+// First GPU address handed out, addresses are never reused so traces stay
+// comparable between runs
+#define GPU_ADDR_BASE 0x100000000ull
+
+// Long report: 64-bit payload, 64-bit timestamp
+#define REPORT_SIZE 16
+
+// Command memory a recorded command takes, push data comes on top
+#define CMD_SIZE 16
+
+struct DkDevice_T
+{
+    DkGpuAddr next_gpu_addr;
+};
+
+struct DkMemBlock_T
+{
+    DkDevice device;
+    uint8_t* data;
+    uint32_t size;
+    uint32_t flags;
+    bool mapped;
+    DkGpuAddr gpu_addr;
+    DkMemBlock prev;
+    DkMemBlock next;
+};
+
+struct cmd_list
+{
+    DkCmdBuf cmdbuf;
+    size_t begin;
+    size_t end;
+    struct cmd_list* next;
+};
+
+struct DkCmdBuf_T
+{
+    DkDevice device;
+    struct mock_cmd* cmds;
+    size_t num_cmds;
+    size_t capacity;
+    size_t list_begin;
+    struct cmd_list* lists;
+    // Command memory left in the chunk added last, commands are only
+    // accounted for
+    uint32_t mem_left;
+    void* user_data;
+    DkCmdBufMemFunc add_mem;
+    // Lists submitted but not run yet, which clearing would lose
+    size_t num_pending;
+};
+
+// Render targets as BindRenderTargets records them, the depth target last
+#define MAX_COLOR_TARGETS 8
+
+struct render_target
+{
+    DkGpuAddr addr;
+    uint64_t size;
+};
+
+// Queued work, a list to run or a fence to signal when fence is set
+struct queue_op
+{
+    struct cmd_list const* list;
+    DkFence* fence;
+    struct queue_op* next;
+};
+
+struct DkQueue_T
+{
+    DkDevice device;
+    struct mock_program const* compute_program;
+    struct mock_program compute_program_storage;
+    DkGpuAddr storage_addr[MOCK_MAX_STORAGE_BUFFERS];
+    uint32_t storage_size[MOCK_MAX_STORAGE_BUFFERS];
+    struct render_target color_targets[MAX_COLOR_TARGETS];
+    uint32_t num_color_targets;
+    struct render_target depth_target;
+    // Work runs in submission order, MOCK_FENCE_DELAY lists behind
+    struct queue_op* ops;
+    struct queue_op** ops_tail;
+    size_t num_pending_lists;
+    DkQueue next;
+};
+
+// Layout of the DKSH headers the mock reads
+struct dksh_header
+{
+    uint32_t magic;
+    uint32_t header_sz;
+    uint32_t control_sz;
+    uint32_t code_sz;
+    uint32_t programs_off;
+    uint32_t num_programs;
+};
+
+struct dksh_program_header
+{
+    uint32_t type;
+    uint32_t entrypoint;
+    uint32_t num_gprs;
+    uint32_t constbuf1_off;
+    uint32_t constbuf1_sz;
+    uint32_t per_warp_scratch_sz;
+    uint32_t block_dims[3];
+    uint32_t shared_mem_sz;
+    uint32_t local_pos_mem_sz;
+    uint32_t local_neg_mem_sz;
+    uint32_t crs_sz;
+    uint32_t num_barriers;
+    uint32_t padding[2];
+};
+static_assert(sizeof(struct dksh_program_header) == 64, "Wrong size");
+static_assert(sizeof(struct mock_program) <= sizeof(DkShader), "Too big");
+
+struct image_layout
+{
+    DkImageType type;
+    DkImageFormat format;
+    uint32_t dimensions[3];
+    uint64_t size;
+};
+static_assert(sizeof(struct image_layout) <= sizeof(DkImageLayout), "Too big");
+
+struct image
+{
+    struct image_layout layout;
+    DkMemBlock memblock;
+    uint32_t offset;
+};
+static_assert(sizeof(struct image) <= sizeof(DkImage), "Too big");
+
+static DkMemBlock memblocks;
+static DkQueue queues;
+static struct mock_hooks hooks;
+static FILE* trace;
+static bool trace_opened;
+
+static void fail(char const* message)
+{
+    fprintf(stderr, "deko3d mock: %s\n", message);
+    exit(EXIT_FAILURE);
+}
+
+static void* checked_calloc(size_t count, size_t size)
+{
+    void* const data = calloc(count, size);
+    if (!data && count && size)
+        fail("out of memory");
+    return data;
+}
+
+static void* copy(void const* data, size_t size)
+{
+    if (!data || !size)
+        return NULL;
+    void* const copied = checked_calloc(1, size);
+    memcpy(copied, data, size);
+    return copied;
+}
+
+void mock_set_hooks(struct mock_hooks const* new_hooks)
+{
+    hooks = *new_hooks;
+}
+
+void* mock_gpu_to_cpu(DkGpuAddr addr, uint32_t size)
+{
+    for (DkMemBlock block = memblocks; block; block = block->next)
+    {
+        if (addr >= block->gpu_addr
+            && addr + size <= block->gpu_addr + block->size)
+            return block->data + (addr - block->gpu_addr);
+    }
+    return NULL;
+}
+
+static char const* const cmd_names[NUM_MOCK_CMDS] = {
+    "Barrier", "BindShaders", "BindStorageBuffer", "BindUniformBuffer",
+    "DispatchCompute", "PushData", "ReportCounter", "BindImageDescriptorSet",
+    "BindSamplerDescriptorSet", "BindTexture", "BindImage",
+    "BindRenderTargets", "SetViewports", "SetScissors", "ClearColor",
+    "ClearDepthStencil", "Draw", "BindDepthStencilState",
+    "BindVtxAttribState", "BindVtxBufferState", "BindVtxBuffers",
+};
+
+char const* mock_cmd_name(enum mock_cmd_type type)
+{
+    return type < NUM_MOCK_CMDS ? cmd_names[type] : "Unknown";
+}
+
+// Device
+
+void dkDeviceMakerDefaults(DkDeviceMaker* maker)
+{
+    memset(maker, 0, sizeof(*maker));
+}
+
+DkDevice dkDeviceCreate(DkDeviceMaker const* maker)
+{
+    (void)maker;
+    DkDevice const device = checked_calloc(1, sizeof(*device));
+    device->next_gpu_addr = GPU_ADDR_BASE;
+    return device;
+}
+
+void dkDeviceDestroy(DkDevice obj)
+{
+    free(obj);
+}
+
+// Memory blocks
+
+void dkMemBlockMakerDefaults(
+    DkMemBlockMaker* maker, DkDevice device, uint32_t size)
+{
+    memset(maker, 0, sizeof(*maker));
+    maker->device = device;
+    maker->size = size;
+    maker->flags = DkMemBlockFlags_CpuUncached | DkMemBlockFlags_GpuCached;
+}
+
+DkMemBlock dkMemBlockCreate(DkMemBlockMaker const* maker)
+{
+    if (maker->size == 0 || maker->size % DK_MEMBLOCK_ALIGNMENT)
+        fail("memory block size is not aligned");
+
+    DkMemBlock const block = checked_calloc(1, sizeof(*block));
+    block->device = maker->device;
+    block->size = maker->size;
+    block->flags = maker->flags;
+
+    char const* const use_mmap = getenv("MOCK_MMAP");
+    if (use_mmap && 0 == strcmp(use_mmap, "1"))
+    {
+        block->data = mmap(NULL, block->size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (block->data == MAP_FAILED)
+            fail("out of memory");
+        block->mapped = true;
+    }
+    else
+    {
+        // Zeroed either way so runs are deterministic
+        block->data = aligned_alloc(DK_MEMBLOCK_ALIGNMENT, block->size);
+        if (!block->data)
+            fail("out of memory");
+        memset(block->data, 0, block->size);
+    }
+
+    block->gpu_addr = maker->device->next_gpu_addr;
+    maker->device->next_gpu_addr += block->size;
+
+    block->next = memblocks;
+    if (memblocks)
+        memblocks->prev = block;
+    memblocks = block;
+    return block;
+}
+
+void dkMemBlockDestroy(DkMemBlock obj)
+{
+    if (obj->prev)
+        obj->prev->next = obj->next;
+    else
+        memblocks = obj->next;
+    if (obj->next)
+        obj->next->prev = obj->prev;
+
+    if (obj->mapped)
+        munmap(obj->data, obj->size);
+    else
+        free(obj->data);
+    free(obj);
+}
+
+void* dkMemBlockGetCpuAddr(DkMemBlock obj)
+{
+    return obj->data;
+}
+
+DkGpuAddr dkMemBlockGetGpuAddr(DkMemBlock obj)
+{
+    return obj->gpu_addr;
+}
+
+uint32_t dkMemBlockGetSize(DkMemBlock obj)
+{
+    return obj->size;
+}
+
+DkResult dkMemBlockFlushCpuCache(
+    DkMemBlock obj, uint32_t offset, uint32_t size)
+{
+    (void)obj;
+    (void)offset;
+    (void)size;
+    return DkResult_Success;
+}
+
+// Command buffers
+
+void dkCmdBufMakerDefaults(DkCmdBufMaker* maker, DkDevice device)
+{
+    memset(maker, 0, sizeof(*maker));
+    maker->device = device;
+}
+
+DkCmdBuf dkCmdBufCreate(DkCmdBufMaker const* maker)
+{
+    DkCmdBuf const cmdbuf = checked_calloc(1, sizeof(*cmdbuf));
+    cmdbuf->device = maker->device;
+    cmdbuf->user_data = maker->userData;
+    cmdbuf->add_mem = maker->cbAddMem;
+    return cmdbuf;
+}
+
+void dkCmdBufClear(DkCmdBuf obj)
+{
+    if (obj->num_pending)
+        fail("command buffer cleared while its lists are pending");
+    for (size_t i = 0; i < obj->num_cmds; ++i)
+        free(obj->cmds[i].data);
+    obj->num_cmds = 0;
+    obj->list_begin = 0;
+
+    while (obj->lists)
+    {
+        struct cmd_list* const next = obj->lists->next;
+        free(obj->lists);
+        obj->lists = next;
+    }
+}
+
+void dkCmdBufDestroy(DkCmdBuf obj)
+{
+    dkCmdBufClear(obj);
+    free(obj->cmds);
+    free(obj);
+}
+
+// Commands live in host memory, the memory given is only accounted for. Like
+// deko3d, recording continues in the new chunk and clearing keeps the chunk.
+void dkCmdBufAddMemory(
+    DkCmdBuf obj, DkMemBlock mem, uint32_t offset, uint32_t size)
+{
+    if (!mem || offset + size > mem->size)
+        fail("command memory outside of its memory block");
+    obj->mem_left = size;
+}
+
+static void use_memory(DkCmdBuf obj, size_t size)
+{
+    if (size > obj->mem_left && obj->add_mem)
+        obj->add_mem(obj->user_data, obj, size);
+    if (size > obj->mem_left)
+        fail("out of command memory");
+    obj->mem_left -= size;
+}
+
+DkCmdList dkCmdBufFinishList(DkCmdBuf obj)
+{
+    struct cmd_list* const list = checked_calloc(1, sizeof(*list));
+    list->cmdbuf = obj;
+    list->begin = obj->list_begin;
+    list->end = obj->num_cmds;
+    list->next = obj->lists;
+    obj->lists = list;
+    obj->list_begin = obj->num_cmds;
+    return (DkCmdList)list;
+}
+
+static struct mock_cmd* record(DkCmdBuf obj, enum mock_cmd_type type)
+{
+    use_memory(obj, CMD_SIZE);
+    if (obj->num_cmds == obj->capacity)
+    {
+        obj->capacity = obj->capacity ? obj->capacity * 2 : 64;
+        obj->cmds = realloc(obj->cmds, obj->capacity * sizeof(*obj->cmds));
+        if (!obj->cmds)
+            fail("out of memory");
+    }
+    struct mock_cmd* const cmd = &obj->cmds[obj->num_cmds++];
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->type = type;
+    return cmd;
+}
+
+static void record_data(struct mock_cmd* cmd, void const* data, size_t size)
+{
+    cmd->data = copy(data, size);
+    cmd->data_size = size;
+}
+
+void dkCmdBufBarrier(DkCmdBuf obj, DkBarrier mode, uint32_t invalidateFlags)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BARRIER);
+    cmd->args[0] = mode;
+    cmd->args[1] = invalidateFlags;
+}
+
+// Shaders
+
+void dkShaderMakerDefaults(
+    DkShaderMaker* maker, DkMemBlock codeMem, uint32_t codeOffset)
+{
+    memset(maker, 0, sizeof(*maker));
+    maker->codeMem = codeMem;
+    maker->codeOffset = codeOffset;
+}
+
+void dkShaderInitialize(DkShader* obj, DkShaderMaker const* maker)
+{
+    uint8_t const* const base = maker->codeMem->data + maker->codeOffset;
+    uint8_t const* const control = maker->control ? maker->control : base;
+
+    struct dksh_header header;
+    memcpy(&header, control, sizeof(header));
+    if (header.magic != 0x48534B44 || maker->programId >= header.num_programs)
+        fail("invalid DKSH");
+
+    struct dksh_program_header program;
+    memcpy(&program, control + header.programs_off
+        + maker->programId * sizeof(program), sizeof(program));
+    if (program.entrypoint >= header.code_sz)
+        fail("entrypoint outside of the DKSH code");
+
+    // Without a separate control section the code follows it in code memory
+    uint8_t const* const code =
+        maker->control ? base : base + header.control_sz;
+
+    struct mock_program const mock = {
+        .stage = (DkStage)program.type,
+        .code = code + program.entrypoint,
+        .code_size = header.code_sz - program.entrypoint,
+        .num_gprs = program.num_gprs,
+        .block_dims = {program.block_dims[0], program.block_dims[1],
+            program.block_dims[2]},
+        .local_mem_size = program.local_pos_mem_sz,
+        .shared_mem_size = program.shared_mem_sz,
+    };
+    memset(obj, 0, sizeof(*obj));
+    memcpy(obj, &mock, sizeof(mock));
+}
+
+bool dkShaderIsValid(DkShader const* obj)
+{
+    return ((struct mock_program const*)obj)->code != NULL;
+}
+
+DkStage dkShaderGetStage(DkShader const* obj)
+{
+    return ((struct mock_program const*)obj)->stage;
+}
+
+void dkCmdBufBindShaders(DkCmdBuf obj, uint32_t stageMask,
+    DkShader const* const shaders[], uint32_t numShaders)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_SHADERS);
+    cmd->args[0] = stageMask;
+    cmd->args[1] = numShaders;
+    cmd->data = checked_calloc(numShaders, sizeof(struct mock_program));
+    cmd->data_size = numShaders * sizeof(struct mock_program);
+    for (uint32_t i = 0; i < numShaders; ++i)
+    {
+        memcpy((struct mock_program*)cmd->data + i, shaders[i],
+            sizeof(struct mock_program));
+    }
+}
+
+void dkCmdBufBindStorageBuffer(DkCmdBuf obj, DkStage stage, uint32_t id,
+    DkGpuAddr bufAddr, uint32_t bufSize)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_STORAGE_BUFFER);
+    cmd->args[0] = stage;
+    cmd->args[1] = id;
+    cmd->args[2] = bufSize;
+    cmd->addr = bufAddr;
+}
+
+void dkCmdBufBindUniformBuffer(DkCmdBuf obj, DkStage stage, uint32_t id,
+    DkGpuAddr bufAddr, uint32_t bufSize)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_UNIFORM_BUFFER);
+    cmd->args[0] = stage;
+    cmd->args[1] = id;
+    cmd->args[2] = bufSize;
+    cmd->addr = bufAddr;
+}
+
+void dkCmdBufDispatchCompute(DkCmdBuf obj, uint32_t numGroupsX,
+    uint32_t numGroupsY, uint32_t numGroupsZ)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_DISPATCH_COMPUTE);
+    cmd->args[0] = numGroupsX;
+    cmd->args[1] = numGroupsY;
+    cmd->args[2] = numGroupsZ;
+}
+
+void dkCmdBufPushData(
+    DkCmdBuf obj, DkGpuAddr addr, void const* data, uint32_t size)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_PUSH_DATA);
+    use_memory(obj, size);
+    cmd->addr = addr;
+    record_data(cmd, data, size);
+}
+
+void dkCmdBufReportCounter(DkCmdBuf obj, DkCounter type, DkGpuAddr addr)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_REPORT_COUNTER);
+    cmd->args[0] = type;
+    cmd->addr = addr;
+}
+
+// Images
+
+static uint32_t format_size(DkImageFormat format)
+{
+    switch (format)
+    {
+    case DkImageFormat_R8_Unorm: case DkImageFormat_R8_Snorm:
+    case DkImageFormat_R8_Uint: case DkImageFormat_R8_Sint:
+    case DkImageFormat_S8:
+        return 1;
+    case DkImageFormat_R16_Float: case DkImageFormat_R16_Unorm:
+    case DkImageFormat_R16_Snorm: case DkImageFormat_R16_Uint:
+    case DkImageFormat_R16_Sint: case DkImageFormat_RG8_Unorm:
+    case DkImageFormat_RG8_Snorm: case DkImageFormat_RG8_Uint:
+    case DkImageFormat_RG8_Sint: case DkImageFormat_Z16:
+    case DkImageFormat_RGBA4_Unorm: case DkImageFormat_RGB5_Unorm:
+    case DkImageFormat_RGB5A1_Unorm: case DkImageFormat_RGB565_Unorm:
+    case DkImageFormat_BGR565_Unorm: case DkImageFormat_BGR5_Unorm:
+    case DkImageFormat_BGR5A1_Unorm: case DkImageFormat_A5BGR5_Unorm:
+        return 2;
+    case DkImageFormat_RG32_Float: case DkImageFormat_RG32_Uint:
+    case DkImageFormat_RG32_Sint: case DkImageFormat_RGBA16_Float:
+    case DkImageFormat_RGBA16_Unorm: case DkImageFormat_RGBA16_Snorm:
+    case DkImageFormat_RGBA16_Uint: case DkImageFormat_RGBA16_Sint:
+    case DkImageFormat_RGBX16_Float: case DkImageFormat_RGBX16_Unorm:
+    case DkImageFormat_RGBX16_Snorm: case DkImageFormat_RGBX16_Uint:
+    case DkImageFormat_RGBX16_Sint: case DkImageFormat_ZF32_X24S8:
+        return 8;
+    case DkImageFormat_RGB32_Float: case DkImageFormat_RGB32_Uint:
+    case DkImageFormat_RGB32_Sint:
+        return 12;
+    case DkImageFormat_RGBA32_Float: case DkImageFormat_RGBA32_Uint:
+    case DkImageFormat_RGBA32_Sint: case DkImageFormat_RGBX32_Float:
+    case DkImageFormat_RGBX32_Uint: case DkImageFormat_RGBX32_Sint:
+        return 16;
+    default:
+        // Every other format, compressed ones included, is given 4 bytes a
+        // texel, which is never less than they need
+        return 4;
+    }
+}
+
+void dkImageLayoutMakerDefaults(DkImageLayoutMaker* maker, DkDevice device)
+{
+    memset(maker, 0, sizeof(*maker));
+    maker->device = device;
+    maker->type = DkImageType_2D;
+    maker->dimensions[0] = maker->dimensions[1] = maker->dimensions[2] = 1;
+    maker->mipLevels = 1;
+}
+
+// Images are laid out linearly, one mip level, padded to 512 bytes
+void dkImageLayoutInitialize(
+    DkImageLayout* obj, DkImageLayoutMaker const* maker)
+{
+    struct image_layout layout = {
+        .type = maker->type,
+        .format = maker->format,
+    };
+    uint64_t size = format_size(maker->format);
+    for (int i = 0; i < 3; ++i)
+    {
+        layout.dimensions[i] = maker->dimensions[i] ? maker->dimensions[i] : 1;
+        size *= layout.dimensions[i];
+    }
+    layout.size = (size + 511) & ~(uint64_t)511;
+
+    memset(obj, 0, sizeof(*obj));
+    memcpy(obj, &layout, sizeof(layout));
+}
+
+uint64_t dkImageLayoutGetSize(DkImageLayout const* obj)
+{
+    return ((struct image_layout const*)obj)->size;
+}
+
+uint32_t dkImageLayoutGetAlignment(DkImageLayout const* obj)
+{
+    (void)obj;
+    return 512;
+}
+
+void dkImageInitialize(DkImage* obj, DkImageLayout const* layout,
+    DkMemBlock memBlock, uint32_t offset)
+{
+    struct image image = {
+        .memblock = memBlock,
+        .offset = offset,
+    };
+    memcpy(&image.layout, layout, sizeof(image.layout));
+    if (offset + image.layout.size > memBlock->size)
+        fail("image outside of its memory block");
+
+    memset(obj, 0, sizeof(*obj));
+    memcpy(obj, &image, sizeof(image));
+}
+
+DkGpuAddr dkImageGetGpuAddr(DkImage const* obj)
+{
+    struct image const* const image = (struct image const*)obj;
+    return image->memblock->gpu_addr + image->offset;
+}
+
+void dkImageViewDefaults(DkImageView* obj, DkImage const* pImage)
+{
+    memset(obj, 0, sizeof(*obj));
+    obj->pImage = pImage;
+    obj->swizzle[0] = DkImageSwizzle_Red;
+    obj->swizzle[1] = DkImageSwizzle_Green;
+    obj->swizzle[2] = DkImageSwizzle_Blue;
+    obj->swizzle[3] = DkImageSwizzle_Alpha;
+}
+
+// Descriptors keep what a hook would need to find the image
+void dkImageDescriptorInitialize(DkImageDescriptor* obj,
+    DkImageView const* view, bool usesLoadStore, bool decayMS)
+{
+    struct image const* const image = (struct image const*)view->pImage;
+    DkGpuAddr const addr = dkImageGetGpuAddr(view->pImage);
+    DkImageFormat const format =
+        view->format ? view->format : image->layout.format;
+
+    memset(obj, 0, sizeof(*obj));
+    obj->storage[0] = (uint32_t)addr;
+    obj->storage[1] = (uint32_t)(addr >> 32);
+    obj->storage[2] = format;
+    obj->storage[3] = view->type ? view->type : image->layout.type;
+    obj->storage[4] = image->layout.dimensions[0];
+    obj->storage[5] = image->layout.dimensions[1];
+    obj->storage[6] = image->layout.dimensions[2];
+    obj->storage[7] = usesLoadStore | decayMS << 1;
+}
+
+void dkSamplerDescriptorInitialize(
+    DkSamplerDescriptor* obj, DkSampler const* sampler)
+{
+    memset(obj, 0, sizeof(*obj));
+    obj->storage[0] = sampler->minFilter | sampler->magFilter << 4
+        | sampler->mipFilter << 8;
+    for (int i = 0; i < 3; ++i)
+        obj->storage[1] |= sampler->wrapMode[i] << (i * 4);
+    for (int i = 0; i < 4; ++i)
+        obj->storage[2 + i] = sampler->borderColor[i].value_ui;
+}
+
+void dkCmdBufBindImageDescriptorSet(
+    DkCmdBuf obj, DkGpuAddr setAddr, uint32_t numDescriptors)
+{
+    struct mock_cmd* const cmd =
+        record(obj, MOCK_CMD_BIND_IMAGE_DESCRIPTOR_SET);
+    cmd->args[0] = numDescriptors;
+    cmd->addr = setAddr;
+}
+
+void dkCmdBufBindSamplerDescriptorSet(
+    DkCmdBuf obj, DkGpuAddr setAddr, uint32_t numDescriptors)
+{
+    struct mock_cmd* const cmd =
+        record(obj, MOCK_CMD_BIND_SAMPLER_DESCRIPTOR_SET);
+    cmd->args[0] = numDescriptors;
+    cmd->addr = setAddr;
+}
+
+void dkCmdBufBindTexture(
+    DkCmdBuf obj, DkStage stage, uint32_t id, DkResHandle handle)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_TEXTURE);
+    cmd->args[0] = stage;
+    cmd->args[1] = id;
+    cmd->args[2] = handle;
+}
+
+void dkCmdBufBindImage(
+    DkCmdBuf obj, DkStage stage, uint32_t id, DkResHandle handle)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_IMAGE);
+    cmd->args[0] = stage;
+    cmd->args[1] = id;
+    cmd->args[2] = handle;
+}
+
+// Rendering is recorded for the hooks. Clears fill their target with the raw
+// clear value, whatever the format, so that results depend on when the clear
+// ran. Nothing is rasterized.
+
+static struct render_target make_target(DkImageView const* view)
+{
+    struct image const* const image = (struct image const*)view->pImage;
+    return (struct render_target){
+        dkImageGetGpuAddr(view->pImage), image->layout.size,
+    };
+}
+
+void dkCmdBufBindRenderTargets(DkCmdBuf obj,
+    DkImageView const* const colorTargets[], uint32_t numColorTargets,
+    DkImageView const* depthTarget)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_RENDER_TARGETS);
+    cmd->args[0] = numColorTargets;
+    cmd->args[1] = depthTarget != NULL;
+
+    if (numColorTargets > MAX_COLOR_TARGETS)
+        fail("too many color targets");
+    uint32_t const num_targets = numColorTargets + (depthTarget != NULL);
+    struct render_target* const targets =
+        checked_calloc(num_targets, sizeof(*targets));
+    for (uint32_t i = 0; i < numColorTargets; ++i)
+        targets[i] = make_target(colorTargets[i]);
+    if (depthTarget)
+        targets[numColorTargets] = make_target(depthTarget);
+    cmd->data = targets;
+    cmd->data_size = num_targets * sizeof(*targets);
+}
+
+void dkCmdBufSetViewports(DkCmdBuf obj, uint32_t firstId,
+    DkViewport const viewports[], uint32_t numViewports)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_SET_VIEWPORTS);
+    cmd->args[0] = firstId;
+    cmd->args[1] = numViewports;
+    record_data(cmd, viewports, numViewports * sizeof(DkViewport));
+}
+
+void dkCmdBufSetScissors(DkCmdBuf obj, uint32_t firstId,
+    DkScissor const scissors[], uint32_t numScissors)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_SET_SCISSORS);
+    cmd->args[0] = firstId;
+    cmd->args[1] = numScissors;
+    record_data(cmd, scissors, numScissors * sizeof(DkScissor));
+}
+
+void dkCmdBufClearColor(DkCmdBuf obj, uint32_t targetId, uint32_t clearMask,
+    void const* clearData)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_CLEAR_COLOR);
+    cmd->args[0] = targetId;
+    cmd->args[1] = clearMask;
+    record_data(cmd, clearData, 4 * sizeof(uint32_t));
+}
+
+void dkCmdBufClearDepthStencil(DkCmdBuf obj, bool clearDepth,
+    float depthValue, uint8_t stencilMask, uint8_t stencilValue)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_CLEAR_DEPTH_STENCIL);
+    cmd->args[0] = clearDepth;
+    memcpy(&cmd->args[1], &depthValue, sizeof(depthValue));
+    cmd->args[2] = stencilMask;
+    cmd->args[3] = stencilValue;
+}
+
+void dkCmdBufDraw(DkCmdBuf obj, DkPrimitive prim, uint32_t vertexCount,
+    uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_DRAW);
+    cmd->args[0] = prim;
+    cmd->args[1] = vertexCount;
+    cmd->args[2] = instanceCount;
+    cmd->args[3] = firstVertex;
+    cmd->args[4] = firstInstance;
+}
+
+void dkDepthStencilStateDefaults(DkDepthStencilState* obj)
+{
+    memset(obj, 0, sizeof(*obj));
+    obj->depthTestEnable = 1;
+    obj->depthWriteEnable = 1;
+}
+
+void dkCmdBufBindDepthStencilState(
+    DkCmdBuf obj, DkDepthStencilState const* state)
+{
+    struct mock_cmd* const cmd =
+        record(obj, MOCK_CMD_BIND_DEPTH_STENCIL_STATE);
+    record_data(cmd, state, sizeof(*state));
+}
+
+void dkCmdBufBindVtxAttribState(DkCmdBuf obj,
+    DkVtxAttribState const attribs[], uint32_t numAttribs)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_VTX_ATTRIB_STATE);
+    cmd->args[0] = numAttribs;
+    record_data(cmd, attribs, numAttribs * sizeof(DkVtxAttribState));
+}
+
+void dkCmdBufBindVtxBufferState(DkCmdBuf obj,
+    DkVtxBufferState const buffers[], uint32_t numBuffers)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_VTX_BUFFER_STATE);
+    cmd->args[0] = numBuffers;
+    record_data(cmd, buffers, numBuffers * sizeof(DkVtxBufferState));
+}
+
+void dkCmdBufBindVtxBuffers(DkCmdBuf obj, uint32_t firstId,
+    DkBufExtents const buffers[], uint32_t numBuffers)
+{
+    struct mock_cmd* const cmd = record(obj, MOCK_CMD_BIND_VTX_BUFFERS);
+    cmd->args[0] = firstId;
+    cmd->args[1] = numBuffers;
+    record_data(cmd, buffers, numBuffers * sizeof(DkBufExtents));
+}
+
+// Queues
+
+void dkQueueMakerDefaults(DkQueueMaker* maker, DkDevice device)
+{
+    memset(maker, 0, sizeof(*maker));
+    maker->device = device;
+    maker->flags = DkQueueFlags_Graphics | DkQueueFlags_Compute;
+}
+
+DkQueue dkQueueCreate(DkQueueMaker const* maker)
+{
+    DkQueue const queue = checked_calloc(1, sizeof(*queue));
+    queue->device = maker->device;
+    queue->ops_tail = &queue->ops;
+    queue->next = queues;
+    queues = queue;
+    return queue;
+}
+
+void dkQueueDestroy(DkQueue obj)
+{
+    dkQueueWaitIdle(obj);
+    DkQueue* link = &queues;
+    while (*link != obj)
+        link = &(*link)->next;
+    *link = obj->next;
+    free(obj);
+}
+
+static void write_trace(struct mock_cmd const* cmd)
+{
+    if (!trace_opened)
+    {
+        trace_opened = true;
+        char const* const path = getenv("MOCK_TRACE");
+        if (path && !(trace = fopen(path, "w")))
+            fail("cannot open the trace file");
+    }
+    if (!trace)
+        return;
+
+    fprintf(trace, "%s", mock_cmd_name(cmd->type));
+    for (int i = 0; i < 5; ++i)
+        fprintf(trace, " %" PRIu32, cmd->args[i]);
+    fprintf(trace, " 0x%" PRIx64 " %" PRIu32 "\n", cmd->addr,
+        cmd->data_size);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+static void execute_dispatch(DkQueue queue, struct mock_cmd const* cmd)
+{
+    if (!queue->compute_program || !hooks.dispatch)
+        return;
+
+    struct mock_dispatch dispatch = {
+        .program = queue->compute_program,
+        .grid_dims = {cmd->args[0], cmd->args[1], cmd->args[2]},
+    };
+    for (int i = 0; i < MOCK_MAX_STORAGE_BUFFERS; ++i)
+    {
+        if (!queue->storage_size[i])
+            continue;
+        dispatch.storage[i].data =
+            mock_gpu_to_cpu(queue->storage_addr[i], queue->storage_size[i]);
+        if (!dispatch.storage[i].data)
+            fail("storage buffer outside of any memory block");
+        dispatch.storage[i].size = queue->storage_size[i];
+    }
+    hooks.dispatch(hooks.user, &dispatch);
+}
+
+static void fill_target(struct render_target const* target,
+    void const* value, size_t value_size)
+{
+    if (!target->size)
+        return;
+    uint8_t* const dst = mock_gpu_to_cpu(target->addr, target->size);
+    if (!dst)
+        fail("render target outside of any memory block");
+    for (uint64_t i = 0; i < target->size; ++i)
+        dst[i] = ((uint8_t const*)value)[i % value_size];
+}
+
+static void execute(DkQueue queue, struct mock_cmd const* cmd)
+{
+    write_trace(cmd);
+    if (hooks.command)
+        hooks.command(hooks.user, cmd);
+
+    switch (cmd->type)
+    {
+    case MOCK_CMD_BIND_SHADERS:
+    {
+        struct mock_program const* const programs = cmd->data;
+        for (uint32_t i = 0; i < cmd->args[1]; ++i)
+        {
+            if (programs[i].stage != DkStage_Compute)
+                continue;
+            queue->compute_program_storage = programs[i];
+            queue->compute_program = &queue->compute_program_storage;
+        }
+        break;
+    }
+    case MOCK_CMD_BIND_STORAGE_BUFFER:
+        if (cmd->args[0] == DkStage_Compute
+            && cmd->args[1] < MOCK_MAX_STORAGE_BUFFERS)
+        {
+            queue->storage_addr[cmd->args[1]] = cmd->addr;
+            queue->storage_size[cmd->args[1]] = cmd->args[2];
+        }
+        break;
+    case MOCK_CMD_DISPATCH_COMPUTE:
+        execute_dispatch(queue, cmd);
+        break;
+    case MOCK_CMD_BIND_RENDER_TARGETS:
+    {
+        struct render_target const* const targets = cmd->data;
+        queue->num_color_targets = cmd->args[0];
+        memcpy(queue->color_targets, targets,
+            cmd->args[0] * sizeof(*targets));
+        queue->depth_target = cmd->args[1]
+            ? targets[cmd->args[0]] : (struct render_target){0};
+        break;
+    }
+    case MOCK_CMD_CLEAR_COLOR:
+        if (cmd->args[0] < queue->num_color_targets)
+        {
+            fill_target(&queue->color_targets[cmd->args[0]], cmd->data,
+                cmd->data_size);
+        }
+        break;
+    case MOCK_CMD_CLEAR_DEPTH_STENCIL:
+        if (cmd->args[0])
+            fill_target(&queue->depth_target, &cmd->args[1], sizeof(float));
+        break;
+    case MOCK_CMD_PUSH_DATA:
+    {
+        void* const dst = mock_gpu_to_cpu(cmd->addr, cmd->data_size);
+        if (!dst)
+            fail("push outside of any memory block");
+        memcpy(dst, cmd->data, cmd->data_size);
+        break;
+    }
+    case MOCK_CMD_REPORT_COUNTER:
+    {
+        uint8_t* const dst = mock_gpu_to_cpu(cmd->addr, REPORT_SIZE);
+        if (!dst)
+            fail("report outside of any memory block");
+        // The timestamp is in nanoseconds, the payload is zero
+        uint64_t const report[2] = {0, now_ns()};
+        memcpy(dst, report, sizeof(report));
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Submissions a list waits behind before it runs, 0 runs lists as they are
+// submitted
+static size_t fence_delay(void)
+{
+    static bool is_read;
+    static size_t delay;
+    if (!is_read)
+    {
+        is_read = true;
+        char const* const value = getenv("MOCK_FENCE_DELAY");
+        if (value)
+            delay = strtoul(value, NULL, 10);
+    }
+    return delay;
+}
+
+static void push_op(DkQueue queue, struct cmd_list const* list,
+    DkFence* fence)
+{
+    struct queue_op* const op = checked_calloc(1, sizeof(*op));
+    op->list = list;
+    op->fence = fence;
+    *queue->ops_tail = op;
+    queue->ops_tail = &op->next;
+    if (list)
+    {
+        ++list->cmdbuf->num_pending;
+        ++queue->num_pending_lists;
+    }
+}
+
+static void run_first_op(DkQueue queue)
+{
+    struct queue_op* const op = queue->ops;
+    queue->ops = op->next;
+    if (!queue->ops)
+        queue->ops_tail = &queue->ops;
+
+    if (op->list)
+    {
+        for (size_t i = op->list->begin; i < op->list->end; ++i)
+            execute(queue, &op->list->cmdbuf->cmds[i]);
+        --op->list->cmdbuf->num_pending;
+        --queue->num_pending_lists;
+    }
+    else
+    {
+        op->fence->semaphoreValue = 1;
+    }
+    free(op);
+}
+
+// Runs work until at most num_kept lists are pending, fences signal as soon
+// as the lists before them have run
+static void run_ops(DkQueue queue, size_t num_kept)
+{
+    while (queue->ops
+        && (!queue->ops->list || queue->num_pending_lists > num_kept))
+    {
+        run_first_op(queue);
+    }
+}
+
+void dkQueueSubmitCommands(DkQueue obj, DkCmdList cmds)
+{
+    push_op(obj, (struct cmd_list const*)cmds, NULL);
+    run_ops(obj, fence_delay());
+}
+
+void dkQueueFlush(DkQueue obj)
+{
+    (void)obj;
+}
+
+void dkQueueWaitIdle(DkQueue obj)
+{
+    run_ops(obj, 0);
+}
+
+void dkQueueSignalFence(DkQueue obj, DkFence* fence, bool flush)
+{
+    (void)flush;
+    memset(fence, 0, sizeof(*fence));
+    push_op(obj, NULL, fence);
+    run_ops(obj, fence_delay());
+}
+
+static bool is_pending(DkQueue queue, DkFence const* fence)
+{
+    for (struct queue_op const* op = queue->ops; op; op = op->next)
+    {
+        if (op->fence == fence)
+            return true;
+    }
+    return false;
+}
+
+// A pending fence is waited for by running its queue up to it, as the GPU
+// would catch up, unless the wait is a poll
+DkResult dkFenceWait(DkFence* obj, int64_t timeout_ns)
+{
+    for (DkQueue queue = queues; queue && obj->semaphoreValue != 1;
+         queue = queue->next)
+    {
+        if (!is_pending(queue, obj))
+            continue;
+        if (timeout_ns == 0)
+            return DkResult_Timeout;
+        while (obj->semaphoreValue != 1)
+            run_first_op(queue);
+    }
+    if (obj->semaphoreValue != 1)
+        fail("waiting on a fence that was never signaled");
+    return DkResult_Success;
+}
@@ -0,0 +1,670 @@
+// Host mock of the subset of deko3d the tests use. Declarations follow the
+// real header closely enough for the sources to build unchanged, object
+// layouts are the mock's own.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DK_MEMBLOCK_ALIGNMENT 0x1000
+#define DK_CMDMEM_ALIGNMENT 4
+#define DK_SHADER_CODE_ALIGNMENT 0x100
+#define DK_SHADER_CODE_UNUSABLE_SIZE 0x80
+#define DK_UNIFORM_BUF_ALIGNMENT 0x100
+#define DK_IMAGE_DESCRIPTOR_ALIGNMENT 0x20
+#define DK_SAMPLER_DESCRIPTOR_ALIGNMENT 0x20
+#define DK_PER_WARP_SCRATCH_MEM_ALIGNMENT 0x200
+
+typedef struct DkDevice_T* DkDevice;
+typedef struct DkMemBlock_T* DkMemBlock;
+typedef struct DkCmdBuf_T* DkCmdBuf;
+typedef struct DkQueue_T* DkQueue;
+typedef uint64_t DkGpuAddr;
+typedef uintptr_t DkCmdList;
+typedef uint32_t DkResHandle;
+
+#define DK_GPU_ADDR_INVALID (~0ULL)
+
+typedef enum
+{
+    DkResult_Success,
+    DkResult_Fail,
+    DkResult_Timeout,
+} DkResult;
+
+// Device
+
+typedef struct
+{
+    DkDevice device;
+    void* userData;
+    void* cbDebug;
+    void* cbAlloc;
+    void* cbFree;
+    uint32_t flags;
+} DkDeviceMaker;
+
+void dkDeviceMakerDefaults(DkDeviceMaker* maker);
+DkDevice dkDeviceCreate(DkDeviceMaker const* maker);
+void dkDeviceDestroy(DkDevice obj);
+
+// Memory blocks
+
+enum
+{
+    DkMemBlockFlags_CpuUncached = 1 << 0,
+    DkMemBlockFlags_CpuCached = 1 << 1,
+    DkMemBlockFlags_GpuUncached = 1 << 2,
+    DkMemBlockFlags_GpuCached = 1 << 3,
+    DkMemBlockFlags_Code = 1 << 4,
+    DkMemBlockFlags_Image = 1 << 5,
+    DkMemBlockFlags_ZeroFillInit = 1 << 6,
+};
+
+typedef struct
+{
+    DkDevice device;
+    uint32_t size;
+    uint32_t flags;
+    void* storage;
+} DkMemBlockMaker;
+
+void dkMemBlockMakerDefaults(
+    DkMemBlockMaker* maker, DkDevice device, uint32_t size);
+DkMemBlock dkMemBlockCreate(DkMemBlockMaker const* maker);
+void dkMemBlockDestroy(DkMemBlock obj);
+void* dkMemBlockGetCpuAddr(DkMemBlock obj);
+DkGpuAddr dkMemBlockGetGpuAddr(DkMemBlock obj);
+uint32_t dkMemBlockGetSize(DkMemBlock obj);
+DkResult dkMemBlockFlushCpuCache(
+    DkMemBlock obj, uint32_t offset, uint32_t size);
+
+// Fences
+
+typedef struct
+{
+    uint32_t semaphoreValue;
+    void* semaphoreMem;
+    uint64_t storage[3];
+} DkFence;
+
+DkResult dkFenceWait(DkFence* obj, int64_t timeout_ns);
+
+// Command buffers
+
+typedef void (*DkCmdBufMemFunc)(
+    void* userData, DkCmdBuf cmdbuf, size_t minReqSize);
+
+typedef struct
+{
+    DkDevice device;
+    void* userData;
+    DkCmdBufMemFunc cbAddMem;
+} DkCmdBufMaker;
+
+void dkCmdBufMakerDefaults(DkCmdBufMaker* maker, DkDevice device);
+DkCmdBuf dkCmdBufCreate(DkCmdBufMaker const* maker);
+void dkCmdBufDestroy(DkCmdBuf obj);
+void dkCmdBufAddMemory(
+    DkCmdBuf obj, DkMemBlock mem, uint32_t offset, uint32_t size);
+DkCmdList dkCmdBufFinishList(DkCmdBuf obj);
+void dkCmdBufClear(DkCmdBuf obj);
+
+typedef enum
+{
+    DkBarrier_None,
+    DkBarrier_Tiles,
+    DkBarrier_Fragments,
+    DkBarrier_Primitives,
+    DkBarrier_Full,
+} DkBarrier;
+
+enum
+{
+    DkInvalidateFlags_Image = 1 << 0,
+    DkInvalidateFlags_Code = 1 << 1,
+    DkInvalidateFlags_Pool = 1 << 2,
+    DkInvalidateFlags_Zcull = 1 << 3,
+    DkInvalidateFlags_L2Cache = 1 << 4,
+};
+
+void dkCmdBufBarrier(DkCmdBuf obj, DkBarrier mode, uint32_t invalidateFlags);
+
+// Shaders
+
+typedef enum
+{
+    DkStage_Vertex,
+    DkStage_TessCtrl,
+    DkStage_TessEval,
+    DkStage_Geometry,
+    DkStage_Fragment,
+    DkStage_Compute,
+    DkStage_MaxGraphics = 5,
+} DkStage;
+
+enum
+{
+    DkStageFlag_Vertex = 1 << DkStage_Vertex,
+    DkStageFlag_TessCtrl = 1 << DkStage_TessCtrl,
+    DkStageFlag_TessEval = 1 << DkStage_TessEval,
+    DkStageFlag_Geometry = 1 << DkStage_Geometry,
+    DkStageFlag_Fragment = 1 << DkStage_Fragment,
+    DkStageFlag_Compute = 1 << DkStage_Compute,
+    DkStageFlag_GraphicsMask = (1 << DkStage_MaxGraphics) - 1,
+};
+
+typedef struct
+{
+    DkMemBlock codeMem;
+    void const* control;
+    uint32_t codeOffset;
+    uint32_t programId;
+} DkShaderMaker;
+
+typedef struct
+{
+    uint64_t storage[16];
+} DkShader;
+
+void dkShaderMakerDefaults(
+    DkShaderMaker* maker, DkMemBlock codeMem, uint32_t codeOffset);
+void dkShaderInitialize(DkShader* obj, DkShaderMaker const* maker);
+bool dkShaderIsValid(DkShader const* obj);
+DkStage dkShaderGetStage(DkShader const* obj);
+
+void dkCmdBufBindShaders(DkCmdBuf obj, uint32_t stageMask,
+    DkShader const* const shaders[], uint32_t numShaders);
+void dkCmdBufBindStorageBuffer(DkCmdBuf obj, DkStage stage, uint32_t id,
+    DkGpuAddr bufAddr, uint32_t bufSize);
+void dkCmdBufBindUniformBuffer(DkCmdBuf obj, DkStage stage, uint32_t id,
+    DkGpuAddr bufAddr, uint32_t bufSize);
+void dkCmdBufDispatchCompute(DkCmdBuf obj, uint32_t numGroupsX,
+    uint32_t numGroupsY, uint32_t numGroupsZ);
+void dkCmdBufPushData(
+    DkCmdBuf obj, DkGpuAddr addr, void const* data, uint32_t size);
+
+typedef enum
+{
+    DkCounter_Timestamp,
+    DkCounter_SamplesPassed,
+} DkCounter;
+
+void dkCmdBufReportCounter(DkCmdBuf obj, DkCounter type, DkGpuAddr addr);
+
+// Images
+
+typedef enum
+{
+    DkImageType_None,
+    DkImageType_1D,
+    DkImageType_2D,
+    DkImageType_3D,
+    DkImageType_1DArray,
+    DkImageType_2DArray,
+    DkImageType_2DMS,
+    DkImageType_2DMSArray,
+    DkImageType_Rectangle,
+    DkImageType_Cubemap,
+    DkImageType_CubemapArray,
+    DkImageType_Buffer,
+} DkImageType;
+
+typedef enum
+{
+    DkImageFormat_None,
+    DkImageFormat_x,
+    DkImageFormat_R8_Unorm,
+    DkImageFormat_R8_Snorm,
+    DkImageFormat_R8_Uint,
+    DkImageFormat_R8_Sint,
+    DkImageFormat_R16_Float,
+    DkImageFormat_R16_Unorm,
+    DkImageFormat_R16_Snorm,
+    DkImageFormat_R16_Uint,
+    DkImageFormat_R16_Sint,
+    DkImageFormat_R32_Float,
+    DkImageFormat_R32_Uint,
+    DkImageFormat_R32_Sint,
+    DkImageFormat_RG8_Unorm,
+    DkImageFormat_RG8_Snorm,
+    DkImageFormat_RG8_Uint,
+    DkImageFormat_RG8_Sint,
+    DkImageFormat_RG16_Float,
+    DkImageFormat_RG16_Unorm,
+    DkImageFormat_RG16_Snorm,
+    DkImageFormat_RG16_Uint,
+    DkImageFormat_RG16_Sint,
+    DkImageFormat_RG32_Float,
+    DkImageFormat_RG32_Uint,
+    DkImageFormat_RG32_Sint,
+    DkImageFormat_RGB32_Float,
+    DkImageFormat_RGB32_Uint,
+    DkImageFormat_RGB32_Sint,
+    DkImageFormat_RGBA8_Unorm,
+    DkImageFormat_RGBA8_Snorm,
+    DkImageFormat_RGBA8_Uint,
+    DkImageFormat_RGBA8_Sint,
+    DkImageFormat_RGBA16_Float,
+    DkImageFormat_RGBA16_Unorm,
+    DkImageFormat_RGBA16_Snorm,
+    DkImageFormat_RGBA16_Uint,
+    DkImageFormat_RGBA16_Sint,
+    DkImageFormat_RGBA32_Float,
+    DkImageFormat_RGBA32_Uint,
+    DkImageFormat_RGBA32_Sint,
+    DkImageFormat_S8,
+    DkImageFormat_Z16,
+    DkImageFormat_Z24X8,
+    DkImageFormat_ZF32,
+    DkImageFormat_Z24S8,
+    DkImageFormat_ZF32_X24S8,
+    DkImageFormat_RGBX8_Unorm_sRGB,
+    DkImageFormat_RGBA8_Unorm_sRGB,
+    DkImageFormat_RGBA4_Unorm,
+    DkImageFormat_RGB5_Unorm,
+    DkImageFormat_RGB5A1_Unorm,
+    DkImageFormat_RGB565_Unorm,
+    DkImageFormat_RGB10A2_Unorm,
+    DkImageFormat_RGB10A2_Uint,
+    DkImageFormat_RG11B10_Float,
+    DkImageFormat_E5BGR9_Float,
+    DkImageFormat_RGB_BC1,
+    DkImageFormat_RGBA_BC1,
+    DkImageFormat_RGBA_BC2,
+    DkImageFormat_RGBA_BC3,
+    DkImageFormat_RGB_BC1_sRGB,
+    DkImageFormat_RGBA_BC1_sRGB,
+    DkImageFormat_RGBA_BC2_sRGB,
+    DkImageFormat_RGBA_BC3_sRGB,
+    DkImageFormat_R_BC4_Unorm,
+    DkImageFormat_R_BC4_Snorm,
+    DkImageFormat_RG_BC5_Unorm,
+    DkImageFormat_RG_BC5_Snorm,
+    DkImageFormat_RGBA_BC7_Unorm,
+    DkImageFormat_RGBA_BC7_Unorm_sRGB,
+    DkImageFormat_RGBA_BC6H_SF16_Float,
+    DkImageFormat_RGBA_BC6H_UF16_Float,
+    DkImageFormat_RGBX8_Unorm,
+    DkImageFormat_RGBX8_Snorm,
+    DkImageFormat_RGBX8_Uint,
+    DkImageFormat_RGBX8_Sint,
+    DkImageFormat_RGBX16_Float,
+    DkImageFormat_RGBX16_Unorm,
+    DkImageFormat_RGBX16_Snorm,
+    DkImageFormat_RGBX16_Uint,
+    DkImageFormat_RGBX16_Sint,
+    DkImageFormat_RGBX32_Float,
+    DkImageFormat_RGBX32_Uint,
+    DkImageFormat_RGBX32_Sint,
+    DkImageFormat_RGBA_ASTC_4x4,
+    DkImageFormat_BGR565_Unorm,
+    DkImageFormat_BGR5_Unorm,
+    DkImageFormat_BGR5A1_Unorm,
+    DkImageFormat_A5BGR5_Unorm,
+    DkImageFormat_BGRX8_Unorm,
+    DkImageFormat_BGRA8_Unorm,
+    DkImageFormat_BGRX8_Unorm_sRGB,
+    DkImageFormat_BGRA8_Unorm_sRGB,
+    DkImageFormat_R_ETC2_Unorm,
+    DkImageFormat_R_ETC2_Snorm,
+    DkImageFormat_RG_ETC2_Unorm,
+    DkImageFormat_RG_ETC2_Snorm,
+    DkImageFormat_RGB_ETC2,
+    DkImageFormat_RGB_PTA_ETC2,
+    DkImageFormat_RGBA_ETC2,
+    DkImageFormat_RGB_ETC2_sRGB,
+    DkImageFormat_RGB_PTA_ETC2_sRGB,
+    DkImageFormat_RGBA_ETC2_sRGB,
+    DkImageFormat_Count,
+} DkImageFormat;
+
+enum
+{
+    DkImageFlags_BlockLinear = 0,
+    DkImageFlags_PitchLinear = 1 << 0,
+    DkImageFlags_CustomTileSize = 1 << 1,
+    DkImageFlags_HwCompression = 1 << 2,
+    DkImageFlags_D16EnableZbc = 1 << 3,
+    DkImageFlags_UsageRender = 1 << 4,
+    DkImageFlags_UsageLoadStore = 1 << 5,
+    DkImageFlags_UsagePresent = 1 << 6,
+    DkImageFlags_Usage2DEngine = 1 << 7,
+    DkImageFlags_UsageVideo = 1 << 8,
+};
+
+typedef enum
+{
+    DkMsMode_1x,
+} DkMsMode;
+
+typedef enum
+{
+    DkTileSize_OneGob,
+    DkTileSize_TwoGobs,
+    DkTileSize_FourGobs,
+    DkTileSize_EightGobs,
+    DkTileSize_SixteenGobs,
+    DkTileSize_ThirtyTwoGobs,
+} DkTileSize;
+
+typedef struct
+{
+    DkDevice device;
+    DkImageType type;
+    uint32_t flags;
+    DkImageFormat format;
+    DkMsMode msMode;
+    uint32_t dimensions[3];
+    uint32_t mipLevels;
+    union
+    {
+        uint32_t pitchStride;
+        DkTileSize tileSize;
+    };
+} DkImageLayoutMaker;
+
+typedef struct
+{
+    uint64_t storage[16];
+} DkImageLayout;
+
+typedef struct
+{
+    uint64_t storage[16];
+} DkImage;
+
+void dkImageLayoutMakerDefaults(DkImageLayoutMaker* maker, DkDevice device);
+void dkImageLayoutInitialize(
+    DkImageLayout* obj, DkImageLayoutMaker const* maker);
+uint64_t dkImageLayoutGetSize(DkImageLayout const* obj);
+uint32_t dkImageLayoutGetAlignment(DkImageLayout const* obj);
+void dkImageInitialize(DkImage* obj, DkImageLayout const* layout,
+    DkMemBlock memBlock, uint32_t offset);
+DkGpuAddr dkImageGetGpuAddr(DkImage const* obj);
+
+typedef enum
+{
+    DkImageSwizzle_Zero,
+    DkImageSwizzle_One,
+    DkImageSwizzle_Red,
+    DkImageSwizzle_Green,
+    DkImageSwizzle_Blue,
+    DkImageSwizzle_Alpha,
+} DkImageSwizzle;
+
+typedef enum
+{
+    DkDsSource_Depth,
+    DkDsSource_Stencil,
+} DkDsSource;
+
+typedef struct
+{
+    DkImage const* pImage;
+    DkImageType type;
+    DkImageFormat format;
+    DkImageSwizzle swizzle[4];
+    DkDsSource dsSource;
+    uint16_t layerOffset;
+    uint16_t layerCount;
+    uint8_t mipLevelOffset;
+    uint8_t mipLevelCount;
+} DkImageView;
+
+void dkImageViewDefaults(DkImageView* obj, DkImage const* pImage);
+
+typedef struct
+{
+    uint32_t storage[8];
+} DkImageDescriptor;
+
+typedef struct
+{
+    uint32_t storage[8];
+} DkSamplerDescriptor;
+
+void dkImageDescriptorInitialize(DkImageDescriptor* obj,
+    DkImageView const* view, bool usesLoadStore, bool decayMS);
+
+// Samplers
+
+typedef enum
+{
+    DkFilter_Nearest = 1,
+    DkFilter_Linear = 2,
+} DkFilter;
+
+typedef enum
+{
+    DkMipFilter_None = 1,
+    DkMipFilter_Nearest = 2,
+    DkMipFilter_Linear = 3,
+} DkMipFilter;
+
+typedef enum
+{
+    DkWrapMode_Repeat,
+    DkWrapMode_MirroredRepeat,
+    DkWrapMode_ClampToEdge,
+    DkWrapMode_ClampToBorder,
+    DkWrapMode_Clamp,
+    DkWrapMode_MirrorClampToEdge,
+    DkWrapMode_MirrorClampToBorder,
+    DkWrapMode_MirrorClamp,
+} DkWrapMode;
+
+typedef union
+{
+    float value_f;
+    uint32_t value_ui;
+    int32_t value_i;
+} DkBorderColor;
+
+typedef struct
+{
+    DkFilter minFilter;
+    DkFilter magFilter;
+    DkMipFilter mipFilter;
+    DkWrapMode wrapMode[3];
+    float lodClampMin;
+    float lodClampMax;
+    float lodBias;
+    float lodSnap;
+    bool compareEnable;
+    int compareOp;
+    DkBorderColor borderColor[4];
+    float maxAnisotropy;
+    int reductionMode;
+} DkSampler;
+
+static inline void dkSamplerDefaults(DkSampler* obj)
+{
+    DkSampler const defaults = {
+        .minFilter = DkFilter_Nearest,
+        .magFilter = DkFilter_Nearest,
+        .mipFilter = DkMipFilter_None,
+        .wrapMode = {DkWrapMode_Repeat, DkWrapMode_Repeat, DkWrapMode_Repeat},
+        .lodClampMax = 1000.0f,
+        .maxAnisotropy = 1.0f,
+    };
+    *obj = defaults;
+}
+
+void dkSamplerDescriptorInitialize(
+    DkSamplerDescriptor* obj, DkSampler const* sampler);
+
+static inline DkResHandle dkMakeImageHandle(uint32_t id)
+{
+    return id & 0xFFFFF;
+}
+
+static inline DkResHandle dkMakeSamplerHandle(uint32_t id)
+{
+    return id << 20;
+}
+
+static inline DkResHandle dkMakeTextureHandle(
+    uint32_t imageId, uint32_t samplerId)
+{
+    return dkMakeImageHandle(imageId) | dkMakeSamplerHandle(samplerId);
+}
+
+void dkCmdBufBindImageDescriptorSet(
+    DkCmdBuf obj, DkGpuAddr setAddr, uint32_t numDescriptors);
+void dkCmdBufBindSamplerDescriptorSet(
+    DkCmdBuf obj, DkGpuAddr setAddr, uint32_t numDescriptors);
+void dkCmdBufBindTexture(
+    DkCmdBuf obj, DkStage stage, uint32_t id, DkResHandle handle);
+void dkCmdBufBindImage(
+    DkCmdBuf obj, DkStage stage, uint32_t id, DkResHandle handle);
+
+// Rendering
+
+void dkCmdBufBindRenderTargets(DkCmdBuf obj,
+    DkImageView const* const colorTargets[], uint32_t numColorTargets,
+    DkImageView const* depthTarget);
+
+typedef struct
+{
+    float x, y, width, height, near, far;
+} DkViewport;
+
+typedef struct
+{
+    uint32_t x, y, width, height;
+} DkScissor;
+
+void dkCmdBufSetViewports(DkCmdBuf obj, uint32_t firstId,
+    DkViewport const viewports[], uint32_t numViewports);
+void dkCmdBufSetScissors(DkCmdBuf obj, uint32_t firstId,
+    DkScissor const scissors[], uint32_t numScissors);
+
+enum
+{
+    DkColorMask_R = 1 << 0,
+    DkColorMask_G = 1 << 1,
+    DkColorMask_B = 1 << 2,
+    DkColorMask_A = 1 << 3,
+    DkColorMask_RGB = 7,
+    DkColorMask_RGBA = 15,
+};
+
+void dkCmdBufClearColor(DkCmdBuf obj, uint32_t targetId, uint32_t clearMask,
+    void const* clearData);
+void dkCmdBufClearDepthStencil(DkCmdBuf obj, bool clearDepth,
+    float depthValue, uint8_t stencilMask, uint8_t stencilValue);
+
+typedef enum
+{
+    DkPrimitive_Points,
+    DkPrimitive_Lines,
+    DkPrimitive_LineLoop,
+    DkPrimitive_LineStrip,
+    DkPrimitive_Triangles,
+    DkPrimitive_TriangleStrip,
+    DkPrimitive_TriangleFan,
+    DkPrimitive_Quads,
+} DkPrimitive;
+
+void dkCmdBufDraw(DkCmdBuf obj, DkPrimitive prim, uint32_t vertexCount,
+    uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+
+typedef struct
+{
+    uint32_t depthTestEnable : 1;
+    uint32_t depthWriteEnable : 1;
+    uint32_t stencilTestEnable : 1;
+    uint32_t depthCompareOp : 4;
+} DkDepthStencilState;
+
+void dkDepthStencilStateDefaults(DkDepthStencilState* obj);
+void dkCmdBufBindDepthStencilState(
+    DkCmdBuf obj, DkDepthStencilState const* state);
+
+typedef enum
+{
+    DkVtxAttribSize_1x32 = 0x12,
+    DkVtxAttribSize_2x32 = 0x04,
+    DkVtxAttribSize_3x32 = 0x02,
+    DkVtxAttribSize_4x32 = 0x01,
+    DkVtxAttribSize_1x16 = 0x1b,
+    DkVtxAttribSize_2x16 = 0x0f,
+    DkVtxAttribSize_3x16 = 0x05,
+    DkVtxAttribSize_4x16 = 0x03,
+    DkVtxAttribSize_1x8 = 0x1d,
+    DkVtxAttribSize_2x8 = 0x18,
+    DkVtxAttribSize_3x8 = 0x13,
+    DkVtxAttribSize_4x8 = 0x0a,
+    DkVtxAttribSize_10_10_10_2 = 0x30,
+    DkVtxAttribSize_11_11_10 = 0x31,
+} DkVtxAttribSize;
+
+typedef enum
+{
+    DkVtxAttribType_None,
+    DkVtxAttribType_Snorm,
+    DkVtxAttribType_Unorm,
+    DkVtxAttribType_Sint,
+    DkVtxAttribType_Uint,
+    DkVtxAttribType_Uscaled,
+    DkVtxAttribType_Sscaled,
+    DkVtxAttribType_Float,
+} DkVtxAttribType;
+
+typedef struct
+{
+    uint32_t bufferId : 5;
+    uint32_t isFixed : 1;
+    uint32_t offset : 14;
+    uint32_t size : 6;
+    uint32_t type : 3;
+    uint32_t pad : 1;
+    uint32_t isBgra : 1;
+} DkVtxAttribState;
+
+typedef struct
+{
+    uint32_t stride;
+    uint32_t divisor;
+} DkVtxBufferState;
+
+typedef struct
+{
+    DkGpuAddr addr;
+    uint32_t size;
+} DkBufExtents;
+
+void dkCmdBufBindVtxAttribState(DkCmdBuf obj,
+    DkVtxAttribState const attribs[], uint32_t numAttribs);
+void dkCmdBufBindVtxBufferState(DkCmdBuf obj,
+    DkVtxBufferState const buffers[], uint32_t numBuffers);
+void dkCmdBufBindVtxBuffers(DkCmdBuf obj, uint32_t firstId,
+    DkBufExtents const buffers[], uint32_t numBuffers);
+
+// Queues
+
+enum
+{
+    DkQueueFlags_Graphics = 1 << 0,
+    DkQueueFlags_Compute = 1 << 1,
+};
+
+typedef struct
+{
+    DkDevice device;
+    uint32_t flags;
+    uint32_t commandMemorySize;
+    uint32_t flushThreshold;
+    uint32_t perWarpScratchMemorySize;
+    uint32_t maxConcurrentComputeJobs;
+} DkQueueMaker;
+
+void dkQueueMakerDefaults(DkQueueMaker* maker, DkDevice device);
+DkQueue dkQueueCreate(DkQueueMaker const* maker);
+void dkQueueDestroy(DkQueue obj);
+void dkQueueSubmitCommands(DkQueue obj, DkCmdList cmds);
+void dkQueueFlush(DkQueue obj);
+void dkQueueWaitIdle(DkQueue obj);
+void dkQueueSignalFence(DkQueue obj, DkFence* fence, bool flush);
@@ -0,0 +1,96 @@
+// Host mock of the subset of libnx the tests use
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+typedef int8_t s8;
+typedef int16_t s16;
+typedef int32_t s32;
+typedef int64_t s64;
+
+typedef u32 Result;
+#define R_SUCCEEDED(res) ((res) == 0)
+#define R_FAILED(res) ((res) != 0)
+
+// Console, drawing is a no-op
+
+typedef struct PrintConsole PrintConsole;
+
+PrintConsole* consoleInit(PrintConsole* console);
+void consoleExit(PrintConsole* console);
+void consoleUpdate(PrintConsole* console);
+
+// Input, A always reads as pressed so prompts never block
+
+typedef enum
+{
+    CONTROLLER_P1_AUTO = 10,
+} HidControllerID;
+
+#define KEY_A (1ULL << 0)
+
+void hidScanInput(void);
+u64 hidKeysDown(HidControllerID id);
+
+// Filesystems, romfs:/ and sdmc:/ paths are redirected to host directories
+// by fopen
+
+Result romfsInit(void);
+Result romfsExit(void);
+
+// Sockets are the host's own
+
+Result socketInitializeDefault(void);
+void socketExit(void);
+
+// System information, a first revision console on firmware 10.0.0
+
+typedef enum
+{
+    SplConfigItem_HardwareType = 15,
+} SplConfigItem;
+
+Result splInitialize(void);
+void splExit(void);
+Result splGetConfig(SplConfigItem item, u64* out);
+
+typedef struct
+{
+    u8 major;
+    u8 minor;
+    u8 micro;
+    u8 padding1;
+    u8 revision_major;
+    u8 revision_minor;
+    u8 padding2;
+    u8 padding3;
+    char platform[0x20];
+    char version_hash[0x40];
+    char display_version[0x18];
+    char display_title[0x80];
+} SetSysFirmwareVersion;
+
+Result setsysInitialize(void);
+void setsysExit(void);
+Result setsysGetFirmwareVersion(SetSysFirmwareVersion* out);
+
+// Crypto
+
+#define SHA256_HASH_SIZE 0x20
+
+void sha256CalculateHash(void* dst, void const* src, size_t size);
+
+// Time, ticks run at the hardware's 19.2 MHz from the host's monotonic clock
+
+u64 armGetSystemTick(void);
+u64 armGetSystemTickFreq(void);
+u64 armTicksToNs(u64 tick);
+u64 armNsToTicks(u64 ns);
+
+void svcSleepThread(s64 nano);
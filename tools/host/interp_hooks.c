@@ -0,0 +1,45 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mock.h"
+#include "sass_interp.h"
+
+static_assert(MOCK_MAX_STORAGE_BUFFERS == SASS_MAX_STORAGE_BUFFERS,
+    "Storage buffer counts differ");
+
+// Runs dispatches on the reference interpreter. A fault leaves the buffers
+// as far as it got, the test's own checks report the failure.
+static void dispatch(void* user, struct mock_dispatch const* dispatch)
+{
+    (void)user;
+    struct mock_program const* const program = dispatch->program;
+    struct sass_launch launch = {
+        .code = (uint64_t const*)program->code,
+        .code_size = program->code_size,
+        .local_mem_size = program->local_mem_size,
+        .shared_mem_size = program->shared_mem_size,
+    };
+    for (int i = 0; i < 3; ++i)
+    {
+        launch.block_dim[i] = program->block_dims[i];
+        launch.grid_dim[i] = dispatch->grid_dims[i];
+    }
+    for (int i = 0; i < SASS_MAX_STORAGE_BUFFERS; ++i)
+    {
+        launch.storage[i].data = dispatch->storage[i].data;
+        launch.storage[i].size = dispatch->storage[i].size;
+    }
+
+    char error[256];
+    if (!sass_execute(&launch, error, sizeof(error)))
+        fprintf(stderr, "sass_execute: %s\n", error);
+}
+
+__attribute__((constructor)) static void install_hooks(void)
+{
+    struct mock_hooks const hooks = {
+        .dispatch = dispatch,
+    };
+    mock_set_hooks(&hooks);
+}
@@ -0,0 +1,172 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <switch.h>
+
+#define TICK_FREQ 19200000ull
+
+// Provided by the application, libnx's runtime calls them around main
+void userAppInit(void);
+void userAppExit(void);
+
+__attribute__((constructor)) static void run_user_app_init(void)
+{
+    userAppInit();
+    atexit(userAppExit);
+}
+
+// Console
+
+PrintConsole* consoleInit(PrintConsole* console)
+{
+    return console;
+}
+
+void consoleExit(PrintConsole* console)
+{
+    (void)console;
+    fflush(stdout);
+}
+
+void consoleUpdate(PrintConsole* console)
+{
+    (void)console;
+    fflush(stdout);
+}
+
+// Input
+
+void hidScanInput(void)
+{
+}
+
+u64 hidKeysDown(HidControllerID id)
+{
+    (void)id;
+    return KEY_A;
+}
+
+// Filesystems
+
+Result romfsInit(void)
+{
+    return 0;
+}
+
+Result romfsExit(void)
+{
+    return 0;
+}
+
+FILE* __real_fopen(char const* path, char const* mode);
+
+static FILE* open_redirected(char const* path, char const* mode,
+    char const* variable, char const* default_dir)
+{
+    char const* dir = getenv(variable);
+    if (!dir)
+        dir = default_dir;
+
+    size_t const size = strlen(dir) + strlen(path) + 2;
+    char* const host_path = malloc(size);
+    if (!host_path)
+        return NULL;
+    snprintf(host_path, size, "%s/%s", dir, path);
+    FILE* const file = __real_fopen(host_path, mode);
+    free(host_path);
+    return file;
+}
+
+// Linked with --wrap=fopen
+FILE* __wrap_fopen(char const* path, char const* mode)
+{
+    if (0 == strncmp(path, "romfs:/", 7))
+        return open_redirected(path + 7, mode, "MOCK_ROMFS", "romfs");
+    if (0 == strncmp(path, "sdmc:/", 6))
+        return open_redirected(path + 6, mode, "MOCK_SDMC", "sdmc");
+    return __real_fopen(path, mode);
+}
+
+// Sockets
+
+Result socketInitializeDefault(void)
+{
+    return 0;
+}
+
+void socketExit(void)
+{
+}
+
+// System information
+
+Result splInitialize(void)
+{
+    return 0;
+}
+
+void splExit(void)
+{
+}
+
+Result splGetConfig(SplConfigItem item, u64* out)
+{
+    (void)item;
+    *out = 0; // Icosa
+    return 0;
+}
+
+Result setsysInitialize(void)
+{
+    return 0;
+}
+
+void setsysExit(void)
+{
+}
+
+Result setsysGetFirmwareVersion(SetSysFirmwareVersion* out)
+{
+    memset(out, 0, sizeof(*out));
+    out->major = 10;
+    snprintf(out->display_version, sizeof(out->display_version), "10.0.0");
+    return 0;
+}
+
+// Time
+
+u64 armGetSystemTick(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return armNsToTicks((u64)time.tv_sec * 1000000000 + time.tv_nsec);
+}
+
+u64 armGetSystemTickFreq(void)
+{
+    return TICK_FREQ;
+}
+
+u64 armTicksToNs(u64 tick)
+{
+    return (tick * 625) / 12;
+}
+
+u64 armNsToTicks(u64 ns)
+{
+    return (ns * 12) / 625;
+}
+
+void svcSleepThread(s64 nano)
+{
+    if (nano <= 0)
+        return;
+    struct timespec const time = {
+        .tv_sec = nano / 1000000000,
+        .tv_nsec = nano % 1000000000,
+    };
+    nanosleep(&time, NULL);
+}
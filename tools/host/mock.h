@@ -0,0 +1,103 @@
+// Host stand-in for the GPU side of deko3d. Memory blocks are host memory
+// at deterministic GPU addresses, command buffers record a trace of the calls
+// made on them and queues run the trace through hooks when it is submitted,
+// or later with MOCK_FENCE_DELAY.
+//
+// Environment:
+//   MOCK_MMAP=1        back memory blocks with anonymous mappings
+//   MOCK_TRACE=<path>  write every executed command to a file
+//   MOCK_ROMFS=<dir>   directory romfs:/ paths open from, romfs by default
+//   MOCK_SDMC=<dir>    directory sdmc:/ paths open from, sdmc by default
+//   MOCK_FENCE_DELAY=<n>  run a submitted list only once n more lists are
+//                      submitted behind it, or on a wait. Fences signal
+//                      when the lists before them have run. Clearing a
+//                      command buffer with lists still pending fails.
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deko3d.h>
+
+#define MOCK_MAX_STORAGE_BUFFERS 16
+
+// A program as the mock GPU sees it, parsed from its DKSH
+struct mock_program
+{
+    DkStage stage;
+    uint8_t const* code;
+    // Bytes from the entrypoint to the end of the code section
+    uint32_t code_size;
+    uint32_t num_gprs;
+    uint32_t block_dims[3];
+    uint32_t local_mem_size;
+    uint32_t shared_mem_size;
+};
+
+enum mock_cmd_type
+{
+    MOCK_CMD_BARRIER,
+    MOCK_CMD_BIND_SHADERS,
+    MOCK_CMD_BIND_STORAGE_BUFFER,
+    MOCK_CMD_BIND_UNIFORM_BUFFER,
+    MOCK_CMD_DISPATCH_COMPUTE,
+    MOCK_CMD_PUSH_DATA,
+    MOCK_CMD_REPORT_COUNTER,
+    MOCK_CMD_BIND_IMAGE_DESCRIPTOR_SET,
+    MOCK_CMD_BIND_SAMPLER_DESCRIPTOR_SET,
+    MOCK_CMD_BIND_TEXTURE,
+    MOCK_CMD_BIND_IMAGE,
+    MOCK_CMD_BIND_RENDER_TARGETS,
+    MOCK_CMD_SET_VIEWPORTS,
+    MOCK_CMD_SET_SCISSORS,
+    MOCK_CMD_CLEAR_COLOR,
+    MOCK_CMD_CLEAR_DEPTH_STENCIL,
+    MOCK_CMD_DRAW,
+    MOCK_CMD_BIND_DEPTH_STENCIL_STATE,
+    MOCK_CMD_BIND_VTX_ATTRIB_STATE,
+    MOCK_CMD_BIND_VTX_BUFFER_STATE,
+    MOCK_CMD_BIND_VTX_BUFFERS,
+    NUM_MOCK_CMDS,
+};
+
+// One recorded call. args and addr hold the scalar arguments in call order,
+// data a copy of whatever the call pointed to.
+struct mock_cmd
+{
+    enum mock_cmd_type type;
+    uint32_t args[5];
+    DkGpuAddr addr;
+    void* data;
+    uint32_t data_size;
+};
+
+struct mock_buffer
+{
+    uint8_t* data;
+    uint32_t size;
+};
+
+struct mock_dispatch
+{
+    struct mock_program const* program;
+    uint32_t grid_dims[3];
+    struct mock_buffer storage[MOCK_MAX_STORAGE_BUFFERS];
+};
+
+struct mock_hooks
+{
+    void* user;
+    // Called for every command before the mock's own handling, may be NULL
+    void (*command)(void* user, struct mock_cmd const* cmd);
+    // Runs compute dispatches, which are dropped without it
+    void (*dispatch)(void* user, struct mock_dispatch const* dispatch);
+};
+
+void mock_set_hooks(struct mock_hooks const* hooks);
+
+// Host memory behind a GPU address range, NULL unless the range is inside a
+// live memory block
+void* mock_gpu_to_cpu(DkGpuAddr addr, uint32_t size);
+
+char const* mock_cmd_name(enum mock_cmd_type type);
@@ -0,0 +1,93 @@
+// libnx's sha256CalculateHash, FIPS 180-4 SHA-256. On its own so the hash
+// benchmark can use it without the rest of the mock.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <switch.h>
+
+static uint32_t const sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static uint32_t rotr(uint32_t value, int shift)
+{
+    return value >> shift | value << (32 - shift);
+}
+
+static void sha256_block(uint32_t state[8], uint8_t const block[64])
+{
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i)
+    {
+        w[i] = (uint32_t)block[i * 4] << 24 | (uint32_t)block[i * 4 + 1] << 16
+            | (uint32_t)block[i * 4 + 2] << 8 | block[i * 4 + 3];
+    }
+    for (int i = 16; i < 64; ++i)
+    {
+        uint32_t const s0 =
+            rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ w[i - 15] >> 3;
+        uint32_t const s1 =
+            rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ w[i - 2] >> 10;
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t v[8];
+    memcpy(v, state, sizeof(v));
+    for (int i = 0; i < 64; ++i)
+    {
+        uint32_t const s1 = rotr(v[4], 6) ^ rotr(v[4], 11) ^ rotr(v[4], 25);
+        uint32_t const ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+        uint32_t const t1 = v[7] + s1 + ch + sha256_k[i] + w[i];
+        uint32_t const s0 = rotr(v[0], 2) ^ rotr(v[0], 13) ^ rotr(v[0], 22);
+        uint32_t const maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+        memmove(&v[1], &v[0], 7 * sizeof(v[0]));
+        v[4] += t1;
+        v[0] = t1 + s0 + maj;
+    }
+    for (int i = 0; i < 8; ++i)
+        state[i] += v[i];
+}
+
+void sha256CalculateHash(void* dst, void const* src, size_t size)
+{
+    uint32_t state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    uint8_t const* const data = src;
+    size_t offset = 0;
+    for (; offset + 64 <= size; offset += 64)
+        sha256_block(state, data + offset);
+
+    // Padding: 0x80, zeros, then the length in bits, big endian
+    uint8_t tail[128] = {0};
+    size_t const remaining = size - offset;
+    memcpy(tail, data + offset, remaining);
+    tail[remaining] = 0x80;
+    size_t const tail_size = remaining < 56 ? 64 : 128;
+    uint64_t const bits = (uint64_t)size * 8;
+    for (int i = 0; i < 8; ++i)
+        tail[tail_size - 1 - i] = (uint8_t)(bits >> (i * 8));
+    for (size_t i = 0; i < tail_size; i += 64)
+        sha256_block(state, tail + i);
+
+    uint8_t* const out = dst;
+    for (int i = 0; i < 8; ++i)
+    {
+        out[i * 4] = state[i] >> 24;
+        out[i * 4 + 1] = state[i] >> 16;
+        out[i * 4 + 2] = state[i] >> 8;
+        out[i * 4 + 3] = state[i];
+    }
+}
@@ -0,0 +1,101 @@
+// Cycles the graphics command buffer ring through the deko3d mock. Every
+// submission pushes its number to memory, and once a slot comes around again
+// its previous submission must have landed. With MOCK_FENCE_DELAY at
+// CMDBUF_RING_SIZE or more, the mock still holds that submission back and
+// the ring has to wait on the slot's fence. Every other submission pushes
+// more than a chunk of command memory, so the slots also grow and start over
+// from their first chunk.
+//
+// Usage: MOCK_FENCE_DELAY=<n> ring_check
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <deko3d.h>
+
+#include "cmdbuf_ring.h"
+#include "helper.h"
+
+#define NUM_ROUNDS 5
+#define NUM_SUBMITS (CMDBUF_RING_SIZE * NUM_ROUNDS)
+#define LARGE_PUSH_SIZE 0x1800
+
+// libnx's runtime hooks, the mock calls them around main
+void userAppInit(void)
+{
+}
+
+void userAppExit(void)
+{
+}
+
+static bool check_value(uint32_t const* values, uint32_t index)
+{
+    if (values[index] == index + 1)
+        return true;
+    fprintf(stderr, "Submission %u read back as %u\n", index, values[index]);
+    return false;
+}
+
+int main(void)
+{
+    DkDeviceMaker device_mk;
+    dkDeviceMakerDefaults(&device_mk);
+    DkDevice const device = dkDeviceCreate(&device_mk);
+    DkQueueMaker queue_mk;
+    dkQueueMakerDefaults(&queue_mk, device);
+    DkQueue const queue = dkQueueCreate(&queue_mk);
+
+    uint32_t const flags =
+        DkMemBlockFlags_CpuUncached | DkMemBlockFlags_GpuCached;
+    DkMemBlock const results =
+        make_memory_block(device, NUM_SUBMITS * sizeof(uint32_t), flags);
+    DkMemBlock const scratch =
+        make_memory_block(device, LARGE_PUSH_SIZE, flags);
+    uint32_t const* const values = dkMemBlockGetCpuAddr(results);
+    uint8_t* const large_push = checked_malloc(LARGE_PUSH_SIZE);
+
+    struct cmdbuf_ring ring;
+    cmdbuf_ring_init(&ring, device);
+    bool ok = true;
+    uint32_t num_waits = 0;
+    for (uint32_t i = 0; i < NUM_SUBMITS; ++i)
+    {
+        // The slot's last submission is done once it is handed out again
+        bool const is_reused = i >= CMDBUF_RING_SIZE;
+        if (is_reused && values[i - CMDBUF_RING_SIZE] == 0)
+            ++num_waits;
+        DkCmdBuf const cmdbuf = cmdbuf_ring_acquire(&ring);
+        if (is_reused)
+            ok = check_value(values, i - CMDBUF_RING_SIZE) && ok;
+
+        if (i % 2)
+        {
+            dkCmdBufPushData(cmdbuf, dkMemBlockGetGpuAddr(scratch),
+                large_push, LARGE_PUSH_SIZE);
+        }
+        uint32_t const value = i + 1;
+        dkCmdBufPushData(cmdbuf,
+            dkMemBlockGetGpuAddr(results) + i * sizeof(value), &value,
+            sizeof(value));
+        dkQueueSubmitCommands(queue, dkCmdBufFinishList(cmdbuf));
+        cmdbuf_ring_signal(&ring, queue, cmdbuf);
+    }
+
+    cmdbuf_ring_wait(&ring);
+    for (uint32_t i = 0; i < NUM_SUBMITS; ++i)
+        ok = check_value(values, i) && ok;
+
+    cmdbuf_ring_destroy(&ring);
+    free(large_push);
+    dkMemBlockDestroy(scratch);
+    dkMemBlockDestroy(results);
+    dkQueueDestroy(queue);
+    dkDeviceDestroy(device);
+
+    printf("%d submissions through %d slots, %u waited for: %s\n",
+        NUM_SUBMITS, CMDBUF_RING_SIZE, num_waits, ok ? "OK" : "FAILED");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,1670 @@
+// Reference interpreter for the Maxwell programs used by the compute tests.
+//
+// Threads are grouped in warps that execute in lockstep. Divergence is
+// tracked with a reconvergence stack holding SSY, PBK and CAL tokens, plus
+// the not-taken side of divergent branches.
+
+#include <fenv.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fp16.h"
+#include "sass_decode.h"
+#include "sass_interp.h"
+
+#define CBUF_SIZE 0x10000
+#define STORAGE_CBUF_OFFSET 0x140
+#define STORAGE_BASE_ADDR UINT64_C(0x100000000)
+#define STORAGE_ADDR_STRIDE UINT64_C(0x100000000)
+#define STACK_DEPTH 32
+#define MAX_STEPS (1 << 22)
+
+enum stack_kind
+{
+    STACK_SSY,
+    STACK_PBK,
+    STACK_CAL,
+    STACK_DIV,
+    STACK_ANY,
+};
+
+struct stack_entry
+{
+    enum stack_kind kind;
+    uint32_t mask;
+    size_t target;
+};
+
+struct lane
+{
+    uint32_t regs[256];
+    bool preds[8];
+    bool zero, sign, carry, overflow;
+    uint32_t tid[3];
+    uint8_t* local;
+};
+
+struct warp
+{
+    struct lane* lanes;
+    uint32_t present;
+    uint32_t active;
+    uint32_t exited;
+    size_t pc;
+    struct stack_entry stack[STACK_DEPTH];
+    int depth;
+};
+
+struct machine
+{
+    struct sass_launch const* launch;
+    enum sass_opcode* ops;
+    size_t num_insns;
+    uint8_t* cbuf0;
+    uint8_t* shared;
+    uint32_t ctaid[3];
+    char* error;
+    size_t error_size;
+    bool faulted;
+};
+
+static bool fault(struct machine* m, char const* format, ...)
+{
+    if (!m->faulted)
+    {
+        va_list args;
+        va_start(args, format);
+        vsnprintf(m->error, m->error_size, format, args);
+        va_end(args);
+        m->faulted = true;
+    }
+    return false;
+}
+
+static uint32_t read_reg(struct lane const* lane, int reg)
+{
+    return reg == SASS_REG_RZ ? 0 : lane->regs[reg];
+}
+
+static void write_reg(struct lane* lane, int reg, uint32_t value)
+{
+    if (reg != SASS_REG_RZ)
+        lane->regs[reg] = value;
+}
+
+static bool read_pred(struct lane const* lane, int pred)
+{
+    return pred == SASS_PRED_PT ? true : lane->preds[pred];
+}
+
+static void write_pred(struct lane* lane, int pred, bool value)
+{
+    if (pred != SASS_PRED_PT)
+        lane->preds[pred] = value;
+}
+
+static float as_float(uint32_t value)
+{
+    float f;
+    memcpy(&f, &value, sizeof(f));
+    return f;
+}
+
+static uint32_t as_uint(float value)
+{
+    uint32_t u;
+    memcpy(&u, &value, sizeof(u));
+    return u;
+}
+
+static float flush_denorm(float value)
+{
+    return fpclassify(value) == FP_SUBNORMAL ? copysignf(0.0f, value) : value;
+}
+
+static uint32_t cbuf_read(struct machine* m, int index, uint32_t offset)
+{
+    if (index != 0 || offset + 4 > CBUF_SIZE)
+    {
+        fault(m, "read from c[0x%x][0x%x]", index, offset);
+        return 0;
+    }
+    uint32_t value;
+    memcpy(&value, m->cbuf0 + offset, sizeof(value));
+    return value;
+}
+
+// Second operand of instructions with register, constant buffer and
+// immediate forms, told apart by their top nibble.
+static uint32_t operand_b(struct machine* m, struct lane const* lane,
+    uint64_t insn)
+{
+    switch (insn >> 60)
+    {
+    case 0x5:
+        return read_reg(lane, sass_src_b(insn));
+    case 0x4:
+        return cbuf_read(m, sass_cbuf_index(insn), sass_cbuf_offset(insn));
+    default:
+        return sass_imm20(insn);
+    }
+}
+
+static uint32_t operand_fb(struct machine* m, struct lane const* lane,
+    uint64_t insn)
+{
+    return insn >> 60 == 0x3 ? sass_fimm20(insn) : operand_b(m, lane, insn);
+}
+
+static bool test_flow(struct lane const* lane, int test)
+{
+    bool const z = lane->zero, s = lane->sign, c = lane->carry;
+    bool const o = lane->overflow;
+    switch (test)
+    {
+    case SASS_FLOW_F:   return false;
+    case SASS_FLOW_LT:  return (s != o) && !z;
+    case SASS_FLOW_EQ:  return !s && z;
+    case SASS_FLOW_LE:  return s != (z || o);
+    case SASS_FLOW_GT:  return (!s != o) && !z;
+    case SASS_FLOW_NE:  return !z;
+    case SASS_FLOW_GE:  return !s != o;
+    case SASS_FLOW_NUM: return !s || !z;
+    case SASS_FLOW_NAN: return s && z;
+    case SASS_FLOW_LTU: return s != o;
+    case SASS_FLOW_EQU: return z;
+    case SASS_FLOW_LEU: return (s != o) || z;
+    case SASS_FLOW_GTU: return !s != (z || o);
+    case SASS_FLOW_NEU: return s || !z;
+    case SASS_FLOW_GEU: return (!s || z) != o;
+    case SASS_FLOW_T:   return true;
+    case SASS_FLOW_OFF: return !o;
+    case SASS_FLOW_LO:  return !c;
+    case SASS_FLOW_SFF: return !(z || s);
+    case SASS_FLOW_LS:  return z || !c;
+    case SASS_FLOW_HI:  return c && !z;
+    case SASS_FLOW_SFT: return z || s;
+    case SASS_FLOW_HS:  return c;
+    case SASS_FLOW_OFT: return o;
+    default:            return false;
+    }
+}
+
+static bool compare_float(int op, float a, float b)
+{
+    bool const unordered = isnan(a) || isnan(b);
+    switch (op)
+    {
+    case 0:  return false;
+    case 1:  return a < b;
+    case 2:  return a == b;
+    case 3:  return a <= b;
+    case 4:  return a > b;
+    case 5:  return !unordered && a != b;
+    case 6:  return a >= b;
+    case 7:  return !unordered;
+    case 8:  return unordered;
+    case 9:  return unordered || a < b;
+    case 10: return unordered || a == b;
+    case 11: return unordered || a <= b;
+    case 12: return unordered || a > b;
+    case 13: return a != b;
+    case 14: return unordered || a >= b;
+    default: return true;
+    }
+}
+
+static bool combine_pred(int bop, bool a, bool b)
+{
+    switch (bop)
+    {
+    case 0:  return a && b;
+    case 1:  return a || b;
+    default: return a != b;
+    }
+}
+
+static void set_zs(struct lane* lane, uint32_t result)
+{
+    lane->zero = result == 0;
+    lane->sign = result >> 31;
+}
+
+static void set_cc(struct lane* lane, uint32_t result, bool carry,
+    bool overflow)
+{
+    set_zs(lane, result);
+    lane->carry = carry;
+    lane->overflow = overflow;
+}
+
+static int float_rounding(int rounding)
+{
+    static int const modes[] = {FE_TONEAREST, FE_DOWNWARD, FE_UPWARD,
+        FE_TOWARDZERO};
+    return modes[rounding & 3];
+}
+
+static float round_to_float(double value, int rounding)
+{
+    int const saved = fegetround();
+    fesetround(float_rounding(rounding));
+    volatile float const result = (float)value;
+    fesetround(saved);
+    return result;
+}
+
+static double round_integral(double value, int rounding)
+{
+    switch (rounding & 3)
+    {
+    case 0:
+        return nearbyint(value);
+    case 1:
+        return floor(value);
+    case 2:
+        return ceil(value);
+    default:
+        return trunc(value);
+    }
+}
+
+static uint32_t saturate_int(int64_t value, int width, bool is_signed)
+{
+    int64_t const min = is_signed ? -(INT64_C(1) << (width - 1)) : 0;
+    int64_t const max = is_signed ? (INT64_C(1) << (width - 1)) - 1
+                                  : (INT64_C(1) << width) - 1;
+    if (value < min)
+        value = min;
+    if (value > max)
+        value = max;
+    return (uint32_t)value;
+}
+
+static uint32_t float_to_int(double value, int width, bool is_signed)
+{
+    if (isnan(value))
+        return 0;
+    int64_t const min = is_signed ? -(INT64_C(1) << (width - 1)) : 0;
+    int64_t const max = is_signed ? (INT64_C(1) << (width - 1)) - 1
+                                  : (INT64_C(1) << width) - 1;
+    if (value <= (double)min)
+        return (uint32_t)min;
+    if (value >= (double)max)
+        return (uint32_t)max;
+    return (uint32_t)(int64_t)value;
+}
+
+static uint32_t bit_reverse(uint32_t value)
+{
+    uint32_t result = 0;
+    for (int i = 0; i < 32; ++i)
+        result |= ((value >> i) & 1) << (31 - i);
+    return result;
+}
+
+static int find_msb(uint32_t value)
+{
+    for (int i = 31; i >= 0; --i)
+    {
+        if (value >> i & 1)
+            return i;
+    }
+    return -1;
+}
+
+static uint8_t* storage_ptr(struct machine* m, uint64_t addr, uint32_t size)
+{
+    for (int i = 0; i < SASS_MAX_STORAGE_BUFFERS; ++i)
+    {
+        struct sass_storage_buffer const* buffer = &m->launch->storage[i];
+        uint64_t const base = STORAGE_BASE_ADDR + i * STORAGE_ADDR_STRIDE;
+        if (buffer->data && addr >= base && addr + size <= base + buffer->size)
+            return buffer->data + (addr - base);
+    }
+    fault(m, "global access of %u bytes at 0x%llx out of bounds", size,
+        (unsigned long long)addr);
+    return NULL;
+}
+
+static uint8_t* memory_ptr(struct machine* m, uint8_t* base, uint32_t limit,
+    uint32_t addr, uint32_t size, char const* space)
+{
+    if ((uint64_t)addr + size > limit)
+    {
+        fault(m, "%s access of %u bytes at 0x%x out of bounds", space, size,
+            addr);
+        return NULL;
+    }
+    return base + addr;
+}
+
+static uint32_t access_size(int size)
+{
+    static uint32_t const sizes[] = {1, 1, 2, 2, 4, 8, 16, 16};
+    return sizes[size & 7];
+}
+
+static bool load(struct machine* m, struct lane* lane, uint8_t const* ptr,
+    int size, int dest)
+{
+    uint32_t const bytes = access_size(size);
+    uint32_t words[4] = {0};
+    if (!ptr)
+        return false;
+    memcpy(words, ptr, bytes);
+    switch (size)
+    {
+    case 1:
+        words[0] = (uint32_t)(int8_t)words[0];
+        break;
+    case 3:
+        words[0] = (uint32_t)(int16_t)words[0];
+        break;
+    }
+    uint32_t const num_words = bytes < 4 ? 1 : bytes / 4;
+    if (dest != SASS_REG_RZ && dest % num_words != 0)
+        return fault(m, "misaligned destination register R%d", dest);
+    for (uint32_t i = 0; i < num_words; ++i)
+        write_reg(lane, dest == SASS_REG_RZ ? dest : dest + (int)i, words[i]);
+    return true;
+}
+
+static bool store(struct lane const* lane, uint8_t* ptr, int size, int src)
+{
+    uint32_t const bytes = access_size(size);
+    uint32_t words[4];
+    if (!ptr)
+        return false;
+    for (uint32_t i = 0; i < (bytes + 3) / 4; ++i)
+        words[i] = read_reg(lane, src == SASS_REG_RZ ? src : src + (int)i);
+    memcpy(ptr, words, bytes);
+    return true;
+}
+
+static bool check_alignment(struct machine* m, uint64_t addr, int size)
+{
+    if (addr % access_size(size) != 0)
+    {
+        return fault(m, "misaligned access of %u bytes at 0x%llx",
+            access_size(size), (unsigned long long)addr);
+    }
+    return true;
+}
+
+static uint64_t global_address(struct lane const* lane, int reg, bool wide,
+    int64_t offset)
+{
+    uint64_t addr = read_reg(lane, reg);
+    if (wide && reg != SASS_REG_RZ)
+        addr |= (uint64_t)read_reg(lane, reg + 1) << 32;
+    return addr + (uint64_t)offset;
+}
+
+static uint32_t atomic_op(int op, int size, uint32_t old, uint32_t value,
+    bool* supported)
+{
+    bool const is_signed = size == 1;
+    *supported = true;
+    switch (op)
+    {
+    case 0:
+        return old + value;
+    case 1:
+        if (is_signed)
+            return (int32_t)old < (int32_t)value ? old : value;
+        return old < value ? old : value;
+    case 2:
+        if (is_signed)
+            return (int32_t)old > (int32_t)value ? old : value;
+        return old > value ? old : value;
+    case 3:
+        return old >= value ? 0 : old + 1;
+    case 4:
+        return old == 0 || old > value ? value : old - 1;
+    case 5:
+        return old & value;
+    case 6:
+        return old | value;
+    case 7:
+        return old ^ value;
+    case 8:
+        return value;
+    default:
+        *supported = false;
+        return old;
+    }
+}
+
+static bool atomic(struct machine* m, uint8_t* ptr, int op, int size,
+    uint32_t value, uint32_t* old)
+{
+    bool supported;
+    if (!ptr)
+        return false;
+    if (size > 1)
+        return fault(m, "unsupported atomic size %d", size);
+    memcpy(old, ptr, sizeof(*old));
+    uint32_t const result = atomic_op(op, size, *old, value, &supported);
+    if (!supported)
+        return fault(m, "unsupported atomic operation %d", op);
+    memcpy(ptr, &result, sizeof(result));
+    return true;
+}
+
+static bool execute_iadd(struct lane* lane, uint64_t insn, uint32_t a,
+    uint32_t b, bool neg_a, bool neg_b, bool x, bool sat, bool cc)
+{
+    uint32_t const carry_in = x ? lane->carry : 0;
+    uint64_t const sum = (uint64_t)(neg_a ? ~a : a) + (neg_b ? ~b : b)
+        + carry_in + neg_a + neg_b;
+    int64_t const signed_sum = (neg_a ? -(int64_t)(int32_t)a : (int32_t)a)
+        + (neg_b ? -(int64_t)(int32_t)b : (int32_t)b) + carry_in;
+
+    uint32_t result = (uint32_t)sum;
+    bool const overflow = signed_sum != (int32_t)signed_sum;
+    if (sat)
+        result = saturate_int(signed_sum, 32, true);
+
+    write_reg(lane, sass_dest(insn), result);
+    if (cc)
+    {
+        bool const zero_in = x ? lane->zero : true;
+        set_cc(lane, result, (sum >> 32) != 0, overflow);
+        lane->zero = lane->zero && zero_in;
+    }
+    return true;
+}
+
+static bool execute_shf(struct lane* lane, uint64_t insn, uint32_t shift,
+    bool left)
+{
+    uint32_t const lo = read_reg(lane, sass_src_a(insn));
+    uint32_t const hi = read_reg(lane, sass_src_c(insn));
+    int const max_shift = (int)sass_bits(insn, 37, 2);
+    bool const wrap = sass_bits(insn, 50, 1);
+    uint64_t const value = ((uint64_t)hi << 32) | lo;
+    uint32_t const limit = max_shift == 0 ? 32 : 64;
+
+    if (wrap)
+        shift &= limit - 1;
+    else if (shift > limit)
+        shift = limit;
+
+    uint32_t result;
+    if (left)
+    {
+        result = shift >= 64 ? 0 : (uint32_t)((value << shift) >> 32);
+    }
+    else if (max_shift == 3)
+    {
+        int64_t const svalue = (int64_t)value;
+        result = (uint32_t)(svalue >> (shift >= 64 ? 63 : shift));
+    }
+    else
+    {
+        result = shift >= 64 ? 0 : (uint32_t)(value >> shift);
+    }
+    write_reg(lane, sass_dest(insn), result);
+    if (sass_writes_cc(insn))
+        set_zs(lane, result);
+    return true;
+}
+
+static uint32_t extract_selected(uint32_t value, int format, int selector,
+    bool is_signed)
+{
+    value >>= selector * 8;
+    switch (format)
+    {
+    case 0:
+        return is_signed ? (uint32_t)(int8_t)value : (value & 0xff);
+    case 1:
+        return is_signed ? (uint32_t)(int16_t)value : (value & 0xffff);
+    default:
+        return value;
+    }
+}
+
+static bool execute_i2i(struct lane* lane, uint64_t insn, uint32_t src)
+{
+    int const dst_format = (int)sass_bits(insn, 8, 2);
+    int const src_format = (int)sass_bits(insn, 10, 2);
+    bool const dst_signed = sass_bits(insn, 12, 1);
+    bool const src_signed = sass_bits(insn, 13, 1);
+    int const selector = (int)sass_bits(insn, 41, 2);
+    bool const neg = sass_bits(insn, 45, 1);
+    bool const abs = sass_bits(insn, 49, 1);
+    bool const sat = sass_bits(insn, 50, 1);
+
+    uint32_t const extracted =
+        extract_selected(src, src_format, selector, src_signed);
+    int64_t value = src_signed ? (int64_t)(int32_t)extracted : extracted;
+    if (abs && value < 0)
+        value = -value;
+    if (neg)
+        value = -value;
+
+    int const width = dst_format == 0 ? 8 : dst_format == 1 ? 16 : 32;
+    // Saturated results keep their sign extension, truncated ones don't
+    uint32_t result = (uint32_t)value;
+    if (sat)
+        result = saturate_int(value, width, dst_signed);
+    else if (width < 32)
+        result &= (UINT32_C(1) << width) - 1;
+
+    write_reg(lane, sass_dest(insn), result);
+    if (sass_writes_cc(insn))
+        set_zs(lane, result);
+    return true;
+}
+
+static bool execute_i2f(struct machine* m, struct lane* lane, uint64_t insn,
+    uint32_t src)
+{
+    int const float_format = (int)sass_bits(insn, 8, 2);
+    int const int_format = (int)sass_bits(insn, 10, 2);
+    bool const is_signed = sass_bits(insn, 13, 1);
+    int const rounding = (int)sass_bits(insn, 39, 2);
+    int const selector = (int)sass_bits(insn, 41, 2);
+    bool const neg = sass_bits(insn, 45, 1);
+    bool const abs = sass_bits(insn, 49, 1);
+
+    if (int_format == 3)
+        return fault(m, "unsupported I2F source format");
+
+    uint32_t const extracted =
+        extract_selected(src, int_format, selector, is_signed);
+    double value = is_signed ? (double)(int32_t)extracted : extracted;
+    if (abs)
+        value = fabs(value);
+    if (neg)
+        value = -value;
+
+    uint32_t result;
+    switch (float_format)
+    {
+    case 1:
+        result = fp16_from_double(value, rounding);
+        break;
+    case 2:
+        result = as_uint(round_to_float(value, rounding));
+        break;
+    default:
+        return fault(m, "unsupported I2F destination format");
+    }
+    write_reg(lane, sass_dest(insn), result);
+    if (sass_writes_cc(insn))
+        set_zs(lane, result);
+    return true;
+}
+
+static bool read_float_source(struct machine* m, uint32_t src, int format,
+    bool h1, double* value)
+{
+    switch (format)
+    {
+    case 1:
+        *value = fp16_to_float(h1 ? src >> 16 : src & 0xffff);
+        return true;
+    case 2:
+        *value = as_float(src);
+        return true;
+    default:
+        return fault(m, "unsupported floating-point format %d", format);
+    }
+}
+
+static bool execute_f2i(struct machine* m, struct lane* lane, uint64_t insn,
+    uint32_t src)
+{
+    int const dest_format = (int)sass_bits(insn, 8, 2);
+    int const src_format = (int)sass_bits(insn, 10, 2);
+    bool const is_signed = sass_bits(insn, 12, 1);
+    int const rounding = (int)sass_bits(insn, 39, 2);
+    bool const h1 = sass_bits(insn, 41, 1);
+    bool const ftz = sass_bits(insn, 44, 1);
+    bool const neg = sass_bits(insn, 45, 1);
+    bool const abs = sass_bits(insn, 49, 1);
+
+    if (dest_format == 3)
+        return fault(m, "unsupported F2I destination format");
+    int const width = dest_format == 1 ? 16 : 32;
+
+    uint32_t result;
+    if (src_format == 1)
+    {
+        uint16_t half = h1 ? src >> 16 : src & 0xffff;
+        if (abs)
+            half &= 0x7fff;
+        if (neg)
+            half ^= 0x8000;
+        result = fp16_to_int(half, rounding, width, is_signed);
+    }
+    else
+    {
+        double value = 0.0;
+        if (!read_float_source(m, src, src_format, h1, &value))
+            return false;
+        if (ftz)
+            value = flush_denorm((float)value);
+        if (abs)
+            value = fabs(value);
+        if (neg)
+            value = -value;
+        result = float_to_int(round_integral(value, rounding), width,
+            is_signed);
+    }
+    write_reg(lane, sass_dest(insn), result);
+    if (sass_writes_cc(insn))
+        set_zs(lane, result);
+    return true;
+}
+
+static bool execute_f2f(struct machine* m, struct lane* lane, uint64_t insn,
+    uint32_t src)
+{
+    int const dst_format = (int)sass_bits(insn, 8, 2);
+    int const src_format = (int)sass_bits(insn, 10, 2);
+    int const rounding = (int)sass_bits(insn, 39, 2);
+    bool const h1 = sass_bits(insn, 41, 1);
+    bool const integral = sass_bits(insn, 42, 1);
+    bool const ftz = sass_bits(insn, 44, 1);
+    bool const neg = sass_bits(insn, 45, 1);
+    bool const abs = sass_bits(insn, 49, 1);
+    bool const sat = sass_bits(insn, 50, 1);
+
+    double value = 0.0;
+    if (!read_float_source(m, src, src_format, h1, &value))
+        return false;
+    if (ftz && src_format == 2)
+        value = flush_denorm((float)value);
+    if (abs)
+        value = fabs(value);
+    if (neg)
+        value = -value;
+    if (integral)
+        value = round_integral(value, rounding);
+    if (sat)
+        value = isnan(value) ? 0.0 : fmin(fmax(value, 0.0), 1.0);
+
+    uint32_t result;
+    switch (dst_format)
+    {
+    case 1:
+        result = fp16_from_double(value, integral ? 0 : rounding);
+        break;
+    case 2:
+    {
+        float const f = round_to_float(value, integral ? 0 : rounding);
+        result = as_uint(ftz ? flush_denorm(f) : f);
+        break;
+    }
+    default:
+        return fault(m, "unsupported F2F destination format");
+    }
+    write_reg(lane, sass_dest(insn), result);
+    if (sass_writes_cc(insn))
+        set_zs(lane, result);
+    return true;
+}
+
+static bool execute_half_arith(struct lane* lane, uint64_t insn,
+    enum sass_opcode op)
+{
+    struct fp16x2_mods mods = {
+        .swizzle_a = (enum fp16_swizzle)sass_bits(insn, 47, 2),
+        .swizzle_b = (enum fp16_swizzle)sass_bits(insn, 28, 2),
+        .neg_b = sass_bits(insn, 31, 1),
+        .sat = sass_bits(insn, 32, 1),
+        .merge = (enum fp16_merge)sass_bits(insn, 49, 2),
+    };
+    enum fp16x2_op fp16_op;
+    uint32_t c = 0;
+    if (op == SASS_OP_HFMA2_REG)
+    {
+        fp16_op = FP16X2_FMA;
+        c = read_reg(lane, sass_src_c(insn));
+        mods.swizzle_c = (enum fp16_swizzle)sass_bits(insn, 35, 2);
+        mods.neg_c = sass_bits(insn, 30, 1);
+        mods.ftz = sass_bits(insn, 37, 2) != 0;
+    }
+    else
+    {
+        fp16_op = op == SASS_OP_HADD2_REG ? FP16X2_ADD : FP16X2_MUL;
+        mods.abs_a = sass_bits(insn, 44, 1);
+        mods.neg_a = sass_bits(insn, 43, 1);
+        mods.abs_b = sass_bits(insn, 30, 1);
+        mods.ftz = sass_bits(insn, 39, 1);
+    }
+
+    int const dest = sass_dest(insn);
+    write_reg(lane, dest, fp16x2_execute(fp16_op, &mods,
+        read_reg(lane, sass_src_a(insn)), read_reg(lane, sass_src_b(insn)),
+        c, read_reg(lane, dest)));
+    return true;
+}
+
+// HSET2 and HSETP2 compare both halves with the same operation
+static void compare_halves(struct lane* lane, uint64_t insn, bool results[2])
+{
+    float va[2], vb[2];
+    fp16x2_unpack(read_reg(lane, sass_src_a(insn)),
+        (enum fp16_swizzle)sass_bits(insn, 47, 2), sass_bits(insn, 44, 1),
+        sass_bits(insn, 43, 1), false, va);
+    fp16x2_unpack(read_reg(lane, sass_src_b(insn)),
+        (enum fp16_swizzle)sass_bits(insn, 28, 2), sass_bits(insn, 30, 1),
+        sass_bits(insn, 31, 1), false, vb);
+
+    int const compare_op = (int)sass_bits(insn, 35, 4);
+    bool const pred = read_pred(lane, (int)sass_bits(insn, 39, 3))
+        != (bool)sass_bits(insn, 42, 1);
+    int const bop = (int)sass_bits(insn, 45, 2);
+    for (int i = 0; i < 2; ++i)
+    {
+        results[i] = combine_pred(bop,
+            compare_float(compare_op, va[i], vb[i]), pred);
+    }
+}
+
+static bool execute_vmnmx(struct machine* m, struct lane* lane,
+    uint64_t insn)
+{
+    bool const a_signed = sass_bits(insn, 48, 1);
+    bool const b_signed = sass_bits(insn, 49, 1);
+    bool const b_is_reg = sass_bits(insn, 50, 1);
+    int const op = (int)sass_bits(insn, 51, 3);
+    bool const dest_signed = sass_bits(insn, 54, 1);
+    bool const sat = sass_bits(insn, 55, 1);
+    bool const is_max = sass_bits(insn, 56, 1);
+
+    if (sass_bits(insn, 36, 3) != 2
+        || (b_is_reg && sass_bits(insn, 28, 3) != 2))
+        return fault(m, "unsupported VMNMX operand selector");
+
+    uint32_t const raw_a = read_reg(lane, sass_src_a(insn));
+    uint32_t const raw_b = b_is_reg ? read_reg(lane, sass_src_b(insn))
+                                    : (uint32_t)sass_bits(insn, 20, 16);
+    uint32_t const c = read_reg(lane, sass_src_c(insn));
+    int64_t const a = a_signed ? (int64_t)(int32_t)raw_a : raw_a;
+    int64_t const b = b_signed ? (int64_t)(int32_t)raw_b : raw_b;
+    int64_t const value = is_max ? (a > b ? a : b) : (a < b ? a : b);
+    uint32_t result = sat ? saturate_int(value, 32, dest_signed)
+                          : (uint32_t)value;
+
+    // The secondary operation applies to the saturated result
+    int64_t const signed_result =
+        dest_signed ? (int64_t)(int32_t)result : result;
+    int64_t const signed_c = dest_signed ? (int64_t)(int32_t)c : c;
+    switch (op)
+    {
+    case 4:
+        result += c;
+        break;
+    case 5:
+        result = (uint32_t)(signed_result < signed_c ? signed_result
+                                                     : signed_c);
+        break;
+    case 6:
+        result = (uint32_t)(signed_result > signed_c ? signed_result
+                                                     : signed_c);
+        break;
+    case 0:
+        result = (result << 16) | (c & 0xffff);
+        break;
+    case 1:
+        result = (c & 0xffff0000) | (result & 0xffff);
+        break;
+    case 2:
+        result = (c & 0xffffff00) | (result & 0xff);
+        break;
+    case 3:
+        result = (c & 0xff00ffff) | ((result & 0xff) << 16);
+        break;
+    }
+    write_reg(lane, sass_dest(insn), result);
+    if (sass_writes_cc(insn))
+        set_zs(lane, result);
+    return true;
+}
+
+static bool execute_xmad(struct machine* m, struct lane* lane, uint64_t insn)
+{
+    bool const a_signed = sass_bits(insn, 48, 1);
+    bool const b_signed = sass_bits(insn, 49, 1);
+    bool const half_a = sass_bits(insn, 53, 1);
+    bool const half_b = sass_bits(insn, 35, 1);
+    bool const psl = sass_bits(insn, 36, 1);
+    bool const mrg = sass_bits(insn, 37, 1);
+    bool const x = sass_bits(insn, 38, 1);
+    int const mode = (int)sass_bits(insn, 50, 3);
+
+    uint32_t const a = read_reg(lane, sass_src_a(insn));
+    uint32_t const b = read_reg(lane, sass_src_b(insn));
+    uint32_t const c = read_reg(lane, sass_src_c(insn));
+
+    uint32_t op_a = half_a ? a >> 16 : a & 0xffff;
+    uint32_t op_b = half_b ? b >> 16 : b & 0xffff;
+    if (a_signed)
+        op_a = (uint32_t)(int16_t)op_a;
+    if (b_signed)
+        op_b = (uint32_t)(int16_t)op_b;
+
+    uint32_t product = op_a * op_b;
+    if (psl)
+        product <<= 16;
+
+    uint32_t op_c;
+    switch (mode)
+    {
+    case 0:
+        op_c = c;
+        break;
+    case 1:
+        op_c = c & 0xffff;
+        break;
+    case 2:
+        op_c = c >> 16;
+        break;
+    case 3:
+        op_c = product & 0x8000 ? c + 0xffff0000 : c;
+        break;
+    case 4:
+        op_c = (b << 16) + c;
+        break;
+    default:
+        return fault(m, "unsupported XMAD mode %d", mode);
+    }
+
+    uint32_t const carry_in = x ? lane->carry : 0;
+    uint64_t const sum = (uint64_t)product + op_c + carry_in;
+    uint32_t result = (uint32_t)sum;
+    if (mrg)
+        result = (result & 0xffff) | (b << 16);
+
+    write_reg(lane, sass_dest(insn), result);
+    if (sass_writes_cc(insn))
+        set_cc(lane, result, (sum >> 32) != 0, false);
+    return true;
+}
+
+static bool execute_lane(struct machine* m, struct lane* lane,
+    uint32_t lane_id, uint64_t insn, enum sass_opcode op)
+{
+    int const dest = sass_dest(insn);
+    bool const cc = sass_writes_cc(insn);
+
+    switch (op)
+    {
+    case SASS_OP_NOP:
+    case SASS_OP_DEPBAR:
+    case SASS_OP_MEMBAR:
+        return true;
+
+    case SASS_OP_MOV32I:
+        write_reg(lane, dest, sass_imm32(insn));
+        return true;
+
+    case SASS_OP_MOV_REG:
+    case SASS_OP_MOV_CBUF:
+    case SASS_OP_MOV_IMM:
+        write_reg(lane, dest, operand_b(m, lane, insn));
+        return true;
+
+    case SASS_OP_S2R:
+    {
+        uint32_t value;
+        switch (sass_bits(insn, 20, 8))
+        {
+        case 0x00: value = lane_id; break;
+        case 0x21: value = lane->tid[0]; break;
+        case 0x22: value = lane->tid[1]; break;
+        case 0x23: value = lane->tid[2]; break;
+        case 0x25: value = m->ctaid[0]; break;
+        case 0x26: value = m->ctaid[1]; break;
+        case 0x27: value = m->ctaid[2]; break;
+        default:
+            return fault(m, "unsupported system register 0x%x",
+                (unsigned)sass_bits(insn, 20, 8));
+        }
+        write_reg(lane, dest, value);
+        return true;
+    }
+
+    case SASS_OP_IADD_REG:
+    case SASS_OP_IADD_CBUF:
+    case SASS_OP_IADD_IMM:
+        return execute_iadd(lane, insn, read_reg(lane, sass_src_a(insn)),
+            operand_b(m, lane, insn), sass_bits(insn, 49, 1),
+            sass_bits(insn, 48, 1), sass_bits(insn, 43, 1),
+            sass_bits(insn, 50, 1), cc);
+
+    case SASS_OP_IADD32I:
+        return execute_iadd(lane, insn, read_reg(lane, sass_src_a(insn)),
+            sass_imm32(insn), sass_bits(insn, 56, 1), false,
+            sass_bits(insn, 53, 1), sass_bits(insn, 54, 1),
+            sass_bits(insn, 52, 1));
+
+    case SASS_OP_ISCADD_REG:
+    case SASS_OP_ISCADD_CBUF:
+    case SASS_OP_ISCADD_IMM:
+    {
+        uint32_t const a = read_reg(lane, sass_src_a(insn))
+            << sass_bits(insn, 39, 5);
+        return execute_iadd(lane, insn, a, operand_b(m, lane, insn),
+            sass_bits(insn, 49, 1), sass_bits(insn, 48, 1), false, false, cc);
+    }
+
+    case SASS_OP_LEA_LO_REG:
+    {
+        uint32_t a = read_reg(lane, sass_src_a(insn));
+        if (sass_bits(insn, 45, 1))
+            a = -a;
+        uint32_t const result = (a << sass_bits(insn, 39, 5))
+            + read_reg(lane, sass_src_b(insn));
+        write_reg(lane, dest, result);
+        return true;
+    }
+
+    case SASS_OP_LEA_HI_REG:
+    {
+        uint64_t value = ((uint64_t)read_reg(lane, sass_src_c(insn)) << 32)
+            | read_reg(lane, sass_src_a(insn));
+        if (sass_bits(insn, 37, 1))
+            value = -value;
+        uint32_t const shift = 32 - (uint32_t)sass_bits(insn, 28, 5);
+        uint32_t const result = (uint32_t)(value >> shift)
+            + read_reg(lane, sass_src_b(insn));
+        write_reg(lane, dest, result);
+        return true;
+    }
+
+    case SASS_OP_XMAD_REG:
+        return execute_xmad(m, lane, insn);
+
+    case SASS_OP_SHR_REG:
+    case SASS_OP_SHR_CBUF:
+    case SASS_OP_SHR_IMM:
+    {
+        uint32_t value = read_reg(lane, sass_src_a(insn));
+        uint32_t shift = operand_b(m, lane, insn);
+        bool const is_signed = sass_bits(insn, 48, 1);
+        if (sass_bits(insn, 40, 1))
+            value = bit_reverse(value);
+        if (sass_bits(insn, 39, 1))
+            shift &= 31;
+        uint32_t result;
+        if (is_signed)
+            result = (uint32_t)((int32_t)value >> (shift > 31 ? 31 : shift));
+        else
+            result = shift > 31 ? 0 : value >> shift;
+        write_reg(lane, dest, result);
+        if (cc)
+            set_zs(lane, result);
+        return true;
+    }
+
+    case SASS_OP_SHL_REG:
+    case SASS_OP_SHL_IMM:
+    {
+        uint32_t shift = operand_b(m, lane, insn);
+        if (sass_bits(insn, 39, 1))
+            shift &= 31;
+        uint32_t const result =
+            shift > 31 ? 0 : read_reg(lane, sass_src_a(insn)) << shift;
+        write_reg(lane, dest, result);
+        if (cc)
+            set_zs(lane, result);
+        return true;
+    }
+
+    case SASS_OP_SHF_L_REG:
+    case SASS_OP_SHF_R_REG:
+        return execute_shf(lane, insn, read_reg(lane, sass_src_b(insn)),
+            op == SASS_OP_SHF_L_REG);
+
+    case SASS_OP_SHF_L_IMM:
+    case SASS_OP_SHF_R_IMM:
+        return execute_shf(lane, insn, (uint32_t)sass_bits(insn, 20, 6),
+            op == SASS_OP_SHF_L_IMM);
+
+    case SASS_OP_BFE_REG:
+    case SASS_OP_BFE_CBUF:
+    case SASS_OP_BFE_IMM:
+    {
+        uint32_t value = read_reg(lane, sass_src_a(insn));
+        uint32_t const control = operand_b(m, lane, insn);
+        uint32_t const position = control & 0xff;
+        uint32_t const length = (control >> 8) & 0xff;
+        bool const is_signed = sass_bits(insn, 48, 1);
+        if (sass_bits(insn, 40, 1))
+            value = bit_reverse(value);
+
+        uint32_t const msb = position + length - 1 > 31 ? 31
+                                                        : position + length - 1;
+        bool const sign_bit = is_signed && length != 0
+            && (value >> (position > 31 ? 31 : msb)) & 1;
+        uint32_t result = 0;
+        for (uint32_t i = 0; i < 32; ++i)
+        {
+            bool bit = sign_bit;
+            if (i < length && position + i <= 31)
+                bit = (value >> (position + i)) & 1;
+            result |= (uint32_t)bit << i;
+        }
+        write_reg(lane, dest, result);
+        if (cc)
+            set_cc(lane, result, false, false);
+        return true;
+    }
+
+    case SASS_OP_FLO_REG:
+    case SASS_OP_FLO_CBUF:
+    case SASS_OP_FLO_IMM:
+    {
+        uint32_t value = operand_b(m, lane, insn);
+        if (sass_bits(insn, 40, 1))
+            value = ~value;
+        if (sass_bits(insn, 48, 1) && (int32_t)value < 0)
+            value = ~value;
+        int const msb = find_msb(value);
+        uint32_t result = (uint32_t)msb;
+        if (sass_bits(insn, 41, 1) && msb >= 0)
+            result = 31 - (uint32_t)msb;
+        write_reg(lane, dest, result);
+        if (cc)
+            set_cc(lane, result, false, false);
+        return true;
+    }
+
+    case SASS_OP_POPC_REG:
+    case SASS_OP_POPC_CBUF:
+    case SASS_OP_POPC_IMM:
+    {
+        uint32_t value = operand_b(m, lane, insn);
+        if (sass_bits(insn, 40, 1))
+            value = ~value;
+        write_reg(lane, dest, (uint32_t)__builtin_popcount(value));
+        return true;
+    }
+
+    case SASS_OP_I2I_REG:
+    case SASS_OP_I2I_CBUF:
+    case SASS_OP_I2I_IMM:
+        return execute_i2i(lane, insn, operand_b(m, lane, insn));
+
+    case SASS_OP_I2F_REG:
+    case SASS_OP_I2F_CBUF:
+    case SASS_OP_I2F_IMM:
+        return execute_i2f(m, lane, insn, operand_b(m, lane, insn));
+
+    case SASS_OP_F2I_REG:
+    case SASS_OP_F2I_CBUF:
+    case SASS_OP_F2I_IMM:
+        return execute_f2i(m, lane, insn, operand_fb(m, lane, insn));
+
+    case SASS_OP_F2F_REG:
+    case SASS_OP_F2F_CBUF:
+    case SASS_OP_F2F_IMM:
+        return execute_f2f(m, lane, insn, operand_fb(m, lane, insn));
+
+    case SASS_OP_FADD_REG:
+    case SASS_OP_FADD_CBUF:
+    case SASS_OP_FADD_IMM:
+    {
+        bool const ftz = sass_bits(insn, 44, 1);
+        float a = as_float(read_reg(lane, sass_src_a(insn)));
+        float b = as_float(operand_fb(m, lane, insn));
+        if (ftz)
+        {
+            a = flush_denorm(a);
+            b = flush_denorm(b);
+        }
+        if (sass_bits(insn, 46, 1))
+            a = fabsf(a);
+        if (sass_bits(insn, 48, 1))
+            a = -a;
+        if (sass_bits(insn, 49, 1))
+            b = fabsf(b);
+        if (sass_bits(insn, 45, 1))
+            b = -b;
+        float result = round_to_float((double)a + b,
+            (int)sass_bits(insn, 39, 2));
+        if (sass_bits(insn, 50, 1))
+            result = isnan(result) ? 0.0f : fminf(fmaxf(result, 0.0f), 1.0f);
+        if (ftz)
+            result = flush_denorm(result);
+        uint32_t const bits = isnan(result) ? 0x7fffffff : as_uint(result);
+        write_reg(lane, dest, bits);
+        if (cc)
+            set_zs(lane, bits);
+        return true;
+    }
+
+    case SASS_OP_FSETP_REG:
+    case SASS_OP_FSETP_CBUF:
+    case SASS_OP_FSETP_IMM:
+    {
+        float a = as_float(read_reg(lane, sass_src_a(insn)));
+        float b = as_float(operand_fb(m, lane, insn));
+        if (sass_bits(insn, 47, 1))
+        {
+            a = flush_denorm(a);
+            b = flush_denorm(b);
+        }
+        if (sass_bits(insn, 7, 1))
+            a = fabsf(a);
+        if (sass_bits(insn, 43, 1))
+            a = -a;
+        if (sass_bits(insn, 44, 1))
+            b = fabsf(b);
+        if (sass_bits(insn, 6, 1))
+            b = -b;
+        bool const compare = compare_float((int)sass_bits(insn, 48, 4), a, b);
+        bool const pred = read_pred(lane, (int)sass_bits(insn, 39, 3))
+            != (bool)sass_bits(insn, 42, 1);
+        int const bop = (int)sass_bits(insn, 45, 2);
+        write_pred(lane, (int)sass_bits(insn, 3, 3),
+            combine_pred(bop, compare, pred));
+        write_pred(lane, (int)sass_bits(insn, 0, 3),
+            combine_pred(bop, !compare, pred));
+        return true;
+    }
+
+    case SASS_OP_FCMP_REG:
+    {
+        bool const ftz = sass_bits(insn, 47, 1);
+        float c = as_float(read_reg(lane, sass_src_c(insn)));
+        if (ftz)
+            c = flush_denorm(c);
+        bool const compare =
+            compare_float((int)sass_bits(insn, 48, 4), c, 0.0f);
+        write_reg(lane, dest, compare ? read_reg(lane, sass_src_a(insn))
+                                      : read_reg(lane, sass_src_b(insn)));
+        return true;
+    }
+
+    case SASS_OP_HADD2_REG:
+    case SASS_OP_HMUL2_REG:
+    case SASS_OP_HFMA2_REG:
+        return execute_half_arith(lane, insn, op);
+
+    case SASS_OP_HSET2_REG:
+    {
+        bool results[2];
+        compare_halves(lane, insn, results);
+        uint32_t const true_value = sass_bits(insn, 49, 1) ? 0x3c00 : 0xffff;
+        write_reg(lane, dest, (results[0] ? true_value : 0)
+            | (results[1] ? true_value << 16 : 0));
+        return true;
+    }
+
+    case SASS_OP_HSETP2_REG:
+    {
+        bool results[2];
+        compare_halves(lane, insn, results);
+        if (sass_bits(insn, 49, 1))
+        {
+            results[0] = results[0] && results[1];
+            results[1] = !results[0];
+        }
+        write_pred(lane, (int)sass_bits(insn, 3, 3), results[0]);
+        write_pred(lane, (int)sass_bits(insn, 0, 3), results[1]);
+        return true;
+    }
+
+    case SASS_OP_VMNMX:
+        return execute_vmnmx(m, lane, insn);
+
+    case SASS_OP_PSETP:
+    {
+        bool const a = read_pred(lane, (int)sass_bits(insn, 12, 3))
+            != (bool)sass_bits(insn, 15, 1);
+        bool const b = read_pred(lane, (int)sass_bits(insn, 29, 3))
+            != (bool)sass_bits(insn, 32, 1);
+        bool const c = read_pred(lane, (int)sass_bits(insn, 39, 3))
+            != (bool)sass_bits(insn, 42, 1);
+        bool const ab = combine_pred((int)sass_bits(insn, 24, 2), a, b);
+        int const bop = (int)sass_bits(insn, 45, 2);
+        write_pred(lane, (int)sass_bits(insn, 3, 3), combine_pred(bop, ab, c));
+        write_pred(lane, (int)sass_bits(insn, 0, 3),
+            combine_pred(bop, !ab, c));
+        return true;
+    }
+
+    case SASS_OP_P2R_REG:
+    case SASS_OP_P2R_IMM:
+    {
+        uint32_t const mask = operand_b(m, lane, insn) & 0xff;
+        int const shift = (int)sass_bits(insn, 41, 2) * 8;
+        uint32_t value = 0;
+        if (sass_bits(insn, 40, 1))
+        {
+            value = lane->zero | lane->sign << 1 | lane->carry << 2
+                | lane->overflow << 3;
+        }
+        else
+        {
+            for (int i = 0; i < 7; ++i)
+                value |= (uint32_t)lane->preds[i] << i;
+        }
+        uint32_t const src = read_reg(lane, sass_src_a(insn));
+        write_reg(lane, dest,
+            (src & ~(mask << shift)) | ((value & mask) << shift));
+        return true;
+    }
+
+    case SASS_OP_R2P_REG:
+    case SASS_OP_R2P_IMM:
+    {
+        uint32_t const mask = operand_b(m, lane, insn) & 0xff;
+        uint32_t const value = read_reg(lane, sass_src_a(insn))
+            >> (sass_bits(insn, 41, 2) * 8);
+        if (sass_bits(insn, 40, 1))
+        {
+            if (mask & 1)
+                lane->zero = value & 1;
+            if (mask & 2)
+                lane->sign = value >> 1 & 1;
+            if (mask & 4)
+                lane->carry = value >> 2 & 1;
+            if (mask & 8)
+                lane->overflow = value >> 3 & 1;
+        }
+        else
+        {
+            for (int i = 0; i < 7; ++i)
+            {
+                if (mask >> i & 1)
+                    lane->preds[i] = value >> i & 1;
+            }
+        }
+        return true;
+    }
+
+    case SASS_OP_LDG:
+    case SASS_OP_STG:
+    {
+        int const size = (int)sass_bits(insn, 48, 3);
+        uint64_t const addr = global_address(lane, sass_src_a(insn),
+            sass_bits(insn, 45, 1), sass_sbits(insn, 20, 24));
+        if (!check_alignment(m, addr, size))
+            return false;
+        uint8_t* const ptr = storage_ptr(m, addr, access_size(size));
+        if (op == SASS_OP_LDG)
+            return load(m, lane, ptr, size, dest);
+        return store(lane, ptr, size, dest);
+    }
+
+    case SASS_OP_LDL:
+    case SASS_OP_STL:
+    case SASS_OP_LDS:
+    case SASS_OP_STS:
+    {
+        bool const shared = op == SASS_OP_LDS || op == SASS_OP_STS;
+        int const size = (int)sass_bits(insn, 48, 3);
+        uint32_t const addr = read_reg(lane, sass_src_a(insn))
+            + (uint32_t)sass_sbits(insn, 20, 24);
+        if (!check_alignment(m, addr, size))
+            return false;
+        uint8_t* const ptr = shared
+            ? memory_ptr(m, m->shared, m->launch->shared_mem_size, addr,
+                  access_size(size), "shared")
+            : memory_ptr(m, lane->local, m->launch->local_mem_size, addr,
+                  access_size(size), "local");
+        if (op == SASS_OP_LDL || op == SASS_OP_LDS)
+            return load(m, lane, ptr, size, dest);
+        return store(lane, ptr, size, dest);
+    }
+
+    case SASS_OP_ATOMS:
+    {
+        uint32_t const addr = read_reg(lane, sass_src_a(insn))
+            + (uint32_t)(sass_sbits(insn, 30, 22) * 4);
+        uint32_t old;
+        if (!check_alignment(m, addr, 4))
+            return false;
+        uint8_t* const ptr = memory_ptr(m, m->shared,
+            m->launch->shared_mem_size, addr, 4, "shared");
+        if (!atomic(m, ptr, (int)sass_bits(insn, 52, 4),
+                (int)sass_bits(insn, 28, 2), read_reg(lane, sass_src_b(insn)),
+                &old))
+            return false;
+        write_reg(lane, dest, old);
+        return true;
+    }
+
+    case SASS_OP_ATOM:
+    case SASS_OP_RED:
+    {
+        bool const is_red = op == SASS_OP_RED;
+        uint64_t const addr = global_address(lane, sass_src_a(insn),
+            sass_bits(insn, 48, 1), sass_sbits(insn, 28, 20));
+        int const atom_op = is_red ? (int)sass_bits(insn, 23, 3)
+                                   : (int)sass_bits(insn, 52, 4);
+        int const size = is_red ? (int)sass_bits(insn, 20, 3)
+                                : (int)sass_bits(insn, 49, 3);
+        uint32_t const value = read_reg(lane,
+            is_red ? sass_dest(insn) : sass_src_b(insn));
+        uint32_t old;
+        if (!check_alignment(m, addr, 4))
+            return false;
+        if (!atomic(m, storage_ptr(m, addr, 4), atom_op, size, value, &old))
+            return false;
+        if (!is_red)
+            write_reg(lane, dest, old);
+        return true;
+    }
+
+    default:
+        return fault(m, "unsupported instruction %s (0x%016llx)",
+            sass_opcode_name(op), (unsigned long long)insn);
+    }
+}
+
+// SHFL reads the source register of other lanes, all lanes are sampled
+// before any of them is written.
+static bool execute_shfl(struct warp* warp, uint64_t insn, uint32_t mask)
+{
+    uint32_t values[SASS_WARP_SIZE];
+    for (uint32_t i = 0; i < SASS_WARP_SIZE; ++i)
+    {
+        bool const readable = (warp->present & ~warp->exited) >> i & 1;
+        values[i] = readable ? read_reg(&warp->lanes[i], sass_src_a(insn)) : 0;
+    }
+
+    for (uint32_t i = 0; i < SASS_WARP_SIZE; ++i)
+    {
+        if (!(mask >> i & 1))
+            continue;
+        struct lane* lane = &warp->lanes[i];
+        uint32_t const b = sass_bits(insn, 28, 1)
+            ? (uint32_t)sass_bits(insn, 20, 5)
+            : read_reg(lane, sass_src_b(insn));
+        uint32_t const c = sass_bits(insn, 29, 1)
+            ? (uint32_t)sass_bits(insn, 34, 13)
+            : read_reg(lane, sass_src_c(insn));
+
+        int const bval = (int)(b & 0x1f);
+        int const clamp = (int)(c & 0x1f);
+        int const segmask = (int)((c >> 8) & 0x1f);
+        int const lane_id = (int)i;
+        int const max_lane = (lane_id & segmask) | (clamp & ~segmask);
+        int const min_lane = lane_id & segmask;
+
+        int j;
+        bool in_range;
+        switch (sass_bits(insn, 30, 2))
+        {
+        case 0:
+            j = min_lane | (bval & ~segmask);
+            in_range = j <= max_lane;
+            break;
+        case 1:
+            j = lane_id - bval;
+            in_range = j >= max_lane;
+            break;
+        case 2:
+            j = lane_id + bval;
+            in_range = j <= max_lane;
+            break;
+        default:
+            j = lane_id ^ bval;
+            in_range = j <= max_lane;
+            break;
+        }
+        if (!in_range)
+            j = lane_id;
+
+        write_reg(lane, sass_dest(insn), values[j]);
+        write_pred(lane, (int)sass_bits(insn, 48, 3), in_range);
+    }
+    return true;
+}
+
+static bool push(struct machine* m, struct warp* warp, enum stack_kind kind,
+    uint32_t mask, size_t target)
+{
+    if (warp->depth == STACK_DEPTH)
+        return fault(m, "reconvergence stack overflow");
+    warp->stack[warp->depth++] = (struct stack_entry){kind, mask, target};
+    return true;
+}
+
+// Resumes the lanes waiting on the innermost token of the given kind once
+// every active lane reached it. Divergent paths still pending run first.
+static void unwind(struct warp* warp, enum stack_kind kind)
+{
+    while (warp->active == 0 && warp->depth > 0)
+    {
+        struct stack_entry const entry = warp->stack[--warp->depth];
+        if (entry.kind == STACK_DIV || kind == STACK_ANY || entry.kind == kind)
+        {
+            warp->active = entry.mask & ~warp->exited;
+            warp->pc = entry.target;
+        }
+    }
+}
+
+static bool branch_target(struct machine* m, uint64_t insn, size_t pc,
+    size_t* target)
+{
+    int64_t const offset = sass_branch_target(insn, pc);
+    if (offset < 0 || offset % 8 != 0 || (size_t)offset / 8 >= m->num_insns
+        || sass_is_sched((size_t)offset / 8))
+    {
+        return fault(m, "invalid branch target 0x%llx at 0x%zx",
+            (long long)offset, pc * 8);
+    }
+    *target = (size_t)offset / 8;
+    return true;
+}
+
+static bool step_warp(struct machine* m, struct warp* warp)
+{
+    size_t const pc = warp->pc;
+    if (pc >= m->num_insns)
+        return fault(m, "execution ran past the end of the program");
+    if (sass_is_sched(pc))
+    {
+        ++warp->pc;
+        return true;
+    }
+
+    uint64_t const insn = m->launch->code[pc];
+    enum sass_opcode const op = m->ops[pc];
+    int const guard = sass_guard(insn);
+    bool const guard_negated = sass_guard_negated(insn);
+    int const flow_test = (int)sass_bits(insn, 0, 5);
+
+    uint32_t mask = 0;
+    uint32_t flow_mask = 0;
+    for (uint32_t i = 0; i < SASS_WARP_SIZE; ++i)
+    {
+        struct lane const* lane = &warp->lanes[i];
+        if (!(warp->active >> i & 1))
+            continue;
+        if (read_pred(lane, guard) == guard_negated)
+            continue;
+        mask |= UINT32_C(1) << i;
+        if (test_flow(lane, flow_test))
+            flow_mask |= UINT32_C(1) << i;
+    }
+
+    warp->pc = pc + 1;
+
+    size_t target;
+    switch (op)
+    {
+    case SASS_OP_SSY:
+    case SASS_OP_PBK:
+        if (!branch_target(m, insn, pc, &target))
+            return false;
+        return push(m, warp, op == SASS_OP_SSY ? STACK_SSY : STACK_PBK,
+            warp->active, target);
+
+    case SASS_OP_CAL:
+        if (!branch_target(m, insn, pc, &target))
+            return false;
+        if (!push(m, warp, STACK_CAL, warp->active, pc + 1))
+            return false;
+        warp->pc = target;
+        return true;
+
+    case SASS_OP_BRA:
+        if (!branch_target(m, insn, pc, &target))
+            return false;
+        if (flow_mask == warp->active)
+        {
+            warp->pc = target;
+        }
+        else if (flow_mask != 0)
+        {
+            if (!push(m, warp, STACK_DIV, flow_mask, target))
+                return false;
+            warp->active &= ~flow_mask;
+        }
+        return true;
+
+    case SASS_OP_SYNC:
+        warp->active &= ~flow_mask;
+        unwind(warp, STACK_SSY);
+        return true;
+
+    case SASS_OP_BRK:
+        warp->active &= ~flow_mask;
+        unwind(warp, STACK_PBK);
+        return true;
+
+    case SASS_OP_RET:
+        warp->active &= ~flow_mask;
+        unwind(warp, STACK_CAL);
+        return true;
+
+    case SASS_OP_EXIT:
+        warp->exited |= flow_mask;
+        warp->active &= ~flow_mask;
+        unwind(warp, STACK_ANY);
+        return true;
+
+    case SASS_OP_SHFL:
+        return execute_shfl(warp, insn, mask);
+
+    default:
+        break;
+    }
+
+    for (uint32_t i = 0; i < SASS_WARP_SIZE; ++i)
+    {
+        if (!(mask >> i & 1))
+            continue;
+        if (!execute_lane(m, &warp->lanes[i], i, insn, op))
+            return false;
+    }
+    return true;
+}
+
+static bool run_block(struct machine* m, struct lane* lanes,
+    uint8_t* local_mem, uint32_t num_threads)
+{
+    struct sass_launch const* launch = m->launch;
+    memset(m->shared, 0, launch->shared_mem_size);
+
+    for (uint32_t first = 0; first < num_threads; first += SASS_WARP_SIZE)
+    {
+        struct warp warp = {.lanes = lanes};
+        for (uint32_t i = 0; i < SASS_WARP_SIZE; ++i)
+        {
+            struct lane* lane = &lanes[i];
+            uint32_t const thread = first + i;
+            memset(lane, 0, sizeof(*lane));
+            if (thread >= num_threads)
+                continue;
+            lane->tid[0] = thread % launch->block_dim[0];
+            lane->tid[1] = thread / launch->block_dim[0] % launch->block_dim[1];
+            lane->tid[2] =
+                thread / (launch->block_dim[0] * launch->block_dim[1]);
+            lane->local = local_mem + (size_t)i * launch->local_mem_size;
+            memset(lane->local, 0, launch->local_mem_size);
+            warp.present |= UINT32_C(1) << i;
+        }
+        warp.active = warp.present;
+        warp.pc = 1;
+
+        for (unsigned steps = 0; warp.active != 0; ++steps)
+        {
+            if (steps == MAX_STEPS)
+                return fault(m, "step limit exceeded at 0x%zx", warp.pc * 8);
+            if (!step_warp(m, &warp))
+                return false;
+        }
+    }
+    return true;
+}
+
+bool sass_execute(
+    struct sass_launch const* launch, char* error, size_t error_size)
+{
+    struct machine m = {
+        .launch = launch,
+        .num_insns = launch->code_size / 8,
+        .error = error,
+        .error_size = error_size,
+    };
+    uint32_t const num_threads =
+        launch->block_dim[0] * launch->block_dim[1] * launch->block_dim[2];
+
+    m.ops = malloc(m.num_insns * sizeof(*m.ops) + 1);
+    m.cbuf0 = calloc(1, CBUF_SIZE);
+    m.shared = malloc(launch->shared_mem_size + 1);
+    struct lane* lanes = malloc(SASS_WARP_SIZE * sizeof(*lanes));
+    uint8_t* local_mem = malloc(
+        (size_t)SASS_WARP_SIZE * launch->local_mem_size + 1);
+    if (!m.ops || !m.cbuf0 || !m.shared || !lanes || !local_mem)
+    {
+        fault(&m, "out of memory");
+        goto done;
+    }
+
+    for (size_t i = 0; i < m.num_insns; ++i)
+    {
+        m.ops[i] = sass_is_sched(i) ? SASS_OP_INVALID
+                                    : sass_decode(launch->code[i]);
+    }
+
+    for (int i = 0; i < SASS_MAX_STORAGE_BUFFERS; ++i)
+    {
+        uint64_t const addr = STORAGE_BASE_ADDR + i * STORAGE_ADDR_STRIDE;
+        uint32_t const descriptor[4] = {
+            (uint32_t)addr, (uint32_t)(addr >> 32), launch->storage[i].size, 0};
+        memcpy(m.cbuf0 + STORAGE_CBUF_OFFSET + i * sizeof(descriptor),
+            descriptor, sizeof(descriptor));
+    }
+
+    for (uint32_t z = 0; z < launch->grid_dim[2] && !m.faulted; ++z)
+    {
+        for (uint32_t y = 0; y < launch->grid_dim[1] && !m.faulted; ++y)
+        {
+            for (uint32_t x = 0; x < launch->grid_dim[0] && !m.faulted; ++x)
+            {
+                m.ctaid[0] = x;
+                m.ctaid[1] = y;
+                m.ctaid[2] = z;
+                run_block(&m, lanes, local_mem, num_threads);
+            }
+        }
+    }
+
+done:
+    free(local_mem);
+    free(lanes);
+    free(m.shared);
+    free(m.cbuf0);
+    free(m.ops);
+    return !m.faulted;
+}
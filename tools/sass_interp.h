@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SASS_WARP_SIZE 32
+#define SASS_MAX_STORAGE_BUFFERS 16
+
+struct sass_storage_buffer
+{
+    uint8_t* data;
+    uint32_t size;
+};
+
+// A single compute dispatch. Storage buffer i is described at
+// c[0x0][0x140 + i * 0x10] like the driver does, its contents live in host
+// memory.
+struct sass_launch
+{
+    uint64_t const* code;
+    size_t code_size;
+    uint32_t block_dim[3];
+    uint32_t grid_dim[3];
+    uint32_t local_mem_size;
+    uint32_t shared_mem_size;
+    struct sass_storage_buffer storage[SASS_MAX_STORAGE_BUFFERS];
+};
+
+// Runs the dispatch to completion. Returns false and describes the first
+// fault or unsupported instruction in error otherwise.
+bool sass_execute(
+    struct sass_launch const* launch, char* error, size_t error_size);
@@ -0,0 +1,295 @@
+// Host tool that runs the compute test table through the reference
+// interpreter, without a console.
+//
+// Usage: sass_run [-v] <shaders.pack> [programs...]
+//
+// When programs are given only the matching tests run, including every
+// variant of a template program. Tests with a custom executor depend on the
+// GPU and are skipped.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "compute_checks.h"
+#include "sass_analyze.h"
+#include "sass_interp.h"
+#include "shader_pack.h"
+
+#define RESULT_SLICE_SIZE 0x100
+
+struct host_test
+{
+    char const* name;
+    char const* sass_file;
+    uint32_t expected_value;
+    bool (*check_results)(uint32_t*);
+    bool needs_gpu;
+    uint32_t workgroup[3];
+    uint32_t num_invokes[3];
+    uint32_t local_mem_size;
+    uint32_t shared_mem_size;
+    void (*generate_inputs)(uint32_t*, uint32_t);
+    void (*reference)(uint32_t const*, uint32_t*);
+    uint32_t num_inputs;
+    uint32_t input_words;
+    uint32_t output_words;
+    struct test_variants const* variants;
+};
+
+#define TEST(name, expected, id)
+#define ETEST(name, expected, id)
+#define MTEST(name, id, ...) DECLARE_MTEST(id)
+#define DTEST(name, id, ...) DECLARE_DTEST(id)
+#define VTEST(id) DECLARE_VTEST(id)
+#include "compute_test_list.h"
+#undef VTEST
+#undef DTEST
+#undef MTEST
+#undef ETEST
+#undef TEST
+
+#define TEST(name, expected, id)                                               \
+    { name, #id, expected, NULL, false, {1, 1, 1}, {1, 1, 1},                  \
+      TEST_LOCAL_MEM_SIZE, TEST_SHARED_MEM_SIZE },
+
+#define ETEST(name, expected, id)                                              \
+    { name, #id, expected, NULL, true, {1, 1, 1}, {1, 1, 1}, 0, 0 },
+
+#define MTEST(name, id, workgroup_x, workgroup_y, workgroup_z,                 \
+    num_invokes_x, num_invokes_y, num_invokes_z, local_mem_size,               \
+    shared_mem_size)                                                           \
+    { name, #id, 0, test_##id, false,                                          \
+      {workgroup_x, workgroup_y, workgroup_z},                                 \
+      {num_invokes_x, num_invokes_y, num_invokes_z}, local_mem_size,           \
+      shared_mem_size },
+
+#define DTEST(name, id, inputs, in_words, out_words)                           \
+    { name, #id, 0, NULL, false, {DATA_TEST_WORKGROUP_SIZE, 1, 1},             \
+      {(inputs) / DATA_TEST_WORKGROUP_SIZE, 1, 1}, TEST_LOCAL_MEM_SIZE,        \
+      TEST_SHARED_MEM_SIZE, inputs_##id, reference_##id, inputs, in_words,     \
+      out_words },
+
+#define VTEST(id)                                                              \
+    { NULL, #id, 0, NULL, false, {1, 1, 1}, {1, 1, 1}, TEST_LOCAL_MEM_SIZE,    \
+      TEST_SHARED_MEM_SIZE, .variants = &variants_##id },
+
+static struct host_test const tests[] =
+{
+#include "compute_test_list.h"
+};
+
+#undef VTEST
+#undef DTEST
+#undef MTEST
+#undef ETEST
+#undef TEST
+
+#define NUM_TESTS (sizeof(tests) / sizeof(tests[0]))
+
+static bool is_selected(char const* sass_file, int argc, char** argv)
+{
+    if (argc == 0)
+        return true;
+    for (int i = 0; i < argc; ++i)
+    {
+        if (strcmp(sass_file, argv[i]) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool check_data_test(struct host_test const* test,
+    uint32_t const* inputs, uint32_t const* outputs, char* message,
+    size_t message_size)
+{
+    for (uint32_t i = 0; i < test->num_inputs; ++i)
+    {
+        uint32_t expected[DATA_TEST_MAX_WORDS];
+        test->reference(inputs + i * test->input_words, expected);
+
+        uint32_t const* const output = outputs + i * test->output_words;
+        for (uint32_t j = 0; j < test->output_words; ++j)
+        {
+            if (output[j] != expected[j])
+            {
+                snprintf(message, message_size,
+                    "input %u exp %08x got %08x", i, expected[j], output[j]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool run_test(struct host_test const* test,
+    struct test_variant const* variant, struct shader_pack const* pack,
+    char* message, size_t message_size)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "%s.sass.bin", test->sass_file);
+    size_t code_size;
+    uint8_t const* const packed_code =
+        shader_pack_find(pack, name, &code_size);
+    if (!packed_code)
+    {
+        snprintf(message, message_size, "program \"%s\" not found", name);
+        return false;
+    }
+
+    uint8_t* const code = malloc(code_size);
+    if (!code)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(code, packed_code, code_size);
+    if (variant && !sass_apply_patches(
+        code, code_size, variant->patches, TEST_VARIANT_MAX_PATCHES))
+    {
+        snprintf(message, message_size, "patches do not fit \"%s\"", name);
+        free(code);
+        return false;
+    }
+
+    // Memory is sized the way the device header is, from the program
+    struct sass_resources resources;
+    if (!sass_analyze(code, code_size, test->local_mem_size,
+        test->shared_mem_size, &resources))
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    uint32_t results[RESULT_SLICE_SIZE / sizeof(uint32_t)] = {0};
+    uint32_t* inputs = NULL;
+    uint32_t* outputs = NULL;
+    struct sass_launch launch = {
+        .code = (uint64_t const*)code,
+        .code_size = code_size,
+        .local_mem_size = resources.local_mem_size,
+        .shared_mem_size = resources.shared_mem_size,
+    };
+    for (int i = 0; i < 3; ++i)
+    {
+        launch.block_dim[i] = test->workgroup[i];
+        launch.grid_dim[i] = test->num_invokes[i];
+    }
+    launch.storage[0].data = (uint8_t*)results;
+    launch.storage[0].size = sizeof(results);
+
+    if (test->num_inputs)
+    {
+        size_t const input_size =
+            (size_t)test->num_inputs * test->input_words * sizeof(uint32_t);
+        size_t const output_size =
+            (size_t)test->num_inputs * test->output_words * sizeof(uint32_t);
+        inputs = malloc(input_size);
+        outputs = calloc(1, output_size);
+        if (!inputs || !outputs)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        test->generate_inputs(inputs, test->num_inputs);
+        launch.storage[0].data = (uint8_t*)outputs;
+        launch.storage[0].size = (uint32_t)output_size;
+        launch.storage[1].data = (uint8_t*)inputs;
+        launch.storage[1].size = (uint32_t)input_size;
+    }
+
+    bool pass = sass_execute(&launch, message, message_size);
+    if (pass && test->num_inputs)
+        pass = check_data_test(test, inputs, outputs, message, message_size);
+    free(inputs);
+    free(outputs);
+    free(code);
+    if (!pass || test->num_inputs)
+        return pass;
+
+    if (test->check_results)
+    {
+        if (!test->check_results(results))
+        {
+            snprintf(message, message_size, "check failed");
+            return false;
+        }
+        return true;
+    }
+    uint32_t const expected_value =
+        variant ? variant->expected_value : test->expected_value;
+    if (results[0] != expected_value)
+    {
+        snprintf(message, message_size, "exp %08x got %08x", expected_value,
+            results[0]);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool verbose = false;
+    int first_arg = 1;
+    if (argc > 1 && strcmp(argv[1], "-v") == 0)
+    {
+        verbose = true;
+        first_arg = 2;
+    }
+    if (first_arg >= argc)
+    {
+        fprintf(stderr, "usage: %s [-v] <shaders.pack> [programs...]\n",
+            argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct shader_pack pack;
+    if (!shader_pack_load(&pack, argv[first_arg]))
+        return EXIT_FAILURE;
+
+    int const num_filters = argc - first_arg - 1;
+    char** const filters = argv + first_arg + 1;
+
+    size_t ran = 0, skipped = 0, failures = 0;
+    for (size_t i = 0; i < NUM_TESTS; ++i)
+    {
+        struct host_test const* test = &tests[i];
+        if (!is_selected(test->sass_file, num_filters, filters))
+            continue;
+        if (test->needs_gpu)
+        {
+            ++skipped;
+            if (verbose)
+                printf("%-40s Skipped\n", test->name);
+            continue;
+        }
+
+        size_t const num_variants = test->variants ? test->variants->count : 1;
+        for (size_t j = 0; j < num_variants; ++j)
+        {
+            struct test_variant const* variant =
+                test->variants ? &test->variants->variants[j] : NULL;
+            char const* const name = variant ? variant->name : test->name;
+
+            char message[256] = "";
+            bool const pass =
+                run_test(test, variant, &pack, message, sizeof(message));
+            ++ran;
+            if (!pass)
+                ++failures;
+            if (!pass || verbose)
+            {
+                printf("%-40s %s%s%s\n", name, pass ? "Passed" : "Failed",
+                    *message ? ": " : "", message);
+            }
+        }
+    }
+
+    printf("%zu tests run, %zu failed, %zu skipped\n", ran, failures,
+        skipped);
+
+    shader_pack_free(&pack);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
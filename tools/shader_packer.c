@@ -0,0 +1,168 @@
+// Host tool that bundles compiled shaders into a single shader pack.
+//
+// Usage: shader_packer -o <output> <files...>
+//
+// Entries are named after the basename of each input file.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "name_table.h"
+#include "shader_pack.h"
+
+struct input
+{
+    char const* name;
+    uint64_t name_hash;
+    uint8_t* data;
+    uint32_t size;
+};
+
+static size_t align_up(size_t n, size_t alignment)
+{
+    return (n + alignment - 1) & ~(alignment - 1);
+}
+
+static char const* basename_of(char const* path)
+{
+    char const* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+static uint8_t* read_file(char const* path, uint32_t* size)
+{
+    FILE* const file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "Failed to open \"%s\"\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fseek(file, 0, SEEK_END);
+    *size = (uint32_t)ftell(file);
+    rewind(file);
+
+    uint8_t* const data = malloc(*size ? *size : 1);
+    if (!data || fread(data, 1, *size, file) != *size)
+    {
+        fprintf(stderr, "Failed to read \"%s\"\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    return data;
+}
+
+static int compare_inputs(void const* lhs_ptr, void const* rhs_ptr)
+{
+    struct input const* lhs = lhs_ptr;
+    struct input const* rhs = rhs_ptr;
+    if (lhs->name_hash != rhs->name_hash)
+        return lhs->name_hash < rhs->name_hash ? -1 : 1;
+    return strcmp(lhs->name, rhs->name);
+}
+
+int main(int argc, char** argv)
+{
+    char const* output = NULL;
+    int first_input = 1;
+    if (argc > 2 && strcmp(argv[1], "-o") == 0)
+    {
+        output = argv[2];
+        first_input = 3;
+    }
+    if (!output || first_input >= argc)
+    {
+        fprintf(stderr, "usage: %s -o <output> <files...>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t const num_inputs = (size_t)(argc - first_input);
+    struct input* inputs = calloc(num_inputs, sizeof(*inputs));
+    if (!inputs)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t names_size = 0;
+    for (size_t i = 0; i < num_inputs; ++i)
+    {
+        char const* path = argv[first_input + i];
+        inputs[i].name = basename_of(path);
+        inputs[i].name_hash = name_hash(inputs[i].name);
+        inputs[i].data = read_file(path, &inputs[i].size);
+        names_size += strlen(inputs[i].name) + 1;
+    }
+    qsort(inputs, num_inputs, sizeof(*inputs), compare_inputs);
+
+    for (size_t i = 1; i < num_inputs; ++i)
+    {
+        if (strcmp(inputs[i - 1].name, inputs[i].name) == 0)
+        {
+            fprintf(stderr, "Duplicated entry \"%s\"\n", inputs[i].name);
+            return EXIT_FAILURE;
+        }
+    }
+
+    struct shader_pack_header header;
+    header.magic = SHADER_PACK_MAGIC;
+    header.version = SHADER_PACK_VERSION;
+    header.num_entries = (uint32_t)num_inputs;
+    header.names_offset = (uint32_t)(sizeof(header)
+        + num_inputs * sizeof(struct shader_pack_entry));
+    header.names_size = (uint32_t)names_size;
+
+    struct shader_pack_entry* entries = calloc(num_inputs, sizeof(*entries));
+    if (!entries)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t name_offset = 0;
+    size_t offset = header.names_offset + names_size;
+    for (size_t i = 0; i < num_inputs; ++i)
+    {
+        offset = align_up(offset, SHADER_PACK_ALIGNMENT);
+        entries[i].name_hash = inputs[i].name_hash;
+        entries[i].name_offset = (uint32_t)name_offset;
+        entries[i].offset = (uint32_t)offset;
+        entries[i].size = inputs[i].size;
+        entries[i].alignment = SHADER_PACK_ALIGNMENT;
+        name_offset += strlen(inputs[i].name) + 1;
+        offset += inputs[i].size;
+    }
+    header.total_size = (uint32_t)align_up(offset, SHADER_PACK_ALIGNMENT);
+
+    uint8_t* const pack = calloc(1, header.total_size);
+    if (!pack)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    memcpy(pack, &header, sizeof(header));
+    memcpy(pack + sizeof(header), entries, num_inputs * sizeof(*entries));
+    for (size_t i = 0; i < num_inputs; ++i)
+    {
+        size_t const length = strlen(inputs[i].name) + 1;
+        memcpy(pack + header.names_offset + entries[i].name_offset,
+            inputs[i].name, length);
+        memcpy(pack + entries[i].offset, inputs[i].data, inputs[i].size);
+        free(inputs[i].data);
+    }
+
+    FILE* const file = fopen(output, "wb");
+    if (!file || fwrite(pack, 1, header.total_size, file) != header.total_size)
+    {
+        fprintf(stderr, "Failed to write \"%s\"\n", output);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+
+    free(pack);
+    free(entries);
+    free(inputs);
+    return EXIT_SUCCESS;
+}
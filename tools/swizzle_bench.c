@@ -0,0 +1,231 @@
+// Checks the block linear conversions against a byte by byte reference, then
+// measures their throughput.
+//
+// Usage: swizzle_bench [iterations]
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "swizzle.h"
+
+struct image
+{
+    char const* name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t bytes_per_element;
+    uint32_t element_size; // width and height of an element in pixels
+};
+
+static struct image const images[] = {
+    {"64x64 RGBA8", 64, 64, 1, 4, 1},
+    {"32x32 Z24S8", 32, 32, 1, 4, 1},
+    {"37x19 RGB10A2", 37, 19, 1, 4, 1},
+    {"64x64 RGBA32F", 64, 64, 1, 16, 1},
+    {"61x45 BC1", 61, 45, 1, 8, 4},
+    {"16x16x5 R8", 16, 16, 5, 1, 1},
+    {"1920x1080 RGBA8", 1920, 1080, 1, 4, 1},
+};
+
+#define NUM_IMAGES (sizeof(images) / sizeof(images[0]))
+
+static uint64_t now_ns(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+static void* checked_calloc(size_t size)
+{
+    void* const data = calloc(1, size);
+    if (!data)
+    {
+        fprintf(stderr, "Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return data;
+}
+
+// Offsets within the first GOB, as the hardware lays it out
+static struct
+{
+    uint32_t x;
+    uint32_t y;
+    size_t offset;
+} const gob_offsets[] = {
+    {0, 0, 0}, {15, 0, 15}, {16, 0, 32}, {32, 0, 256}, {48, 0, 288},
+    {0, 1, 16}, {0, 2, 64}, {16, 3, 112}, {63, 7, 511},
+};
+
+static bool check_gob_offsets(void)
+{
+    struct swizzle_layout layout;
+    swizzle_layout_init(&layout, 64, 8, 1, 1, 1, 1);
+    for (size_t i = 0; i < sizeof(gob_offsets) / sizeof(gob_offsets[0]); ++i)
+    {
+        size_t const offset =
+            swizzle_offset(&layout, gob_offsets[i].x, gob_offsets[i].y, 0);
+        if (offset != gob_offsets[i].offset)
+        {
+            fprintf(stderr, "Byte %u of row %u is at %zu, not %zu\n",
+                gob_offsets[i].x, gob_offsets[i].y, offset,
+                gob_offsets[i].offset);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Compressed formats as grids of their blocks, partial blocks at the edges
+// rounded up: element counts, tiled size and where the last element starts
+static struct
+{
+    char const* name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytes_per_element;
+    uint32_t element_width;
+    uint32_t element_height;
+    uint32_t elements_x;
+    uint32_t elements_y;
+    size_t size;
+    size_t last_offset;
+} const element_layouts[] = {
+    {"61x45 BC1", 61, 45, 8, 4, 4, 16, 12, 2048, 1912},
+    {"32x32 BC7", 32, 32, 16, 4, 4, 8, 8, 1024, 1008},
+    {"100x50 ASTC 10x8", 100, 50, 16, 10, 8, 10, 7, 1536, 1248},
+};
+
+static bool check_element_layouts(void)
+{
+    bool ok = true;
+    for (size_t i = 0;
+         i < sizeof(element_layouts) / sizeof(element_layouts[0]); ++i)
+    {
+        struct swizzle_layout layout;
+        swizzle_layout_init(&layout, element_layouts[i].width,
+            element_layouts[i].height, 1, element_layouts[i].bytes_per_element,
+            element_layouts[i].element_width,
+            element_layouts[i].element_height);
+        size_t const last_offset = swizzle_offset(&layout,
+            (layout.width - 1) * layout.bytes_per_element, layout.height - 1,
+            0);
+        if (layout.width != element_layouts[i].elements_x
+            || layout.height != element_layouts[i].elements_y
+            || swizzle_size(&layout) != element_layouts[i].size
+            || last_offset != element_layouts[i].last_offset)
+        {
+            fprintf(stderr, "%s: %ux%u elements in %zu bytes, the last at "
+                "%zu\n", element_layouts[i].name, layout.width,
+                layout.height, swizzle_size(&layout), last_offset);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Both directions against swizzle_offset, and the padding left alone
+static bool check(struct swizzle_layout const* layout, char const* name)
+{
+    size_t const pitch = layout->width * layout->bytes_per_element;
+    size_t const linear_size = pitch * layout->height * layout->depth;
+    size_t const tiled_size = swizzle_size(layout);
+    uint8_t* const linear = checked_calloc(linear_size);
+    uint8_t* const tiled = checked_calloc(tiled_size);
+    uint8_t* const expected = checked_calloc(tiled_size);
+    uint8_t* const round_trip = checked_calloc(linear_size);
+
+    for (size_t i = 0; i < linear_size; ++i)
+        linear[i] = (uint8_t)(i * 131 + (i >> 8) * 7 + 1);
+    memset(tiled, 0xcc, tiled_size);
+    memset(expected, 0xcc, tiled_size);
+    for (uint32_t z = 0; z < layout->depth; ++z)
+        for (uint32_t y = 0; y < layout->height; ++y)
+            for (uint32_t x = 0; x < pitch; ++x)
+                expected[swizzle_offset(layout, x, y, z)] =
+                    linear[(z * layout->height + y) * pitch + x];
+
+    swizzle(layout, tiled, linear, pitch);
+    deswizzle(layout, round_trip, pitch, tiled);
+    bool const ok = 0 == memcmp(tiled, expected, tiled_size)
+        && 0 == memcmp(round_trip, linear, linear_size);
+    if (!ok)
+        fprintf(stderr, "%s: conversions differ from the reference\n", name);
+
+    free(linear);
+    free(tiled);
+    free(expected);
+    free(round_trip);
+    return ok;
+}
+
+static void bench(struct swizzle_layout const* layout, char const* name,
+    int iterations)
+{
+    size_t const pitch = layout->width * layout->bytes_per_element;
+    size_t const linear_size = pitch * layout->height * layout->depth;
+    uint8_t* const linear = checked_calloc(linear_size);
+    uint8_t* const tiled = checked_calloc(swizzle_size(layout));
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < iterations; ++i)
+        swizzle(layout, tiled, linear, pitch);
+    double const swizzle_ns = (double)(now_ns() - start) / iterations;
+    start = now_ns();
+    for (int i = 0; i < iterations; ++i)
+        deswizzle(layout, linear, pitch, tiled);
+    double const deswizzle_ns = (double)(now_ns() - start) / iterations;
+
+    printf("%-16s %10zu %4u %12.0f %12.0f\n", name, linear_size,
+        layout->block_height, linear_size / swizzle_ns * 1000,
+        linear_size / deswizzle_ns * 1000);
+    free(linear);
+    free(tiled);
+}
+
+int main(int argc, char** argv)
+{
+    int const iterations = argc > 1 ? atoi(argv[1]) : 200;
+    if (iterations <= 0)
+    {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    struct swizzle_layout layouts[NUM_IMAGES];
+    bool ok = check_gob_offsets();
+    ok = check_element_layouts() && ok;
+    for (size_t i = 0; i < NUM_IMAGES; ++i)
+    {
+        struct image const* const image = &images[i];
+        swizzle_layout_init(&layouts[i], image->width, image->height,
+            image->depth, image->bytes_per_element, image->element_size,
+            image->element_size);
+        ok = check(&layouts[i], image->name) && ok;
+    }
+    if (!ok)
+        return EXIT_FAILURE;
+
+#if defined(__ARM_NEON)
+    printf("NEON kernels\n");
+#elif defined(__SSE2__)
+    printf("SSE2 kernels\n");
+#else
+    printf("Portable kernels\n");
+#endif
+    printf("%-16s %10s %4s %12s %12s\n", "image", "bytes", "bh",
+        "swizzle MB/s", "deswiz MB/s");
+    for (size_t i = 0; i < NUM_IMAGES; ++i)
+    {
+        int const count = layouts[i].width * layouts[i].height > 1 << 20
+            ? (iterations + 49) / 50 : iterations * 10;
+        bench(&layouts[i], images[i].name, count);
+    }
+    return EXIT_SUCCESS;
+}